@@ -248,7 +248,7 @@ int st_set_magic (atari_st_t *sim, pce_key_t key)
 static
 void st_setup_system (atari_st_t *sim, ini_sct_t *ini)
 {
-	int        mono, fastboot, rtc;
+	int        mono, fastboot, rtc, sync_audio;
 	const char *model, *parport, *serport;
 	ini_sct_t  *sct;
 
@@ -265,8 +265,13 @@ void st_setup_system (atari_st_t *sim, ini_sct_t *ini)
 	ini_get_bool (sct, "rtc", &rtc, 1);
 	ini_get_string (sct, "parport", &parport, NULL);
 	ini_get_string (sct, "serport", &serport, NULL);
+	ini_get_bool (sct, "sync_audio", &sync_audio, 0);
 
-	pce_log_tag (MSG_INF, "SYSTEM:", "model=%s fastboot=%d\n", model, fastboot);
+	pce_log_tag (MSG_INF, "SYSTEM:", "model=%s fastboot=%d sync-audio=%d\n",
+		model, fastboot, sync_audio
+	);
+
+	sim->sync_audio = (sync_audio != 0);
 
 	if (strcmp (model, "st") == 0) {
 		sim->model = PCE_ST_ST;
@@ -914,6 +919,36 @@ void st_reset (atari_st_t *sim)
 	sim->reset = 0;
 }
 
+/*
+ * Synchronize the emulation with the sound output
+ */
+static
+int st_audio_sync (atari_st_t *sim)
+{
+	long us;
+
+	if (st_psg_get_delay (&sim->psg, &us)) {
+		return (1);
+	}
+
+	if (us > 0) {
+		sim->speed_clock_extra += 1;
+	}
+	else if (sim->speed_clock_extra > 0) {
+		sim->speed_clock_extra -= 1;
+	}
+
+	if (us >= ST_CPU_SLEEP) {
+		pce_usleep (us);
+	}
+
+	/* resume real time synchronization from here if the sound stops */
+	sim->sync_sleep = 0;
+	pce_get_interval_us (&sim->sync_us);
+
+	return (0);
+}
+
 static
 void st_realtime_sync (atari_st_t *sim, unsigned long n)
 {
@@ -924,6 +959,12 @@ void st_realtime_sync (atari_st_t *sim, unsigned long n)
 	if (sim->sync_clk >= (ST_CPU_CLOCK / ST_CPU_SYNC)) {
 		sim->sync_clk -= (ST_CPU_CLOCK / ST_CPU_SYNC);
 
+		if (sim->sync_audio) {
+			if (st_audio_sync (sim) == 0) {
+				return;
+			}
+		}
+
 		us1 = pce_get_interval_us (&sim->sync_us);
 		us2 = (1000000 / ST_CPU_SYNC);
 
@@ -117,6 +117,9 @@ struct atari_st_s {
 	unsigned long sync_us;
 	long          sync_sleep;
 
+	/* pace the emulation by the sound output */
+	int           sync_audio;
+
 	unsigned long clk_cnt;
 	unsigned long clk_div[4];
 
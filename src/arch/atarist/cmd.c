@@ -856,6 +856,7 @@ void st_cmd_hm (cmd_t *cmd)
 		"emu.viking           \"0\" | \"1\"\n"
 		"emu.viking.toggle\n"
 		"\n"
+		"term.capture         [<filename>]\n"
 		"term.fullscreen      \"0\" | \"1\"\n"
 		"term.fullscreen.toggle\n"
 		"term.grab\n"
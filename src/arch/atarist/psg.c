@@ -37,6 +37,9 @@
 
 #define PSG_FREQ_INP 8000000
 
+/* the number of input clocks that are rendered at once */
+#define PSG_CLOCK_BLOCK 8192
+
 
 struct psg_env_s {
 	unsigned char val;
@@ -79,6 +82,7 @@ void st_psg_init (st_psg_t *psg)
 
 	psg->clock = 0;
 	psg->clock_div = 0;
+	psg->clock_pend = 0;
 
 	psg->srate = 44100;
 
@@ -115,6 +119,8 @@ void st_psg_init (st_psg_t *psg)
 
 	psg->lowpass_freq = 0;
 
+	snd_blep_init (&psg->blep, 0);
+
 	psg->buf_cnt = 0;
 	psg->last_smp = 0x8000;
 
@@ -199,6 +205,15 @@ sound_drv_t *st_psg_get_driver (st_psg_t *psg)
 	return (psg->drv);
 }
 
+int st_psg_get_delay (st_psg_t *psg, long *us)
+{
+	if ((psg->drv == NULL) || (psg->speaker_on == 0)) {
+		return (1);
+	}
+
+	return (snd_get_delay (psg->drv, psg->buf_cnt, us));
+}
+
 int st_psg_set_srate (st_psg_t *psg, unsigned long srate)
 {
 	if (psg->drv != NULL) {
@@ -335,13 +350,15 @@ uint16_t psg_filter_hp (st_psg_t *psg, uint16_t v)
 	return (y0 + 32768);
 }
 
+/*
+ * Get the current output level
+ */
 static
-void psg_add_sample (st_psg_t *psg)
+long psg_get_level (st_psg_t *psg)
 {
 	unsigned      i;
 	unsigned char tone, noise;
 	unsigned      vol, v[3];
-	uint16_t      smp;
 
 	tone = psg->reg[7];
 	noise = psg->reg[7] >> 3;
@@ -369,7 +386,37 @@ void psg_add_sample (st_psg_t *psg)
 		noise >>= 1;
 	}
 
-	smp = 0x8000 + (voltab16[v[0]][v[1]][v[2]] / 4);
+	return (voltab16[v[0]][v[1]][v[2]] / 4);
+}
+
+/*
+ * Pass the current output level to the BLEP synthesizer
+ *
+ * The level change takes effect at the current position between
+ * two output samples.
+ */
+static
+void psg_update_output (st_psg_t *psg)
+{
+	unsigned frac;
+
+	frac = ((unsigned long long) psg->out_cnt << 16) / psg->inp_freq;
+
+	snd_blep_set_level (&psg->blep, psg_get_level (psg), frac);
+}
+
+/*
+ * Add an output sample
+ *
+ * Returns true if the output has been silent for long enough to turn
+ * off the speaker.
+ */
+static
+int psg_add_sample (st_psg_t *psg)
+{
+	uint16_t smp;
+
+	smp = 0x8000 + snd_blep_get_sample (&psg->blep);
 
 	if (psg->last_smp == smp) {
 		if (--psg->silence_cnt == 0) {
@@ -378,7 +425,7 @@ void psg_add_sample (st_psg_t *psg)
 #if DEBUG_PSG >= 1
 			fprintf (stderr, "PSG: speaker off (%u)\n", psg->last_smp);
 #endif
-			return;
+			return (1);
 		}
 	}
 	else {
@@ -391,6 +438,12 @@ void psg_add_sample (st_psg_t *psg)
 	}
 
 	psg->buf[psg->buf_cnt++] = smp;
+
+	if (psg->buf_cnt >= PSG_BUF_SIZE) {
+		psg_write_buffer (psg);
+	}
+
+	return (0);
 }
 
 static
@@ -412,6 +465,51 @@ void psg_env_clock (st_psg_t *psg)
 	}
 }
 
+/*
+ * Clock the envelope generator cnt times
+ */
+static
+void psg_env_clock_n (st_psg_t *psg, unsigned long cnt)
+{
+	unsigned long per;
+
+	/* after the first segment the envelope repeats every two segments */
+	per = 2 * (unsigned long) psg->env_per2;
+
+	if (cnt > (2 * per)) {
+		cnt = per + (cnt - per) % per;
+	}
+
+	while (cnt > 0) {
+		psg_env_clock (psg);
+		cnt -= 1;
+	}
+}
+
+/*
+ * Advance a counter by cnt ticks
+ *
+ * Returns the number of times the counter expired.
+ */
+static
+unsigned long psg_counter_advance (unsigned long *val, unsigned long per, unsigned long cnt)
+{
+	unsigned long n;
+
+	if (cnt < *val) {
+		*val -= cnt;
+		return (0);
+	}
+
+	cnt -= *val;
+
+	n = 1 + cnt / per;
+
+	*val = per - cnt % per;
+
+	return (n);
+}
+
 
 static
 void psg_set_tone_period (st_psg_t *psg, unsigned chn, unsigned char v1, unsigned char v2)
@@ -440,6 +538,10 @@ void psg_set_tone_period (st_psg_t *psg, unsigned chn, unsigned char v1, unsigne
 #endif
 
 	psg->tone_per[chn] = val;
+
+	if (val < 5) {
+		psg->tone_val[chn] = 1;
+	}
 }
 
 static
@@ -631,6 +733,167 @@ void psg_aym_set_reg (st_psg_t *psg, unsigned idx, unsigned char val)
 	psg->aym_reg |= (1U << idx);
 }
 
+/*
+ * Advance the generators that do not contribute to the output
+ *
+ * These are advanced in one step, without generating events. The noise
+ * generator is only advanced if it is used.
+ */
+static
+void psg_skip (st_psg_t *psg, unsigned long cnt, const int *use_tone, int use_noise, int use_env)
+{
+	unsigned      i;
+	unsigned long n;
+
+	for (i = 0; i < 3; i++) {
+		if (use_tone[i] == 0) {
+			n = psg_counter_advance (&psg->tone_cnt[i], psg->tone_per[i], cnt);
+
+			if (psg->tone_per[i] < 5) {
+				psg->tone_val[i] = 1;
+			}
+			else if (n & 1) {
+				psg->tone_val[i] = !psg->tone_val[i];
+			}
+		}
+	}
+
+	if (use_noise == 0) {
+		psg_counter_advance (&psg->noise_cnt, psg->noise_per, cnt);
+	}
+
+	if (use_env == 0) {
+		n = psg_counter_advance (&psg->env_cnt, psg->env_per, cnt);
+
+		if (n > 0) {
+			psg_env_clock_n (psg, n);
+		}
+	}
+}
+
+/*
+ * Render the output up to the current clock
+ *
+ * Instead of stepping the generators once per tick, the time to the
+ * next event (a counter expiring or an output sample being due) is
+ * computed and all generators are advanced to that point at once.
+ */
+static
+void psg_render (st_psg_t *psg)
+{
+	unsigned      i;
+	unsigned long cnt, d;
+	int           use_tone[3], use_noise, use_env, chg;
+
+	if (psg->silence_cnt == 0) {
+		psg->clock_pend = 0;
+		return;
+	}
+
+	cnt = psg->clock_pend + psg->clock_div;
+	psg->clock_pend = 0;
+	psg->clock_div = cnt & 0x1f;
+	cnt = cnt >> 5;
+
+	/* cnt is now f[master] / 8 */
+
+	if (cnt == 0) {
+		return;
+	}
+
+	for (i = 0; i < 3; i++) {
+		use_tone[i] = ((psg->reg[7] & (1U << i)) == 0) && (psg->tone_per[i] >= 5);
+	}
+
+	use_noise = (psg->reg[7] & 0x38) != 0x38;
+	use_env = ((psg->reg[8] | psg->reg[9] | psg->reg[10]) & 0x10) != 0;
+
+	psg_skip (psg, cnt, use_tone, use_noise, use_env);
+
+	while (cnt > 0) {
+		/* the number of ticks until the next output sample */
+		d = (psg->inp_freq - psg->out_cnt + psg->out_freq - 1) / psg->out_freq;
+
+		if (cnt < d) {
+			d = cnt;
+		}
+
+		for (i = 0; i < 3; i++) {
+			if (use_tone[i] && (psg->tone_cnt[i] < d)) {
+				d = psg->tone_cnt[i];
+			}
+		}
+
+		if (use_noise && (psg->noise_cnt < d)) {
+			d = psg->noise_cnt;
+		}
+
+		if (use_env && (psg->env_cnt < d)) {
+			d = psg->env_cnt;
+		}
+
+		chg = 0;
+
+		for (i = 0; i < 3; i++) {
+			if (use_tone[i]) {
+				psg->tone_cnt[i] -= d;
+
+				if (psg->tone_cnt[i] == 0) {
+					psg->tone_cnt[i] = psg->tone_per[i];
+					psg->tone_val[i] = !psg->tone_val[i];
+					chg = 1;
+				}
+			}
+		}
+
+		if (use_noise) {
+			psg->noise_cnt -= d;
+
+			if (psg->noise_cnt == 0) {
+				psg->noise_cnt = psg->noise_per;
+
+				if (psg->noise_val & 1) {
+					psg->noise_val = (psg->noise_val >> 1) ^ 0x80000057;
+				}
+				else {
+					psg->noise_val = psg->noise_val >> 1;
+				}
+
+				chg = 1;
+			}
+		}
+
+		if (use_env) {
+			psg->env_cnt -= d;
+
+			if (psg->env_cnt == 0) {
+				psg->env_cnt = psg->env_per;
+				psg_env_clock (psg);
+				chg = 1;
+			}
+		}
+
+		/* the events happen in the last of the d ticks */
+		psg->out_cnt += (d - 1) * psg->out_freq;
+
+		if (chg) {
+			psg_update_output (psg);
+		}
+
+		psg->out_cnt += psg->out_freq;
+
+		if (psg->out_cnt >= psg->inp_freq) {
+			psg->out_cnt -= psg->inp_freq;
+
+			if (psg_add_sample (psg)) {
+				return;
+			}
+		}
+
+		cnt -= d;
+	}
+}
+
 unsigned char st_psg_get_select (st_psg_t *psg)
 {
 	return (psg->reg_sel);
@@ -652,6 +915,8 @@ unsigned char st_psg_get_data (st_psg_t *psg)
 
 void st_psg_set_data (st_psg_t *psg, unsigned char val)
 {
+	psg_render (psg);
+
 	psg_aym_set_reg (psg, psg->reg_sel, val);
 
 	switch (psg->reg_sel) {
@@ -719,65 +984,16 @@ void st_psg_set_data (st_psg_t *psg, unsigned char val)
 		psg_set_port_b (psg, val);
 		break;
 	}
+
+	psg_update_output (psg);
 }
 
 void st_psg_clock (st_psg_t *psg, unsigned long cnt)
 {
-	unsigned i;
-
 	psg->clock += cnt;
+	psg->clock_pend += cnt;
 
-	if (psg->silence_cnt == 0) {
-		return;
-	}
-
-	cnt += psg->clock_div;
-	psg->clock_div = cnt & 0x1f;
-	cnt = cnt >> 5;
-
-	/* cnt is now f[master] / 8 */
-
-	while (cnt > 0) {
-		if (--psg->noise_cnt == 0) {
-			psg->noise_cnt = psg->noise_per;
-
-			if (psg->noise_val & 1) {
-				psg->noise_val = (psg->noise_val >> 1) ^ 0x80000057;
-			}
-			else {
-				psg->noise_val = psg->noise_val >> 1;
-			}
-		}
-
-		for (i = 0; i < 3; i++) {
-			if (--psg->tone_cnt[i] == 0) {
-				psg->tone_cnt[i] = psg->tone_per[i];
-				psg->tone_val[i] = !psg->tone_val[i];
-			}
-
-			if (psg->tone_per[i] < 5) {
-				psg->tone_val[i] = 1;
-			}
-		}
-
-		if (--psg->env_cnt == 0) {
-			psg->env_cnt = psg->env_per;
-
-			psg_env_clock (psg);
-		}
-
-		psg->out_cnt += psg->out_freq;
-
-		if (psg->out_cnt >= psg->inp_freq) {
-			psg->out_cnt -= psg->inp_freq;
-
-			psg_add_sample (psg);
-
-			if (psg->buf_cnt >= PSG_BUF_SIZE) {
-				psg_write_buffer (psg);
-			}
-		}
-
-		cnt -= 1;
+	if (psg->clock_pend >= PSG_CLOCK_BLOCK) {
+		psg_render (psg);
 	}
 }
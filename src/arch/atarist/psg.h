@@ -27,6 +27,7 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include <drivers/sound/blep.h>
 #include <drivers/sound/sound.h>
 
 
@@ -40,6 +41,9 @@ typedef struct {
 	unsigned long  clock;
 	unsigned long  clock_div;
 
+	/* the number of input clocks that have not been rendered yet */
+	unsigned long  clock_pend;
+
 	unsigned long  srate;
 
 	unsigned long  silence_cnt;
@@ -77,6 +81,8 @@ typedef struct {
 	unsigned long  lowpass_freq;
 	sound_iir2_t   iir;
 
+	sound_blep_t   blep;
+
 	unsigned short buf_cnt;
 	uint16_t       buf[PSG_BUF_SIZE];
 	uint16_t       last_smp;
@@ -111,6 +117,14 @@ int st_psg_set_driver (st_psg_t *psg, const char *drv);
  */
 sound_drv_t *st_psg_get_driver (st_psg_t *psg);
 
+/*
+ * Get the time by which the sound output is ahead of the sound
+ * driver's target queue depth.
+ *
+ * This fails while the PSG is silent.
+ */
+int st_psg_get_delay (st_psg_t *psg, long *us);
+
 /*
  * Set the output sample rate.
  *
@@ -41,6 +41,40 @@ static void st_video_set_uint16 (st_video_t *vid, unsigned long addr, unsigned s
 static void st_video_set_uint32 (st_video_t *vid, unsigned long addr, unsigned long val);
 
 
+/*
+ * Spread the 8 bits of a bitplane byte into the low bits of 8 nibbles,
+ * the leftmost pixel (bit 7) going to the highest nibble.
+ */
+static unsigned long st_video_spread[256];
+static char          st_video_spread_ok = 0;
+
+
+static
+void st_video_init_spread (void)
+{
+	unsigned      i, j;
+	unsigned long val;
+
+	if (st_video_spread_ok) {
+		return;
+	}
+
+	for (i = 0; i < 256; i++) {
+		val = 0;
+
+		for (j = 0; j < 8; j++) {
+			if (i & (0x80 >> j)) {
+				val |= 1UL << (28 - 4 * j);
+			}
+		}
+
+		st_video_spread[i] = val;
+	}
+
+	st_video_spread_ok = 1;
+}
+
+
 int st_video_init (st_video_t *vid, unsigned long addr, int mono)
 {
 	vid->mem = NULL;
@@ -58,7 +92,12 @@ int st_video_init (st_video_t *vid, unsigned long addr, int mono)
 
 	vid->mono = (mono != 0);
 
-	vid->rgb = malloc (3UL * 640UL * 400UL);
+	st_video_init_spread ();
+
+	memset (vid->pal_mono, 0, sizeof (vid->pal_mono));
+	mono_tab_init (&vid->mono_tab, vid->pal_mono[1], vid->pal_mono[0]);
+
+	vid->rgb = malloc (4UL * 640UL * 400UL);
 
 	if (vid->rgb == NULL) {
 		return (1);
@@ -134,6 +173,8 @@ void st_video_set_terminal (st_video_t *vid, terminal_t *trm)
 	vid->trm = trm;
 
 	if (vid->trm != NULL) {
+		trm_set_bpp (vid->trm, 4);
+
 		if (vid->mono) {
 			trm_open (vid->trm, 640, 400);
 		}
@@ -268,6 +309,8 @@ void st_video_set_palette (st_video_t *vid, unsigned idx, unsigned short val)
 		vid->pal_mono[1][0] = tmp;
 		vid->pal_mono[1][1] = tmp;
 		vid->pal_mono[1][2] = tmp;
+
+		mono_tab_set_color (&vid->mono_tab, vid->pal_mono[1], vid->pal_mono[0]);
 	}
 }
 
@@ -424,46 +467,54 @@ void st_video_set_uint32 (st_video_t *vid, unsigned long addr, unsigned long val
 	}
 }
 
+/*
+ * Write 8 pixels from a chunky word (4 bits per pixel, leftmost pixel
+ * in the highest nibble).
+ */
+static
+unsigned char *st_video_put_pixels (st_video_t *vid, unsigned char *dst, unsigned long val)
+{
+	unsigned            i;
+	const unsigned char *col;
+
+	for (i = 0; i < 8; i++) {
+		col = vid->pal_col[(val >> 28) & 15];
+
+		*(uint32_t *) dst = TRM_XRGB (col[0], col[1], col[2]);
+
+		dst += 4;
+		val <<= 4;
+	}
+
+	return (dst);
+}
+
 static
 void st_video_update_line_0 (st_video_t *vid)
 {
-	unsigned            i, j, idx;
-	unsigned short      val[4];
-	const unsigned char *src, *col;
+	unsigned            i;
+	unsigned long       val;
+	const unsigned long *tab;
+	const unsigned char *src;
 	unsigned char       *dst;
 
 	if (vid->src == NULL) {
 		return;
 	}
 
+	tab = st_video_spread;
+
 	src = vid->src;
 	dst = vid->dst;
 
 	for (i = 0; i < 20; i++) {
-		val[0] = (src[0] << 8) | src[1];
-		val[1] = (src[2] << 8) | src[3];
-		val[2] = (src[4] << 8) | src[5];
-		val[3] = (src[6] << 8) | src[7];
-
-		for (j = 0; j < 16; j++) {
-			idx = (val[3] >> 12) & 8;
-			idx |= (val[2] >> 13) & 4;
-			idx |= (val[1] >> 14) & 2;
-			idx |= (val[0] >> 15) & 1;
-
-			val[0] <<= 1;
-			val[1] <<= 1;
-			val[2] <<= 1;
-			val[3] <<= 1;
+		val = tab[src[0]] | (tab[src[2]] << 1);
+		val |= (tab[src[4]] << 2) | (tab[src[6]] << 3);
+		dst = st_video_put_pixels (vid, dst, val);
 
-			col = vid->pal_col[idx];
-
-			dst[0] = col[0];
-			dst[1] = col[1];
-			dst[2] = col[2];
-
-			dst += 3;
-		}
+		val = tab[src[1]] | (tab[src[3]] << 1);
+		val |= (tab[src[5]] << 2) | (tab[src[7]] << 3);
+		dst = st_video_put_pixels (vid, dst, val);
 
 		src += 8;
 	}
@@ -476,37 +527,27 @@ void st_video_update_line_0 (st_video_t *vid)
 static
 void st_video_update_line_1 (st_video_t *vid)
 {
-	unsigned            i, j, idx;
-	unsigned short      val[2];
-	const unsigned char *src, *col;
+	unsigned            i;
+	unsigned long       val;
+	const unsigned long *tab;
+	const unsigned char *src;
 	unsigned char       *dst;
 
 	if (vid->src == NULL) {
 		return;
 	}
 
+	tab = st_video_spread;
+
 	src = vid->src;
 	dst = vid->dst;
 
 	for (i = 0; i < 40; i++) {
-		val[0] = (src[0] << 8) | src[1];
-		val[1] = (src[2] << 8) | src[3];
+		val = tab[src[0]] | (tab[src[2]] << 1);
+		dst = st_video_put_pixels (vid, dst, val);
 
-		for (j = 0; j < 16; j++) {
-			idx = (val[1] >> 14) & 2;
-			idx |= (val[0] >> 15) & 1;
-
-			val[0] <<= 1;
-			val[1] <<= 1;
-
-			col = vid->pal_col[idx];
-
-			dst[0] = col[0];
-			dst[1] = col[1];
-			dst[2] = col[2];
-
-			dst += 3;
-		}
+		val = tab[src[1]] | (tab[src[3]] << 1);
+		dst = st_video_put_pixels (vid, dst, val);
 
 		src += 4;
 	}
@@ -519,44 +560,14 @@ void st_video_update_line_1 (st_video_t *vid)
 static
 void st_video_update_line_2 (st_video_t *vid)
 {
-	unsigned            i, j;
-	unsigned char       msk;
-	const unsigned char *src, *col;
-	unsigned char       *dst;
-
 	if (vid->src == NULL) {
 		return;
 	}
 
-	src = vid->src;
-	dst = vid->dst;
-	msk = 0x80;
-
-	for (i = 0; i < 80; i++) {
-		msk = 0x80;
-
-		for (j = 0; j < 8; j++) {
-			if (*src & msk) {
-				col = vid->pal_mono[0];
-			}
-			else {
-				col = vid->pal_mono[1];
-			}
-
-			dst[0] = col[0];
-			dst[1] = col[1];
-			dst[2] = col[2];
-
-			msk >>= 1;
+	mono_tab_expand (&vid->mono_tab, vid->dst, vid->src, 80);
 
-			dst += 3;
-		}
-
-		src += 1;
-	}
-
-	vid->src = src;
-	vid->dst = dst;
+	vid->src += 80;
+	vid->dst += 4 * 640;
 	vid->addr += 80;
 }
 
@@ -604,6 +615,8 @@ void st_video_reset (st_video_t *vid)
 		vid->pal_mono[i][1] = 0;
 		vid->pal_mono[i][2] = 0;
 	}
+
+	mono_tab_set_color (&vid->mono_tab, vid->pal_mono[1], vid->pal_mono[0]);
 }
 
 static
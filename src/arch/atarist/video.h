@@ -25,6 +25,7 @@
 
 
 #include <devices/memory.h>
+#include <drivers/video/mono.h>
 #include <drivers/video/terminal.h>
 
 
@@ -43,6 +44,7 @@ typedef struct {
 	unsigned short      palette[16];
 	unsigned char       pal_col[16][3];
 	unsigned char       pal_mono[2][3];
+	mono_tab_t          mono_tab;
 
 	unsigned            w;
 	unsigned            h;
@@ -57,7 +57,7 @@ int st_viking_init (st_viking_t *vik, unsigned long addr)
 		st_viking_set_uint8, st_viking_set_uint16, st_viking_set_uint32
 	);
 
-	if ((vik->rgb = malloc (3UL * VIKING_W * VIKING_H)) == NULL) {
+	if ((vik->rgb = malloc (4UL * VIKING_W * VIKING_H)) == NULL) {
 		return (1);
 	}
 
@@ -134,6 +134,7 @@ void st_viking_set_terminal (st_viking_t *vik, terminal_t *trm)
 		vik->mod_y1 = 0;
 		vik->mod_y2 = VIKING_H - 1;
 
+		trm_set_bpp (vik->trm, 4);
 		trm_open (vik->trm, VIKING_W, VIKING_H);
 	}
 }
@@ -248,7 +249,7 @@ void st_viking_update (st_viking_t *vik)
 	}
 
 	src = vik->ptr + vik->mod_y1 * (VIKING_W / 8);
-	dst = vik->rgb + vik->mod_y1 * (VIKING_W / 8) * 3UL;
+	dst = vik->rgb + 4UL * VIKING_W * vik->mod_y1;
 
 	for (j = vik->mod_y1; j <= vik->mod_y2; j++) {
 		for (i = 0; i < (VIKING_W / 8); i++) {
@@ -256,16 +257,13 @@ void st_viking_update (st_viking_t *vik)
 
 			for (k = 0; k < 8; k++) {
 				if (val & 0x80) {
-					*(dst++) = 0x00;
-					*(dst++) = 0x00;
-					*(dst++) = 0x00;
+					*(uint32_t *) dst = TRM_XRGB (0x00, 0x00, 0x00);
 				}
 				else {
-					*(dst++) = 0xff;
-					*(dst++) = 0xff;
-					*(dst++) = 0xff;
+					*(uint32_t *) dst = TRM_XRGB (0xff, 0xff, 0xff);
 				}
 
+				dst += 4;
 				val <<= 1;
 			}
 		}
@@ -303,7 +301,7 @@ void st_viking_clock (st_viking_t *vik, unsigned cnt)
 		st_viking_update (vik);
 
 		n = vik->mod_y2 - vik->mod_y1 + 1;
-		p = vik->rgb + 3UL * (VIKING_W / 8) * vik->mod_y1;
+		p = vik->rgb + 4UL * VIKING_W * vik->mod_y1;
 
 		trm_set_size (vik->trm, VIKING_W, VIKING_H);
 		trm_set_lines (vik->trm, p, vik->mod_y1, n);
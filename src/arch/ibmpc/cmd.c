@@ -22,6 +22,7 @@
 
 #include "main.h"
 #include "ibmpc.h"
+#include "fork.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -39,6 +40,7 @@ static mon_cmd_t par_cmd[] = {
 	{ "boot", "[drive]", "set the boot drive" },
 	{ "c", "[cnt]", "clock [1]" },
 	{ "gb", "[addr...]", "run with breakpoints" },
+	{ "fork", "[cnt [prefix]]", "clone the emulator cnt times [1 clone-]" },
 	{ "g", "far", "run until CS changes" },
 	{ "g", "", "run" },
 	{ "hm", "", "print help on messages" },
@@ -49,8 +51,9 @@ static mon_cmd_t par_cmd[] = {
 	{ "o", "[b|w] port val", "output a byte or word to a port" },
 	{ "pq", "[c|f|s]", "prefetch queue clear/fill/status" },
 	{ "p", "[cnt]", "execute cnt instructions, without trace in calls [1]" },
+	{ "rewind", "[ms]", "go back ms milliseconds in time or print the rewind status" },
 	{ "r", "[reg val]", "set a register" },
-	{ "s", "[what]", "print status (pc|cpu|disks|ems|mem|pic|pit|ports|ppi|time|uart|video|xms)" },
+	{ "s", "[what]", "print status (pc|cpu|disks|ems|mem|pic|pit|ports|ppi|term|time|uart|video|xms)" },
 	{ "trace", "on|off|expr", "turn trace on or off" },
 	{ "t", "[cnt]", "execute cnt instructions [1]" },
 	{ "u", "[addr [cnt [mode]]]", "disassemble" }
@@ -139,6 +142,25 @@ void prt_uint8_bin (unsigned char val)
 	pce_puts (str);
 }
 
+static
+void prt_state_term (terminal_t *trm)
+{
+	FILE *fp;
+
+	if (trm == NULL) {
+		return;
+	}
+
+	pce_prt_sep ("terminal");
+
+	trm_print_info (trm, pce_get_fp_out());
+
+	fp = pce_get_redir_out();
+	if (fp != NULL) {
+		trm_print_info (trm, fp);
+	}
+}
+
 static
 void prt_state_video (video_t *vid)
 {
@@ -683,6 +705,34 @@ void pc_cmd_c (cmd_t *cmd, ibmpc_t *pc)
 	prt_state (pc);
 }
 
+static
+void pc_cmd_fork (cmd_t *cmd, ibmpc_t *pc)
+{
+	unsigned short cnt;
+	char           prefix[256];
+
+	cnt = 1;
+	prefix[0] = 0;
+
+	if (cmd_match_uint16b (cmd, &cnt, 10)) {
+		if (!cmd_match_str (cmd, prefix, sizeof (prefix))) {
+			prefix[0] = 0;
+		}
+	}
+
+	if (!cmd_match_end (cmd)) {
+		return;
+	}
+
+	if (prefix[0] == 0) {
+		strcpy (prefix, "clone-");
+	}
+
+	if (pc_fork (pc, cnt, prefix) < 0) {
+		pce_puts ("fork failed\n");
+	}
+}
+
 static
 void pc_cmd_g_b (cmd_t *cmd, ibmpc_t *pc)
 {
@@ -787,10 +837,12 @@ void pc_cmd_hm (cmd_t *cmd)
 	pce_puts (
 		"emu.config.save      <filename>\n"
 		"emu.exit\n"
+		"emu.fork             [<count>[:<prefix>]]\n"
 		"emu.stop\n"
 		"emu.pause            \"0\" | \"1\"\n"
 		"emu.pause.toggle\n"
 		"emu.reset\n"
+		"emu.rewind           <milliseconds>\n"
 		"\n"
 		"emu.cas.commit\n"
 		"emu.cas.create       <filename>\n"
@@ -817,6 +869,8 @@ void pc_cmd_hm (cmd_t *cmd)
 		"emu.serport.driver   <driver>\n"
 		"emu.serport.file     <filename>\n"
 		"\n"
+		"emu.term.capture     [<filename>]\n"
+		"emu.term.frame_skip  <max>\n"
 		"emu.term.fullscreen  \"0\" | \"1\"\n"
 		"emu.term.fullscreen.toggle\n"
 		"emu.term.grab\n"
@@ -1204,6 +1258,38 @@ void pc_cmd_r (cmd_t *cmd, ibmpc_t *pc)
 	prt_state (pc);
 }
 
+static
+void pc_cmd_rewind (cmd_t *cmd, ibmpc_t *pc)
+{
+	unsigned long ms;
+
+	if (pc->rew == NULL) {
+		pce_puts ("rewind is not enabled\n");
+		return;
+	}
+
+	if (cmd_match_eol (cmd)) {
+		pc_rewind_print_info (pc->rew);
+		return;
+	}
+
+	if (!cmd_match_uint32b (cmd, &ms, 10)) {
+		cmd_error (cmd, "expecting milliseconds");
+		return;
+	}
+
+	if (!cmd_match_end (cmd)) {
+		return;
+	}
+
+	if (pc_rewind_restore (pc->rew, pc, ms)) {
+		pce_puts ("rewind failed\n");
+		return;
+	}
+
+	prt_state (pc);
+}
+
 static
 void pc_cmd_s (cmd_t *cmd, ibmpc_t *pc)
 {
@@ -1243,6 +1329,9 @@ void pc_cmd_s (cmd_t *cmd, ibmpc_t *pc)
 		else if (cmd_match (cmd, "ports")) {
 			prt_state_ports (pc);
 		}
+		else if (cmd_match (cmd, "term")) {
+			prt_state_term (pc->trm);
+		}
 		else if (cmd_match (cmd, "uart")) {
 			unsigned short i;
 			if (!cmd_match_uint16 (cmd, &i)) {
@@ -1392,6 +1481,9 @@ int pc_cmd (ibmpc_t *pc, cmd_t *cmd)
 	else if (cmd_match (cmd, "c")) {
 		pc_cmd_c (cmd, pc);
 	}
+	else if (cmd_match (cmd, "fork")) {
+		pc_cmd_fork (cmd, pc);
+	}
 	else if (cmd_match (cmd, "g")) {
 		pc_cmd_g (cmd, pc);
 	}
@@ -1416,6 +1508,9 @@ int pc_cmd (ibmpc_t *pc, cmd_t *cmd)
 	else if (cmd_match (cmd, "p")) {
 		pc_cmd_p (cmd, pc);
 	}
+	else if (cmd_match (cmd, "rewind")) {
+		pc_cmd_rewind (cmd, pc);
+	}
 	else if (cmd_match (cmd, "r")) {
 		pc_cmd_r (cmd, pc);
 	}
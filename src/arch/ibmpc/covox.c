@@ -26,6 +26,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#include <drivers/sound/edge.h>
 #include <drivers/sound/sound.h>
 
 
@@ -39,9 +40,6 @@
 #endif
 
 
-static void pc_covox_flush (pc_covox_t *cov);
-
-
 void pc_covox_init (pc_covox_t *cov)
 {
 	cov->drv = NULL;
@@ -62,24 +60,20 @@ void pc_covox_init (pc_covox_t *cov)
 	cov->timeout_val = 0;
 
 	cov->clk = 0;
-	cov->rem = 0;
-
-	cov->srate = 44100;
-
-	cov->srate_div = 0;
 
-	cov->lowpass_freq = 0;
+	cov->tick_clk = 0;
+	cov->tick_rem = 0;
 
-	snd_iir2_init (&cov->iir);
+	cov->srate = 44100;
 
-	cov->buf_cnt = 0;
+	snd_edge_init (&cov->edge, PC_COVOX_CLOCK);
 
 	pc_covox_set_volume (cov, 500);
 }
 
 void pc_covox_free (pc_covox_t *cov)
 {
-	pc_covox_flush (cov);
+	snd_edge_free (&cov->edge);
 
 	if (cov->drv != NULL) {
 		snd_close (cov->drv);
@@ -127,6 +121,7 @@ void pc_covox_set_mode (pc_covox_t *cov, unsigned mode)
 int pc_covox_set_driver (pc_covox_t *cov, const char *driver, unsigned long srate)
 {
 	if (cov->drv != NULL) {
+		snd_edge_set_driver (&cov->edge, NULL, cov->srate);
 		snd_close (cov->drv);
 	}
 
@@ -142,84 +137,43 @@ int pc_covox_set_driver (pc_covox_t *cov, const char *driver, unsigned long srat
 		return (1);
 	}
 
-	return (0);
-}
-
-void pc_covox_set_lowpass (pc_covox_t *cov, unsigned long freq)
-{
-	cov->lowpass_freq = freq;
-
-	snd_iir2_set_lowpass (&cov->iir, cov->lowpass_freq, cov->srate);
-}
-
-void pc_covox_set_volume (pc_covox_t *cov, unsigned vol)
-{
-	if (vol > 1000) {
-		vol = 1000;
+	if (snd_edge_set_driver (&cov->edge, cov->drv, srate)) {
+		snd_close (cov->drv);
+		cov->drv = NULL;
+		return (1);
 	}
 
-	cov->vol = (256UL * vol) / 1000;
+	return (0);
 }
 
-
-static
-void pc_covox_play (pc_covox_t *cov, uint16_t *buf, unsigned cnt)
+int pc_covox_get_delay (pc_covox_t *cov, long *us)
 {
-	if (cov->lowpass_freq > 0) {
-		snd_iir2_filter (&cov->iir, buf, buf, cnt, 1, 1);
+	if ((cov->drv == NULL) || (cov->playing == 0)) {
+		return (1);
 	}
 
-	snd_write (cov->drv, buf, cnt);
+	return (snd_edge_get_delay (&cov->edge, us));
 }
 
-static
-void pc_covox_write (pc_covox_t *cov, uint16_t val, unsigned long cnt)
+void pc_covox_set_lowpass (pc_covox_t *cov, unsigned long freq)
 {
-	unsigned idx;
-
-	if (cov->drv == NULL) {
-		return;
-	}
-
-	idx = cov->buf_cnt;
-
-	while (cnt > 0) {
-		cov->buf[idx++] = val;
-
-		if (idx >= PC_COVOX_BUF) {
-			pc_covox_play (cov, cov->buf, idx);
-
-			idx = 0;
-		}
-
-		cnt -= 1;
-	}
-
-	cov->buf_cnt = idx;
+	snd_edge_set_lowpass (&cov->edge, freq);
 }
 
-static
-void pc_covox_flush (pc_covox_t *cov)
+void pc_covox_set_volume (pc_covox_t *cov, unsigned vol)
 {
-	if (cov->buf_cnt == 0) {
-		return;
+	if (vol > 1000) {
+		vol = 1000;
 	}
 
-	pc_covox_play (cov, cov->buf, cov->buf_cnt);
-
-	snd_iir2_reset (&cov->iir);
-
-	cov->buf_cnt = 0;
+	cov->vol = (256UL * vol) / 1000;
 }
 
+
 static inline
-uint16_t pc_covox_get_smp (pc_covox_t *cov, unsigned val)
+long pc_covox_get_smp (pc_covox_t *cov, unsigned val)
 {
-	unsigned ret;
-
-	ret = cov->vol * ((long) (val & 0xff) - 0x80);
-
-	return (ret & 0xffff);
+	return ((long) cov->vol * ((long) (val & 0xff) - 0x80));
 }
 
 static
@@ -261,7 +215,7 @@ int pc_covox_fifo_next (pc_covox_t *cov)
 }
 
 static
-void pc_covox_on (pc_covox_t *cov)
+void pc_covox_on (pc_covox_t *cov, unsigned long clk)
 {
 #if DEBUG_COVOX >= 1
 	pc_log_deb ("covox on\n");
@@ -272,16 +226,14 @@ void pc_covox_on (pc_covox_t *cov)
 	cov->timeout_val = cov->data_val;
 	cov->timeout_clk = 0;
 
-	cov->rem = 0;
+	cov->tick_clk = 0;
+	cov->tick_rem = 0;
 
-	cov->srate_div = 0;
-
-	/* Fill the sound buffer a bit so we don't underrun immediately */
-	pc_covox_write (cov, 0, cov->srate / 8);
+	snd_edge_start (&cov->edge, clk);
 }
 
 static
-void pc_covox_off (pc_covox_t *cov)
+void pc_covox_off (pc_covox_t *cov, unsigned long clk)
 {
 #if DEBUG_COVOX >= 1
 	pc_log_deb ("covox off\n");
@@ -289,13 +241,19 @@ void pc_covox_off (pc_covox_t *cov)
 
 	cov->playing = 0;
 
-	pc_covox_flush (cov);
+	snd_edge_stop (&cov->edge, clk);
 }
 
+/*
+ * Play the FIFO at PC_COVOX_SRATE
+ *
+ * tick_clk is the number of clocks until the next sample is taken
+ * from the FIFO. Each sample is passed on at its exact clock.
+ */
 static
-void pc_covox_check_disney (pc_covox_t *cov)
+unsigned long pc_covox_check_disney (pc_covox_t *cov)
 {
-	unsigned long clk, cnt, tmp;
+	unsigned long clk, tmp, pos;
 
 	tmp = cov->get_clk (cov->get_clk_ext);
 	clk = tmp - cov->clk;
@@ -303,47 +261,52 @@ void pc_covox_check_disney (pc_covox_t *cov)
 
 	if (cov->playing == 0) {
 		if (cov->fifo_n == 0) {
-			return;
+			return (tmp);
 		}
 
-		pc_covox_on (cov);
+		pc_covox_on (cov, tmp);
 
-		pc_covox_fifo_next (cov);
+		clk = 0;
 	}
 
-	tmp = cov->rem + cov->srate * clk;
-	cov->rem = tmp % PC_COVOX_CLOCK;
-	cnt = tmp / PC_COVOX_CLOCK;
-
-	while (cnt > 0) {
-		pc_covox_write (cov, cov->smp, 1);
+	pos = tmp - clk;
 
-		cov->srate_div += PC_COVOX_SRATE;
+	while (clk >= cov->tick_clk) {
+		clk -= cov->tick_clk;
+		pos += cov->tick_clk;
 
-		while (cov->srate_div >= cov->srate) {
-			if (pc_covox_fifo_next (cov)) {
-				cov->timeout_clk += 1;
+		if (pc_covox_fifo_next (cov)) {
+			cov->timeout_clk += 1;
 
-				if (cov->timeout_clk > (2 * PC_COVOX_SRATE)) {
-					pc_covox_off (cov);
-					return;
-				}
+			if (cov->timeout_clk > (2 * PC_COVOX_SRATE)) {
+				pc_covox_off (cov, pos);
+				return (tmp);
 			}
-			else {
-				cov->timeout_clk = 0;
-			}
-
-			cov->srate_div -= cov->srate;
 		}
+		else {
+			cov->timeout_clk = 0;
+		}
+
+		snd_edge_set_level (&cov->edge, pos, cov->smp);
 
-		cnt -= 1;
+		cov->tick_clk = PC_COVOX_CLOCK / PC_COVOX_SRATE;
+		cov->tick_rem += PC_COVOX_CLOCK % PC_COVOX_SRATE;
+
+		if (cov->tick_rem >= PC_COVOX_SRATE) {
+			cov->tick_clk += 1;
+			cov->tick_rem -= PC_COVOX_SRATE;
+		}
 	}
+
+	cov->tick_clk -= clk;
+
+	return (tmp);
 }
 
 static
-void pc_covox_check_covox (pc_covox_t *cov)
+unsigned long pc_covox_check_covox (pc_covox_t *cov)
 {
-	unsigned long clk, cnt, tmp;
+	unsigned long clk, tmp;
 
 	tmp = cov->get_clk (cov->get_clk_ext);
 	clk = tmp - cov->clk;
@@ -351,16 +314,15 @@ void pc_covox_check_covox (pc_covox_t *cov)
 
 	if (cov->playing == 0) {
 		if (cov->timeout_val != cov->data_val) {
-			pc_covox_on (cov);
+			pc_covox_on (cov, tmp);
+			snd_edge_set_level (&cov->edge, tmp, cov->smp);
 		}
-		return;
 	}
 	else if (cov->timeout_val == cov->data_val) {
 		cov->timeout_clk += clk;
 
 		if (cov->timeout_clk > (2 * PC_COVOX_CLOCK)) {
-			pc_covox_off (cov);
-			return;
+			pc_covox_off (cov, tmp);
 		}
 	}
 	else {
@@ -368,21 +330,21 @@ void pc_covox_check_covox (pc_covox_t *cov)
 		cov->timeout_clk = clk;
 	}
 
-	tmp = cov->rem + cov->srate * clk;
-	cov->rem = tmp % PC_COVOX_CLOCK;
-	cnt = tmp / PC_COVOX_CLOCK;
-
-	if (cnt > 0) {
-		pc_covox_write (cov, cov->smp, cnt);
-	}
+	return (tmp);
 }
 
 void pc_covox_set_data (pc_covox_t *cov, unsigned char val)
 {
+	unsigned long clk;
+
 	if (cov->disney == 0) {
-		pc_covox_check_covox (cov);
+		clk = pc_covox_check_covox (cov);
 
 		cov->smp = pc_covox_get_smp (cov, val);
+
+		if (cov->playing) {
+			snd_edge_set_level (&cov->edge, clk, cov->smp);
+		}
 	}
 
 	cov->data_val = val;
@@ -425,10 +387,16 @@ unsigned char pc_covox_get_status (pc_covox_t *cov)
 
 void pc_covox_clock (pc_covox_t *cov, unsigned long cnt)
 {
+	unsigned long clk;
+
 	if (cov->disney) {
-		pc_covox_check_disney (cov);
+		clk = pc_covox_check_disney (cov);
 	}
 	else {
-		pc_covox_check_covox (cov);
+		clk = pc_covox_check_covox (cov);
+	}
+
+	if (cov->playing) {
+		snd_edge_sync (&cov->edge, clk);
 	}
 }
@@ -26,9 +26,9 @@
 
 #include <stdint.h>
 
+#include <drivers/sound/edge.h>
 #include <drivers/sound/sound.h>
 
-#define PC_COVOX_BUF  2048
 #define PC_COVOX_FIFO 16
 
 
@@ -42,7 +42,7 @@ typedef struct {
 	unsigned char  data_val;
 	unsigned char  ctrl_val;
 
-	uint16_t       smp;
+	long           smp;
 	unsigned       vol;
 
 	unsigned char  fifo[PC_COVOX_FIFO];
@@ -53,17 +53,13 @@ typedef struct {
 	unsigned long  timeout_clk;
 
 	unsigned long  clk;
-	unsigned long  rem;
 
-	unsigned long  srate;
-
-	unsigned long  srate_div;
+	unsigned long  tick_clk;
+	unsigned long  tick_rem;
 
-	unsigned long  lowpass_freq;
-	sound_iir2_t   iir;
+	unsigned long  srate;
 
-	unsigned       buf_cnt;
-	uint16_t       buf[PC_COVOX_BUF];
+	sound_edge_t   edge;
 
 	void           *get_clk_ext;
 	unsigned long  (*get_clk) (void *ext);
@@ -82,6 +78,8 @@ void pc_covox_set_mode (pc_covox_t *cov, unsigned mode);
 
 int pc_covox_set_driver (pc_covox_t *cov, const char *driver, unsigned long srate);
 
+int pc_covox_get_delay (pc_covox_t *cov, long *us);
+
 void pc_covox_set_lowpass (pc_covox_t *cov, unsigned long freq);
 
 void pc_covox_set_volume (pc_covox_t *cov, unsigned vol);
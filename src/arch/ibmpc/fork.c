@@ -0,0 +1,275 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/arch/ibmpc/fork.c                                        *
+ * Created:     2026-10-18 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#include "main.h"
+#include "ibmpc.h"
+#include "fork.h"
+#include "msg.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_FORK
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <drivers/block/block.h>
+#include <drivers/block/blkpbi.h>
+
+#include <drivers/video/null.h>
+#include <drivers/video/terminal.h>
+
+#include <lib/log.h>
+#include <lib/monitor.h>
+
+
+#ifdef HAVE_FORK
+
+extern monitor_t par_mon;
+
+
+static
+disk_t *pc_fork_cow (disk_t *dsk, const char *prefix, unsigned idx)
+{
+	disk_t *cow;
+	char   fname[256];
+
+	sprintf (fname, "%.200s%u-%u.cow", prefix, idx, dsk_get_drive (dsk));
+
+	if ((cow = dsk_create_cow (dsk, fname, 16384)) == NULL) {
+		pce_log (MSG_ERR, "*** creating cow failed (%s)\n", fname);
+		return (dsk);
+	}
+
+	dsk_pbi_cow_set_shared (cow, 1);
+	dsk_set_readonly (cow, dsk_get_readonly (dsk));
+
+	return (cow);
+}
+
+/*
+ * PSI and PRI images are kept in memory and the floppy disk controller
+ * needs direct access to them, so they don't get a cow overlay. Instead
+ * they are saved to a file of their own.
+ */
+static
+void pc_fork_snapshot (disk_t *dsk, const char *prefix, unsigned idx)
+{
+	const char *ext;
+	char       fname[256];
+
+	ext = dsk_get_fname (dsk);
+
+	if (ext != NULL) {
+		if (strrchr (ext, '/') != NULL) {
+			ext = strrchr (ext, '/');
+		}
+
+		ext = strrchr (ext, '.');
+	}
+
+	sprintf (fname, "%.200s%u-%u%.16s", prefix, idx, dsk_get_drive (dsk),
+		(ext != NULL) ? ext : ""
+	);
+
+	dsk_set_fname (dsk, fname);
+}
+
+static
+disk_t *pc_fork_disk (disk_t *dsk, const char *prefix, unsigned idx)
+{
+	switch (dsk_get_type (dsk)) {
+	case PCE_DISK_PSI:
+	case PCE_DISK_PRI:
+		pc_fork_snapshot (dsk, prefix, idx);
+		return (dsk);
+
+	default:
+		return (pc_fork_cow (dsk, prefix, idx));
+	}
+}
+
+/*
+ * Separate every disk from the disk images that are shared with the
+ * other processes, which must no longer be written.
+ */
+static
+void pc_fork_disks (ibmpc_t *pc, const char *prefix, unsigned idx)
+{
+	unsigned i;
+
+	for (i = 0; i < pc->dsk->cnt; i++) {
+		pc->dsk->dsk[i] = pc_fork_disk (pc->dsk->dsk[i], prefix, idx);
+	}
+
+	if (pc->dsk0 != NULL) {
+		pc->dsk0 = pc_fork_disk (pc->dsk0, prefix, idx);
+	}
+}
+
+/*
+ * Write all cached changes to the disk images before they are shared.
+ * Copy on write images are not committed, the new ones are stacked on
+ * top of them. Disks that can't be synced return an error, which is
+ * ignored.
+ */
+static
+void pc_fork_sync (ibmpc_t *pc)
+{
+	unsigned i;
+
+	for (i = 0; i < pc->dsk->cnt; i++) {
+		dsk_sync (pc->dsk->dsk[i]);
+	}
+
+	if (pc->dsk0 != NULL) {
+		dsk_sync (pc->dsk0);
+	}
+}
+
+static
+void pc_fork_child (ibmpc_t *pc, const char *prefix, unsigned idx)
+{
+	char fname[256];
+
+	setsid();
+
+	/*
+	 * The terminal and sound driver connections are shared with
+	 * the parent. Forget about them without closing them.
+	 */
+	if (pc->trm != NULL) {
+		pc->trm = null_new (NULL);
+
+		if (pc->trm != NULL) {
+			trm_set_msg_fct (pc->trm, pc, pc_set_msg);
+			trm_open (pc->trm, 640, 480);
+		}
+
+		if (pc->video != NULL) {
+			pce_video_set_terminal (pc->video, pc->trm);
+		}
+	}
+
+	pc->spk.drv = NULL;
+
+	if (pc->cov != NULL) {
+		pc->cov->drv = NULL;
+	}
+
+	sprintf (fname, "%.200s%u.in", prefix, idx);
+
+	if (freopen (fname, "r", stdin) == NULL) {
+		freopen ("/dev/null", "r", stdin);
+	}
+
+	sprintf (fname, "%.200s%u.out", prefix, idx);
+
+	if (freopen (fname, "w", stdout) != NULL) {
+		dup2 (fileno (stdout), fileno (stderr));
+	}
+
+	/* terminate at the end of the clone script */
+	mon_set_eof_exit (&par_mon, 1);
+
+	pc_fork_disks (pc, prefix, idx);
+
+	pc_clock_discontinuity (pc);
+
+	pce_log_tag (MSG_INF, "FORK:", "clone %u (pid=%lu)\n",
+		idx, (unsigned long) getpid()
+	);
+}
+
+int pc_fork (ibmpc_t *pc, unsigned cnt, const char *prefix)
+{
+	unsigned i;
+	int      status;
+	pid_t    pid;
+
+	if (cnt == 0) {
+		pce_log (MSG_ERR, "*** fork: the clone count must be at least 1\n");
+		return (-1);
+	}
+
+	pc_fork_sync (pc);
+
+	/* don't duplicate pending output in the clones */
+	fflush (NULL);
+
+	for (i = 1; i <= cnt; i++) {
+		pid = fork();
+
+		if (pid == 0) {
+			/*
+			 * Fork again and let the intermediate process exit,
+			 * so the clone is reparented and reaped by init.
+			 */
+			pid = fork();
+
+			if (pid != 0) {
+				_exit ((pid < 0) ? 1 : 0);
+			}
+
+			pc_fork_child (pc, prefix, i);
+
+			return (i);
+		}
+
+		if (pid > 0) {
+			if (waitpid (pid, &status, 0) != pid) {
+				status = -1;
+			}
+		}
+
+		if ((pid < 0) || (status != 0)) {
+			pce_log (MSG_ERR, "*** fork failed (clone %u)\n", i);
+			break;
+		}
+
+		pce_log_tag (MSG_INF, "FORK:", "clone %u started\n", i);
+	}
+
+	if (i == 1) {
+		return (-1);
+	}
+
+	pc_fork_disks (pc, prefix, 0);
+
+	pc_clock_discontinuity (pc);
+
+	return (0);
+}
+
+#else
+
+int pc_fork (ibmpc_t *pc, unsigned cnt, const char *prefix)
+{
+	pce_log (MSG_ERR, "*** fork is not supported on this system\n");
+
+	return (-1);
+}
+
+#endif
@@ -0,0 +1,48 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/arch/ibmpc/fork.h                                        *
+ * Created:     2026-10-18 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#ifndef PCE_IBMPC_FORK_H
+#define PCE_IBMPC_FORK_H 1
+
+
+struct ibmpc_t;
+
+
+/*!***************************************************************************
+ * @short  Clone the running emulator
+ * @param  cnt    The number of clones
+ * @param  prefix The file name prefix for the per-clone files
+ * @return The clone index (1 to cnt) in a clone, 0 in the original
+ *         process or -1 on error
+ *
+ * All disks are committed first. Then each clone (and the original
+ * process, with index 0) puts a new copy-on-write overlay named
+ * <prefix><index>-<drive>.cow on top of every disk. PSI and PRI images
+ * are instead saved to <prefix><index>-<drive> with the original
+ * file name extension. A clone is detached from the terminal and the sound
+ * drivers, reads its monitor commands from <prefix><index>.in
+ * (if it exists) and writes its output to <prefix><index>.out.
+ *****************************************************************************/
+int pc_fork (struct ibmpc_t *pc, unsigned cnt, const char *prefix);
+
+
+#endif
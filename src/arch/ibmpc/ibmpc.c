@@ -478,7 +478,7 @@ static
 void pc_setup_system (ibmpc_t *pc, ini_sct_t *ini)
 {
 	unsigned   fdcnt, sw1val, sw1msk;
-	int        patch_init, patch_int19, memtest, kbden, cga40;
+	int        patch_init, patch_int19, memtest, kbden, cga40, sync_audio;
 	const char *model;
 	ini_sct_t  *sct;
 
@@ -515,13 +515,17 @@ void pc_setup_system (ibmpc_t *pc, ini_sct_t *ini)
 	ini_get_bool (sct, "patch_bios_init", &patch_init, 1);
 	ini_get_bool (sct, "patch_bios_int19", &patch_int19, 1);
 	ini_get_bool (sct, "memtest", &memtest, 1);
+	ini_get_bool (sct, "sync_audio", &sync_audio, 0);
 
 	pce_log_tag (MSG_INF, "SYSTEM:",
 		"model=%s floppies=%u cga40=%d sw1=%02X/%02X"
-		" patch-init=%d patch-int19=%d\n",
-		model, fdcnt, cga40, sw1val, sw1msk, patch_init, patch_int19
+		" patch-init=%d patch-int19=%d sync-audio=%d\n",
+		model, fdcnt, cga40, sw1val, sw1msk, patch_init, patch_int19,
+		sync_audio
 	);
 
+	pc->sync_audio = (sync_audio != 0);
+
 	if (strcmp (model, "5150") == 0) {
 		pc->model = PCE_IBMPC_5150;
 	}
@@ -1033,6 +1037,41 @@ void pc_setup_covox (ibmpc_t *pc, ini_sct_t *ini)
 	parport_set_status_fct (pc->parport[port], pc->cov, pc_covox_get_status);
 }
 
+static
+void pc_setup_rewind (ibmpc_t *pc, ini_sct_t *ini)
+{
+	unsigned long interval, size;
+	mem_blk_t     *ram;
+	ini_sct_t     *sct;
+
+	pc->rew = NULL;
+
+	sct = ini_next_sct (ini, NULL, "rewind");
+
+	if (sct == NULL) {
+		return;
+	}
+
+	ini_get_uint32 (sct, "interval", &interval, 1000);
+	ini_get_uint32 (sct, "size", &size, 16UL * 1024 * 1024);
+
+	pce_log_tag (MSG_INF, "REWIND:", "interval=%lums size=%luK\n",
+		interval, size / 1024
+	);
+
+	ram = mem_get_blk (pc->mem, 0);
+
+	if ((ram == NULL) || (mem_blk_get_data (ram) == NULL)) {
+		pce_log (MSG_ERR, "*** rewind requires RAM at address 0\n");
+		return;
+	}
+
+	if ((pc->rew = pc_rewind_new (ram, interval, size)) == NULL) {
+		pce_log (MSG_ERR, "*** creating rewind buffer failed\n");
+		return;
+	}
+}
+
 static
 void pc_setup_terminal (ibmpc_t *pc, ini_sct_t *ini)
 {
@@ -1692,6 +1731,7 @@ ibmpc_t *pc_new (ini_sct_t *ini)
 	pc_setup_ems (pc, ini);
 	pc_setup_xms (pc, ini);
 	pc_setup_covox (pc, ini);
+	pc_setup_rewind (pc, ini);
 
 	pce_load_mem_ini (pc->mem, ini);
 
@@ -1746,6 +1786,8 @@ void pc_del (ibmpc_t *pc)
 
 	atari_pc_del (pc);
 
+	pc_rewind_del (pc->rew);
+
 	pc_del_xms (pc);
 	pc_del_ems (pc);
 	pc_del_parport (pc);
@@ -2002,6 +2044,56 @@ void pc_clock_discontinuity (ibmpc_t *pc)
 	pc->speed_clock_extra = 0;
 }
 
+/*
+ * Get the time by which the sound output is ahead of its target
+ */
+static
+int pc_get_audio_delay (ibmpc_t *pc, long *us)
+{
+	if (pc_speaker_get_delay (&pc->spk, us) == 0) {
+		return (0);
+	}
+
+	if (pc->cov != NULL) {
+		if (pc_covox_get_delay (pc->cov, us) == 0) {
+			return (0);
+		}
+	}
+
+	return (1);
+}
+
+/*
+ * Synchronize the system clock with the sound output
+ */
+static
+int pc_clock_delay_audio (ibmpc_t *pc)
+{
+	long us;
+
+	if (pc_get_audio_delay (pc, &us)) {
+		return (1);
+	}
+
+	if (us > 0) {
+		pc->speed_clock_extra += 1;
+	}
+	else if (pc->speed_clock_extra > 0) {
+		pc->speed_clock_extra -= 1;
+	}
+
+	if (us > PCE_IBMPC_SLEEP) {
+		pce_usleep (us);
+	}
+
+	/* resume wall clock pacing from here if the sound stops */
+	pc->sync_clock2_sim = 0;
+	pc->sync_clock2_real = 0;
+	pce_get_interval_us (&pc->sync_interval);
+
+	return (0);
+}
+
 /*
  * Synchronize the system clock with real time
  */
@@ -2012,6 +2104,12 @@ void pc_clock_delay (ibmpc_t *pc)
 	unsigned long rclk;
 	unsigned long us;
 
+	if (pc->sync_audio) {
+		if (pc_clock_delay_audio (pc) == 0) {
+			return;
+		}
+	}
+
 	vclk = pc->sync_clock2_sim;
 
 	rclk = pce_get_interval_us (&pc->sync_interval);
@@ -2140,6 +2238,10 @@ void pc_clock (ibmpc_t *pc, unsigned long cnt)
 				}
 			}
 
+			if (pc->rew != NULL) {
+				pc_rewind_clock (pc->rew, pc, clk);
+			}
+
 			if (pc->clk_div[2] >= 16384) {
 				pc->clk_div[2] &= 16383;
 				pc_clock_delay (pc);
@@ -27,6 +27,7 @@
 #include "covox.h"
 #include "ems.h"
 #include "keyboard.h"
+#include "rewind.h"
 #include "speaker.h"
 #include "xms.h"
 
@@ -80,6 +81,7 @@ typedef struct ibmpc_t {
 	cassette_t         *cas;
 	pc_speaker_t       spk;
 	pc_covox_t         *cov;
+	pc_rewind_t        *rew;
 
 	unsigned           model;
 
@@ -131,6 +133,9 @@ typedef struct ibmpc_t {
 	unsigned long      sync_clock2_real;
 	unsigned long      sync_interval;
 
+	/* pace the emulation by the sound output */
+	int                sync_audio;
+
 	/* cpu speed factor */
 	unsigned           speed_current;
 	unsigned           speed_saved;
@@ -98,12 +98,13 @@ void dsk_int13_set_status (disks_t *dsks, e8086_t *cpu, unsigned val)
 static
 void dsk_int13_02 (disks_t *dsks, e8086_t *cpu)
 {
-	unsigned       i, n;
-	uint32_t       blk_i, blk_n;
-	unsigned       c, h, s;
-	unsigned long  addr;
-	unsigned char  buf[512 * INT13_MAX_BLOCKS];
-	disk_t         *dsk;
+	unsigned            i, n;
+	uint32_t            blk_i, blk_n;
+	unsigned            c, h, s;
+	unsigned long       addr;
+	unsigned char       buf[512 * INT13_MAX_BLOCKS];
+	const unsigned char *src;
+	disk_t              *dsk;
 
 	dsk = dsks_get_disk (dsks, e86_get_dl (cpu));
 	if (dsk == NULL) {
@@ -127,9 +128,16 @@ void dsk_int13_02 (disks_t *dsks, e8086_t *cpu)
 	while (blk_n > 0) {
 		n = (blk_n < INT13_MAX_BLOCKS) ? blk_n : INT13_MAX_BLOCKS;
 
-		if (dsk_read_lba (dsk, buf, blk_i, n)) {
-			dsk_int13_set_status (dsks, cpu, 0x01);
-			return;
+		/* copy straight from memory mapped images */
+		src = dsk_get_ptr (dsk, blk_i, n);
+
+		if (src == NULL) {
+			if (dsk_read_lba (dsk, buf, blk_i, n)) {
+				dsk_int13_set_status (dsks, cpu, 0x01);
+				return;
+			}
+
+			src = buf;
 		}
 
 		blk_n -= n;
@@ -138,12 +146,12 @@ void dsk_int13_02 (disks_t *dsks, e8086_t *cpu)
 		n *= 512;
 
 		if ((addr + n) <= cpu->ram_cnt) {
-			memcpy (cpu->ram + addr, buf, n);
+			memcpy (cpu->ram + addr, src, n);
 			addr += n;
 		}
 		else {
 			for (i = 0; i < n; i += 2) {
-				e86_set_mem16 (cpu, addr >> 4, addr & 0x0f, buf[i] | (buf[i + 1] << 8));
+				e86_set_mem16 (cpu, addr >> 4, addr & 0x0f, src[i] | (src[i + 1] << 8));
 				addr += 2;
 			}
 		}
@@ -22,6 +22,7 @@
 
 #include "main.h"
 #include "ibmpc.h"
+#include "fork.h"
 
 #include <string.h>
 
@@ -142,6 +143,30 @@ int pc_set_msg_emu_fdc_accurate (ibmpc_t *pc, const char *msg, const char *val)
 	return (0);
 }
 
+static
+int pc_set_msg_emu_fork (ibmpc_t *pc, const char *msg, const char *val)
+{
+	unsigned cnt;
+
+	cnt = 1;
+
+	if (*val != 0) {
+		if (msg_get_prefix_uint (&val, &cnt, ":", " \t")) {
+			return (1);
+		}
+	}
+
+	if (*val == 0) {
+		val = "clone-";
+	}
+
+	if (pc_fork (pc, cnt, val) < 0) {
+		return (1);
+	}
+
+	return (0);
+}
+
 static
 int pc_set_msg_emu_par1_file (ibmpc_t *pc, const char *msg, const char *val)
 {
@@ -237,6 +262,27 @@ int pc_set_msg_emu_reset (ibmpc_t *pc, const char *msg, const char *val)
 	return (0);
 }
 
+static
+int pc_set_msg_emu_rewind (ibmpc_t *pc, const char *msg, const char *val)
+{
+	unsigned long ms;
+
+	if (pc->rew == NULL) {
+		pce_log (MSG_ERR, "*** rewind is not enabled\n");
+		return (1);
+	}
+
+	if (msg_get_ulng (val, &ms)) {
+		return (1);
+	}
+
+	if (pc_rewind_restore (pc->rew, pc, ms)) {
+		return (1);
+	}
+
+	return (0);
+}
+
 static
 int pc_set_msg_emu_serport_driver (ibmpc_t *pc, const char *msg, const char *val)
 {
@@ -285,6 +331,7 @@ static pc_msg_list_t set_msg_list[] = {
 	{ "emu.disk.boot", pc_set_msg_emu_disk_boot },
 	{ "emu.exit", pc_set_msg_emu_exit },
 	{ "emu.fdc.accurate", pc_set_msg_emu_fdc_accurate },
+	{ "emu.fork", pc_set_msg_emu_fork },
 	{ "emu.par1.file", pc_set_msg_emu_par1_file },
 	{ "emu.par2.file", pc_set_msg_emu_par2_file },
 	{ "emu.par3.file", pc_set_msg_emu_par3_file },
@@ -293,6 +340,7 @@ static pc_msg_list_t set_msg_list[] = {
 	{ "emu.pause", pc_set_msg_emu_pause },
 	{ "emu.pause.toggle", pc_set_msg_emu_pause_toggle },
 	{ "emu.reset", pc_set_msg_emu_reset },
+	{ "emu.rewind", pc_set_msg_emu_rewind },
 	{ "emu.serport.driver", pc_set_msg_emu_serport_driver },
 	{ "emu.serport.file", pc_set_msg_emu_serport_file },
 	{ "emu.stop", pc_set_msg_emu_stop },
@@ -0,0 +1,508 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/arch/ibmpc/rewind.c                                      *
+ * Created:     2026-10-18 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#include "main.h"
+#include "ibmpc.h"
+#include "rewind.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <lib/console.h>
+#include <lib/log.h>
+
+
+static
+void pc_rewind_save_cpu (pc_rewind_cpu_t *dst, const e8086_t *c)
+{
+	unsigned i;
+
+	for (i = 0; i < 8; i++) {
+		dst->dreg[i] = c->dreg[i];
+	}
+
+	for (i = 0; i < 4; i++) {
+		dst->sreg[i] = c->sreg[i];
+	}
+
+	dst->ip = c->ip;
+	dst->flg = c->flg;
+	dst->save_flags = c->save_flags;
+	dst->cur_ip = c->cur_ip;
+
+	dst->pq_fill = c->pq_fill;
+	dst->pq_cnt = c->pq_cnt;
+
+	for (i = 0; i < E86_PQ_MAX; i++) {
+		dst->pq[i] = c->pq[i];
+	}
+
+	dst->prefix = c->prefix;
+	dst->seg_override = c->seg_override;
+	dst->state = c->state;
+	dst->irq = c->irq;
+
+	dst->int_cnt = c->int_cnt;
+	dst->int_vec = c->int_vec;
+	dst->int_cs = c->int_cs;
+	dst->int_ip = c->int_ip;
+
+	dst->delay = c->delay;
+	dst->clock = c->clock;
+	dst->opcnt = c->opcnt;
+}
+
+static
+void pc_rewind_load_cpu (e8086_t *c, const pc_rewind_cpu_t *src)
+{
+	unsigned i;
+
+	for (i = 0; i < 8; i++) {
+		c->dreg[i] = src->dreg[i];
+	}
+
+	for (i = 0; i < 4; i++) {
+		c->sreg[i] = src->sreg[i];
+	}
+
+	c->ip = src->ip;
+	c->flg = src->flg;
+	c->save_flags = src->save_flags;
+	c->cur_ip = src->cur_ip;
+
+	c->pq_fill = src->pq_fill;
+	c->pq_cnt = src->pq_cnt;
+
+	for (i = 0; i < E86_PQ_MAX; i++) {
+		c->pq[i] = src->pq[i];
+	}
+
+	c->prefix = src->prefix;
+	c->seg_override = src->seg_override;
+	c->state = src->state;
+	c->irq = src->irq;
+
+	c->int_cnt = src->int_cnt;
+	c->int_vec = src->int_vec;
+	c->int_cs = src->int_cs;
+	c->int_ip = src->int_ip;
+
+	c->delay = src->delay;
+	c->clock = src->clock;
+	c->opcnt = src->opcnt;
+}
+
+static
+void pc_rewind_state_del (pc_rewind_t *rew, pc_rewind_state_t *st)
+{
+	if (st == NULL) {
+		return;
+	}
+
+	rew->used -= sizeof (pc_rewind_state_t);
+	rew->used -= st->max * (PC_REWIND_PAGE + sizeof (unsigned long));
+
+	free (st->data);
+	free (st->idx);
+	free (st);
+}
+
+static
+void pc_rewind_state_clear (pc_rewind_t *rew, pc_rewind_state_t *st)
+{
+	rew->used -= st->max * (PC_REWIND_PAGE + sizeof (unsigned long));
+
+	free (st->data);
+	free (st->idx);
+
+	st->cnt = 0;
+	st->max = 0;
+	st->idx = NULL;
+	st->data = NULL;
+}
+
+static
+int pc_rewind_state_add_page (pc_rewind_t *rew, pc_rewind_state_t *st,
+	unsigned long idx, const unsigned char *data)
+{
+	unsigned long max;
+	unsigned long *tidx;
+	unsigned char *tdata;
+
+	if (st->cnt >= st->max) {
+		max = (st->max < 16) ? 16 : (2 * st->max);
+
+		tidx = realloc (st->idx, max * sizeof (unsigned long));
+
+		if (tidx == NULL) {
+			return (1);
+		}
+
+		st->idx = tidx;
+
+		tdata = realloc (st->data, max * PC_REWIND_PAGE);
+
+		if (tdata == NULL) {
+			return (1);
+		}
+
+		st->data = tdata;
+
+		rew->used += (max - st->max) * (PC_REWIND_PAGE + sizeof (unsigned long));
+
+		st->max = max;
+	}
+
+	st->idx[st->cnt] = idx;
+	memcpy (st->data + st->cnt * PC_REWIND_PAGE, data, PC_REWIND_PAGE);
+
+	st->cnt += 1;
+
+	return (0);
+}
+
+/*
+ * Remove the oldest state
+ */
+static
+void pc_rewind_drop_oldest (pc_rewind_t *rew)
+{
+	pc_rewind_state_t *st;
+
+	st = rew->oldest;
+
+	if (st == NULL) {
+		return;
+	}
+
+	rew->oldest = st->newer;
+
+	if (rew->oldest != NULL) {
+		rew->oldest->older = NULL;
+	}
+	else {
+		rew->newest = NULL;
+	}
+
+	rew->cnt -= 1;
+
+	pc_rewind_state_del (rew, st);
+}
+
+/*
+ * Remove the newest state
+ */
+static
+void pc_rewind_drop_newest (pc_rewind_t *rew)
+{
+	pc_rewind_state_t *st;
+
+	st = rew->newest;
+
+	if (st == NULL) {
+		return;
+	}
+
+	rew->newest = st->older;
+
+	if (rew->newest != NULL) {
+		rew->newest->newer = NULL;
+	}
+	else {
+		rew->oldest = NULL;
+	}
+
+	rew->cnt -= 1;
+
+	pc_rewind_state_del (rew, st);
+}
+
+pc_rewind_t *pc_rewind_new (mem_blk_t *ram, unsigned long interval, unsigned long limit)
+{
+	pc_rewind_t *rew;
+
+	if ((rew = malloc (sizeof (pc_rewind_t))) == NULL) {
+		return (NULL);
+	}
+
+	rew->interval = (unsigned long) (((unsigned long long) PCE_IBMPC_CLK2 * interval) / 1000);
+
+	if (rew->interval == 0) {
+		rew->interval = 1;
+	}
+
+	rew->clk = 0;
+
+	rew->limit = limit;
+	rew->used = 0;
+
+	rew->time = 0;
+	rew->time_rem = 0;
+
+	rew->ram = ram;
+	rew->ram_size = 0;
+	rew->ref = NULL;
+
+	rew->cnt = 0;
+	rew->newest = NULL;
+	rew->oldest = NULL;
+
+	return (rew);
+}
+
+void pc_rewind_del (pc_rewind_t *rew)
+{
+	if (rew == NULL) {
+		return;
+	}
+
+	pc_rewind_reset (rew);
+
+	free (rew);
+}
+
+void pc_rewind_reset (pc_rewind_t *rew)
+{
+	while (rew->oldest != NULL) {
+		pc_rewind_drop_oldest (rew);
+	}
+
+	free (rew->ref);
+
+	rew->ref = NULL;
+	rew->ram_size = 0;
+	rew->used = 0;
+	rew->clk = 0;
+}
+
+int pc_rewind_save (pc_rewind_t *rew, ibmpc_t *pc)
+{
+	unsigned long     i, n, size;
+	unsigned char     *ram;
+	pc_rewind_state_t *st;
+
+	ram = mem_blk_get_data (rew->ram);
+	size = mem_blk_get_size (rew->ram) & ~(PC_REWIND_PAGE - 1UL);
+
+	if ((ram == NULL) || (size == 0)) {
+		return (1);
+	}
+
+	if (rew->ram_size != size) {
+		pc_rewind_reset (rew);
+
+		if ((rew->ref = malloc (size)) == NULL) {
+			return (1);
+		}
+
+		rew->ram_size = size;
+		rew->used = size;
+
+		memcpy (rew->ref, ram, size);
+	}
+
+	if ((st = malloc (sizeof (pc_rewind_state_t))) == NULL) {
+		return (1);
+	}
+
+	rew->used += sizeof (pc_rewind_state_t);
+
+	st->older = NULL;
+	st->newer = NULL;
+	st->time = rew->time;
+
+	st->cnt = 0;
+	st->max = 0;
+	st->idx = NULL;
+	st->data = NULL;
+
+	pc_rewind_save_cpu (&st->cpu, pc->cpu);
+	st->dma = pc->dma;
+	st->pit = pc->pit;
+	st->ppi = pc->ppi;
+	st->pic = pc->pic;
+	st->kbd = pc->kbd;
+
+	st->ppi_port_a[0] = pc->ppi_port_a[0];
+	st->ppi_port_a[1] = pc->ppi_port_a[1];
+	st->ppi_port_b = pc->ppi_port_b;
+	st->ppi_port_c[0] = pc->ppi_port_c[0];
+	st->ppi_port_c[1] = pc->ppi_port_c[1];
+	st->timer1_out = pc->timer1_out;
+	st->dack0 = pc->dack0;
+	st->current_int = pc->current_int;
+
+	for (i = 0; i < 4; i++) {
+		st->dma_page[i] = pc->dma_page[i];
+	}
+
+	if (rew->newest != NULL) {
+		/* turn the previous state into a delta against this one */
+		n = size / PC_REWIND_PAGE;
+
+		for (i = 0; i < n; i++) {
+			unsigned char *p1 = ram + i * PC_REWIND_PAGE;
+			unsigned char *p2 = rew->ref + i * PC_REWIND_PAGE;
+
+			if (memcmp (p1, p2, PC_REWIND_PAGE) == 0) {
+				continue;
+			}
+
+			if (pc_rewind_state_add_page (rew, rew->newest, i, p2)) {
+				pce_log (MSG_ERR, "*** rewind: out of memory\n");
+				pc_rewind_state_del (rew, st);
+				pc_rewind_reset (rew);
+				return (1);
+			}
+
+			memcpy (p2, p1, PC_REWIND_PAGE);
+		}
+
+		rew->newest->newer = st;
+		st->older = rew->newest;
+	}
+	else {
+		rew->oldest = st;
+	}
+
+	rew->newest = st;
+	rew->cnt += 1;
+
+	while ((rew->used > rew->limit) && (rew->oldest != rew->newest)) {
+		pc_rewind_drop_oldest (rew);
+	}
+
+	return (0);
+}
+
+int pc_rewind_restore (pc_rewind_t *rew, ibmpc_t *pc, unsigned long ms)
+{
+	unsigned long     i, time;
+	unsigned char     *ram;
+	pc_rewind_state_t *st, *dst;
+
+	if (rew->newest == NULL) {
+		return (1);
+	}
+
+	time = (ms < rew->time) ? (rew->time - ms) : 0;
+
+	dst = rew->newest;
+
+	while ((dst->older != NULL) && (dst->time > time)) {
+		dst = dst->older;
+	}
+
+	/* rebuild the RAM contents of the destination state */
+	st = rew->newest;
+
+	while (st != dst) {
+		st = st->older;
+
+		for (i = 0; i < st->cnt; i++) {
+			memcpy (rew->ref + st->idx[i] * PC_REWIND_PAGE,
+				st->data + i * PC_REWIND_PAGE, PC_REWIND_PAGE
+			);
+		}
+	}
+
+	while (rew->newest != dst) {
+		pc_rewind_drop_newest (rew);
+	}
+
+	pc_rewind_state_clear (rew, dst);
+
+	ram = mem_blk_get_data (rew->ram);
+
+	memcpy (ram, rew->ref, rew->ram_size);
+
+	pc_rewind_load_cpu (pc->cpu, &dst->cpu);
+	pc->dma = dst->dma;
+	pc->pit = dst->pit;
+	pc->ppi = dst->ppi;
+	pc->pic = dst->pic;
+	pc->kbd = dst->kbd;
+
+	pc->ppi_port_a[0] = dst->ppi_port_a[0];
+	pc->ppi_port_a[1] = dst->ppi_port_a[1];
+	pc->ppi_port_b = dst->ppi_port_b;
+	pc->ppi_port_c[0] = dst->ppi_port_c[0];
+	pc->ppi_port_c[1] = dst->ppi_port_c[1];
+	pc->timer1_out = dst->timer1_out;
+	pc->dack0 = dst->dack0;
+	pc->current_int = dst->current_int;
+
+	for (i = 0; i < 4; i++) {
+		pc->dma_page[i] = dst->dma_page[i];
+	}
+
+	pce_log_tag (MSG_INF, "REWIND:", "going back %lu ms (to %lu ms)\n",
+		rew->time - dst->time, dst->time
+	);
+
+	rew->time = dst->time;
+	rew->time_rem = 0;
+	rew->clk = 0;
+
+	pc_clock_discontinuity (pc);
+
+	if (pc->video != NULL) {
+		pce_video_redraw (pc->video, 0);
+	}
+
+	return (0);
+}
+
+void pc_rewind_print_info (pc_rewind_t *rew)
+{
+	unsigned long oldest;
+
+	oldest = (rew->oldest != NULL) ? rew->oldest->time : rew->time;
+
+	pce_printf ("REWIND: STATES=%u TIME=%lu ms RANGE=%lu ms"
+		" MEM=%luK/%luK INTERVAL=%lu ms\n",
+		rew->cnt, rew->time, rew->time - oldest,
+		rew->used / 1024, rew->limit / 1024,
+		(unsigned long) ((1000ULL * rew->interval + PCE_IBMPC_CLK2 / 2) / PCE_IBMPC_CLK2)
+	);
+}
+
+void pc_rewind_clock (pc_rewind_t *rew, ibmpc_t *pc, unsigned long cnt)
+{
+	rew->time_rem += 1000 * cnt;
+	rew->time += rew->time_rem / PCE_IBMPC_CLK2;
+	rew->time_rem %= PCE_IBMPC_CLK2;
+
+	rew->clk += cnt;
+
+	if (rew->clk < rew->interval) {
+		return;
+	}
+
+	rew->clk -= rew->interval;
+
+	if (rew->clk >= rew->interval) {
+		rew->clk = 0;
+	}
+
+	pc_rewind_save (rew, pc);
+}
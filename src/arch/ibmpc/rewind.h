@@ -0,0 +1,183 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/arch/ibmpc/rewind.h                                      *
+ * Created:     2026-10-18 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#ifndef PCE_IBMPC_REWIND_H
+#define PCE_IBMPC_REWIND_H 1
+
+
+#include "keyboard.h"
+
+#include <chipset/82xx/e8237.h>
+#include <chipset/82xx/e8253.h>
+#include <chipset/82xx/e8255.h>
+#include <chipset/82xx/e8259.h>
+
+#include <cpu/e8086/e8086.h>
+
+#include <devices/memory.h>
+
+
+/* the granularity of the RAM deltas */
+#define PC_REWIND_PAGE 1024
+
+
+struct ibmpc_t;
+
+
+/*!***************************************************************************
+ * @short The architectural CPU state
+ *
+ * Only the registers and the execution state are saved. The memory and
+ * port functions, the hooks and the opcode table belong to the machine
+ * configuration and are left alone by a rewind.
+ *****************************************************************************/
+typedef struct {
+	unsigned short dreg[8];
+	unsigned short sreg[4];
+	unsigned short ip;
+	unsigned short flg;
+	unsigned short save_flags;
+	unsigned short cur_ip;
+
+	unsigned       pq_fill;
+	unsigned       pq_cnt;
+	unsigned char  pq[E86_PQ_MAX];
+
+	unsigned       prefix;
+	unsigned short seg_override;
+	unsigned char  state;
+	char           irq;
+
+	unsigned       int_cnt;
+	unsigned char  int_vec;
+	unsigned short int_cs;
+	unsigned short int_ip;
+
+	unsigned long  delay;
+	unsigned long  clock;
+	unsigned       opcnt;
+} pc_rewind_cpu_t;
+
+
+/*!***************************************************************************
+ * @short A single machine state
+ *
+ * The newest state in the ring has no delta, its RAM contents are kept
+ * in the reference copy. Every older state stores the RAM pages that
+ * differ from the next newer state.
+ *****************************************************************************/
+typedef struct pc_rewind_state_s {
+	struct pc_rewind_state_s *older;
+	struct pc_rewind_state_s *newer;
+
+	/* emulated time in milliseconds */
+	unsigned long   time;
+
+	pc_rewind_cpu_t cpu;
+	e8237_t         dma;
+	e8253_t         pit;
+	e8255_t         ppi;
+	e8259_t         pic;
+	pc_kbd_t        kbd;
+
+	unsigned char   ppi_port_a[2];
+	unsigned char   ppi_port_b;
+	unsigned char   ppi_port_c[2];
+	unsigned char   timer1_out;
+	unsigned char   dack0;
+	unsigned long   dma_page[4];
+	unsigned        current_int;
+
+	/* the number of pages in the delta */
+	unsigned long   cnt;
+	unsigned long   max;
+	unsigned long   *idx;
+	unsigned char   *data;
+} pc_rewind_state_t;
+
+
+typedef struct {
+	/* the snapshot interval in 1.19 MHz clocks */
+	unsigned long     interval;
+	unsigned long     clk;
+
+	/* the memory budget in bytes */
+	unsigned long     limit;
+	unsigned long     used;
+
+	/* emulated time in milliseconds */
+	unsigned long     time;
+	unsigned long     time_rem;
+
+	/* the RAM block at address 0 */
+	mem_blk_t         *ram;
+
+	unsigned long     ram_size;
+	unsigned char     *ref;
+
+	unsigned          cnt;
+	pc_rewind_state_t *newest;
+	pc_rewind_state_t *oldest;
+} pc_rewind_t;
+
+
+/*!***************************************************************************
+ * @short  Create a new rewind ring
+ * @param  ram      The RAM block at address 0
+ * @param  interval The snapshot interval in milliseconds
+ * @param  limit    The memory budget in bytes
+ * @return The rewind ring or NULL on error
+ *****************************************************************************/
+pc_rewind_t *pc_rewind_new (mem_blk_t *ram, unsigned long interval, unsigned long limit);
+
+void pc_rewind_del (pc_rewind_t *rew);
+
+/*!***************************************************************************
+ * @short Discard all states
+ *****************************************************************************/
+void pc_rewind_reset (pc_rewind_t *rew);
+
+/*!***************************************************************************
+ * @short Take a snapshot of the current machine state
+ *****************************************************************************/
+int pc_rewind_save (pc_rewind_t *rew, struct ibmpc_t *pc);
+
+/*!***************************************************************************
+ * @short  Go back in time
+ * @param  ms The number of emulated milliseconds to go back
+ * @return Zero if successful, nonzero otherwise
+ *
+ * The newest state that is at least ms milliseconds old is restored and
+ * all newer states are discarded.
+ *****************************************************************************/
+int pc_rewind_restore (pc_rewind_t *rew, struct ibmpc_t *pc, unsigned long ms);
+
+void pc_rewind_print_info (pc_rewind_t *rew);
+
+/*!***************************************************************************
+ * @short Advance the rewind clock
+ * @param cnt The number of 1.19 MHz clocks that have passed
+ *****************************************************************************/
+void pc_rewind_clock (pc_rewind_t *rew, struct ibmpc_t *pc, unsigned long cnt);
+
+
+#endif
@@ -26,6 +26,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#include <drivers/sound/edge.h>
 #include <drivers/sound/sound.h>
 
 
@@ -35,57 +36,7 @@
 
 
 static
-void pc_speaker_play (pc_speaker_t *spk, uint16_t *buf, unsigned cnt)
-{
-	if (spk->lowpass_freq > 0) {
-		snd_iir2_filter (&spk->iir, buf, buf, cnt, 1, 1);
-	}
-
-	snd_write (spk->drv, buf, cnt);
-}
-
-static
-void pc_speaker_write (pc_speaker_t *spk, uint16_t val, unsigned long cnt)
-{
-	unsigned idx;
-
-	if (spk->drv == NULL) {
-		return;
-	}
-
-	idx = spk->buf_cnt;
-
-	while (cnt > 0) {
-		spk->buf[idx++] = val;
-
-		if (idx >= PC_SPEAKER_BUF) {
-			pc_speaker_play (spk, spk->buf, idx);
-
-			idx = 0;
-		}
-
-		cnt -= 1;
-	}
-
-	spk->buf_cnt = idx;
-}
-
-static
-void pc_speaker_flush (pc_speaker_t *spk)
-{
-	if (spk->buf_cnt == 0) {
-		return;
-	}
-
-	pc_speaker_play (spk, spk->buf, spk->buf_cnt);
-
-	snd_iir2_reset (&spk->iir);
-
-	spk->buf_cnt = 0;
-}
-
-static
-void pc_speaker_on (pc_speaker_t *spk)
+void pc_speaker_on (pc_speaker_t *spk, unsigned long clk)
 {
 #if DEBUG_SPEAKER >= 1
 	pc_log_deb ("speaker on\n");
@@ -93,19 +44,14 @@ void pc_speaker_on (pc_speaker_t *spk)
 
 	spk->playing = 1;
 
-	spk->timeout_val = 0x8000;
+	spk->timeout_val = 0;
 	spk->timeout_clk = 0;
 
-	spk->sample_acc = 0x8000;
-
-	spk->rem = 0;
-
-	/* Fill the sound buffer a bit so we don't underrun immediately */
-	pc_speaker_write (spk, 0, spk->srate / 8);
+	snd_edge_start (&spk->edge, clk);
 }
 
 static
-void pc_speaker_off (pc_speaker_t *spk)
+void pc_speaker_off (pc_speaker_t *spk, unsigned long clk)
 {
 #if DEBUG_SPEAKER >= 1
 	pc_log_deb ("speaker off\n");
@@ -113,17 +59,17 @@ void pc_speaker_off (pc_speaker_t *spk)
 
 	spk->playing = 0;
 
-	pc_speaker_flush (spk);
+	snd_edge_stop (&spk->edge, clk);
 }
 
 static
-void pc_speaker_check (pc_speaker_t *spk)
+unsigned long pc_speaker_check (pc_speaker_t *spk)
 {
-	unsigned long  clk, tmp, acc;
-	uint16_t       val;
+	unsigned long clk, tmp;
+	long          val;
 
 	if (spk->speaker_msk == 0) {
-		val = 0x8000;
+		val = 0;
 	}
 	else {
 		val = spk->speaker_out ? spk->val_on : spk->val_off;
@@ -134,41 +80,28 @@ void pc_speaker_check (pc_speaker_t *spk)
 	spk->clk = tmp;
 
 	if (spk->playing == 0) {
-		if (spk->timeout_val != val) {
-			pc_speaker_on (spk);
+		if (spk->timeout_val == val) {
+			return (tmp);
 		}
-		return;
+
+		pc_speaker_on (spk, tmp);
 	}
 	else if (spk->timeout_val == val) {
 		spk->timeout_clk += clk;
 
 		if (spk->timeout_clk > (2 * PCE_IBMPC_CLK2)) {
-			pc_speaker_off (spk);
-			return;
+			pc_speaker_off (spk, tmp);
 		}
-	}
-	else {
-		spk->timeout_val = val;
-		spk->timeout_clk = clk;
-	}
-
-	acc = spk->sample_acc;
-
-	while (clk > 0) {
-		/* about 3000 Hz cut-off */
-		acc = (63 * acc + val) / 64;
 
-		spk->rem += spk->srate;
+		return (tmp);
+	}
 
-		if (spk->rem >= PCE_IBMPC_CLK2) {
-			pc_speaker_write (spk, acc ^ 0x8000, 1);
-			spk->rem -= PCE_IBMPC_CLK2;
-		}
+	spk->timeout_val = val;
+	spk->timeout_clk = 0;
 
-		clk -= 1;
-	}
+	snd_edge_set_level (&spk->edge, tmp, val);
 
-	spk->sample_acc = acc;
+	return (tmp);
 }
 
 void pc_speaker_init (pc_speaker_t *spk)
@@ -181,27 +114,23 @@ void pc_speaker_init (pc_speaker_t *spk)
 	spk->speaker_out = 0;
 
 	spk->timeout_clk = 0;
-	spk->timeout_val = 0x8000;
+	spk->timeout_val = 0;
 
 	spk->clk = 0;
-	spk->rem = 0;
-
-	spk->sample_acc = 0x8000;
 
 	spk->srate = 44100;
 
-	spk->lowpass_freq = 0;
-
-	snd_iir2_init (&spk->iir);
+	snd_edge_init (&spk->edge, PCE_IBMPC_CLK2);
 
-	spk->buf_cnt = 0;
+	/* about 3000 Hz cut-off */
+	snd_edge_set_smoothing (&spk->edge, 3000);
 
 	pc_speaker_set_volume (spk, 500);
 }
 
 void pc_speaker_free (pc_speaker_t *spk)
 {
-	pc_speaker_flush (spk);
+	snd_edge_free (&spk->edge);
 
 	if (spk->drv != NULL) {
 		snd_close (spk->drv);
@@ -240,6 +169,7 @@ void pc_speaker_set_clk_fct (pc_speaker_t *spk, void *ext, void *fct)
 int pc_speaker_set_driver (pc_speaker_t *spk, const char *driver, unsigned long srate)
 {
 	if (spk->drv != NULL) {
+		snd_edge_set_driver (&spk->edge, NULL, spk->srate);
 		snd_close (spk->drv);
 	}
 
@@ -257,14 +187,27 @@ int pc_speaker_set_driver (pc_speaker_t *spk, const char *driver, unsigned long
 		return (1);
 	}
 
+	if (snd_edge_set_driver (&spk->edge, spk->drv, srate)) {
+		snd_close (spk->drv);
+		spk->drv = NULL;
+		return (1);
+	}
+
 	return (0);
 }
 
-void pc_speaker_set_lowpass (pc_speaker_t *spk, unsigned long freq)
+int pc_speaker_get_delay (pc_speaker_t *spk, long *us)
 {
-	spk->lowpass_freq = freq;
+	if ((spk->drv == NULL) || (spk->playing == 0)) {
+		return (1);
+	}
 
-	snd_iir2_set_lowpass (&spk->iir, spk->lowpass_freq, spk->srate);
+	return (snd_edge_get_delay (&spk->edge, us));
+}
+
+void pc_speaker_set_lowpass (pc_speaker_t *spk, unsigned long freq)
+{
+	snd_edge_set_lowpass (&spk->edge, freq);
 }
 
 void pc_speaker_set_volume (pc_speaker_t *spk, unsigned vol)
@@ -275,26 +218,31 @@ void pc_speaker_set_volume (pc_speaker_t *spk, unsigned vol)
 
 	vol = (32767UL * vol) / 1000;
 
-	spk->val_msk = 0;
-	spk->val_on = 0x8000 + vol;
-	spk->val_off = 0x8000 - vol;
+	spk->val_on = vol;
+	spk->val_off = -(long) vol;
 }
 
 void pc_speaker_set_msk (pc_speaker_t *spk, unsigned char val)
 {
-	pc_speaker_check (spk);
-
 	spk->speaker_msk = (val != 0);
+
+	pc_speaker_check (spk);
 }
 
 void pc_speaker_set_out (pc_speaker_t *spk, unsigned char val)
 {
-	pc_speaker_check (spk);
-
 	spk->speaker_out = (val != 0);
+
+	pc_speaker_check (spk);
 }
 
 void pc_speaker_clock (pc_speaker_t *spk, unsigned long cnt)
 {
-	pc_speaker_check (spk);
+	unsigned long clk;
+
+	clk = pc_speaker_check (spk);
+
+	if (spk->playing) {
+		snd_edge_sync (&spk->edge, clk);
+	}
 }
@@ -26,12 +26,10 @@
 
 #include <stdint.h>
 
+#include <drivers/sound/edge.h>
 #include <drivers/sound/sound.h>
 
 
-#define PC_SPEAKER_BUF 1024
-
-
 typedef struct {
 	sound_drv_t    *drv;
 
@@ -40,25 +38,17 @@ typedef struct {
 	char           speaker_msk;
 	char           speaker_out;
 
-	uint16_t       timeout_val;
+	long           timeout_val;
 	unsigned long  timeout_clk;
 
 	unsigned long  clk;
-	unsigned long  rem;
-
-	unsigned long  sample_acc;
 
 	unsigned long  srate;
 
-	unsigned long  lowpass_freq;
-	sound_iir2_t   iir;
+	long           val_on;
+	long           val_off;
 
-	unsigned       buf_cnt;
-	uint16_t       buf[PC_SPEAKER_BUF];
-
-	uint16_t       val_msk;
-	uint16_t       val_on;
-	uint16_t       val_off;
+	sound_edge_t   edge;
 
 	void           *get_clk_ext;
 	unsigned long  (*get_clk) (void *ext);
@@ -75,6 +65,8 @@ void pc_speaker_set_clk_fct (pc_speaker_t *spk, void *ext, void *fct);
 
 int pc_speaker_set_driver (pc_speaker_t *spk, const char *driver, unsigned long srate);
 
+int pc_speaker_get_delay (pc_speaker_t *spk, long *us);
+
 void pc_speaker_set_lowpass (pc_speaker_t *spk, unsigned long freq);
 
 void pc_speaker_set_volume (pc_speaker_t *spk, unsigned vol);
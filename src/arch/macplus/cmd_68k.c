@@ -48,7 +48,7 @@ mon_cmd_t par_cmd[] = {
 	{ "reset", "", "reset" },
 	{ "rte", "", "execute to next rte" },
 	{ "r", "reg [val]", "get or set a register" },
-	{ "s", "[what]", "print status (cpu|disks|mem|scc|via)" },
+	{ "s", "[what]", "print status (cpu|disks|mem|scc|term|via)" },
 	{ "t", "[cnt]", "execute cnt instructions [1]" },
 	{ "u", "[[-]addr [cnt]]", "disassemble" }
 };
@@ -283,6 +283,18 @@ void mac_prt_state_mem (macplus_t *sim)
 	mem_prt_state (sim->mem, stdout);
 }
 
+static
+void mac_prt_state_term (macplus_t *sim)
+{
+	if (sim->trm == NULL) {
+		return;
+	}
+
+	pce_prt_sep ("TERMINAL");
+
+	trm_print_info (sim->trm, pce_get_fp_out());
+}
+
 void mac_prt_state (macplus_t *sim, const char *str)
 {
 	cmd_t cmd;
@@ -306,6 +318,9 @@ void mac_prt_state (macplus_t *sim, const char *str)
 		else if (cmd_match (&cmd, "scc")) {
 			mac_prt_state_scc (sim);
 		}
+		else if (cmd_match (&cmd, "term")) {
+			mac_prt_state_term (sim);
+		}
 		else if (cmd_match (&cmd, "via")) {
 			mac_prt_state_via (sim);
 		}
@@ -659,6 +674,8 @@ void mac_cmd_hm (cmd_t *cmd)
 		"emu.ser2.file        <filename>\n"
 		"emu.ser2.multi       <count>\n"
 		"\n"
+		"emu.term.capture     [<filename>]\n"
+		"emu.term.frame_skip  <max>\n"
 		"emu.term.fullscreen  \"0\" | \"1\"\n"
 		"emu.term.fullscreen.toggle\n"
 		"emu.term.grab\n"
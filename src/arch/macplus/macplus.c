@@ -594,7 +594,7 @@ void mac_scc_set_uint8 (void *ext, unsigned long addr, unsigned char val)
 static
 void mac_setup_system (macplus_t *sim, ini_sct_t *ini)
 {
-	int        memtest;
+	int        memtest, sync_audio;
 	const char *model;
 	ini_sct_t  *sct;
 
@@ -608,10 +608,14 @@ void mac_setup_system (macplus_t *sim, ini_sct_t *ini)
 		ini_get_bool (ini, "memtest", &memtest, 1);
 	}
 
-	pce_log_tag (MSG_INF, "SYSTEM:", "model=%s memtest=%d\n",
-		model, memtest
+	ini_get_bool (sct, "sync_audio", &sync_audio, 0);
+
+	pce_log_tag (MSG_INF, "SYSTEM:", "model=%s memtest=%d sync-audio=%d\n",
+		model, memtest, sync_audio
 	);
 
+	sim->sync_audio = (sync_audio != 0);
+
 	if (strcmp (model, "mac-128k") == 0) {
 		sim->model = PCE_MAC_PLUS;
 	}
@@ -1554,6 +1558,36 @@ void mac_reset (macplus_t *sim)
 	sim->reset = 0;
 }
 
+/*
+ * Synchronize the emulation with the sound output
+ */
+static
+int mac_audio_sync (macplus_t *sim)
+{
+	long us;
+
+	if (mac_sound_get_delay (&sim->sound, &us)) {
+		return (1);
+	}
+
+	if (us > 0) {
+		sim->speed_clock_extra += 1;
+	}
+	else if (sim->speed_clock_extra > 0) {
+		sim->speed_clock_extra -= 1;
+	}
+
+	if (us >= MAC_CPU_SLEEP) {
+		pce_usleep (us);
+	}
+
+	/* resume real time synchronization from here if the sound stops */
+	sim->sync_sleep = 0;
+	pce_get_interval_us (&sim->sync_us);
+
+	return (0);
+}
+
 static
 void mac_realtime_sync (macplus_t *sim, unsigned long n)
 {
@@ -1564,6 +1598,12 @@ void mac_realtime_sync (macplus_t *sim, unsigned long n)
 	if (sim->sync_clk >= (MAC_CPU_CLOCK / MAC_CPU_SYNC)) {
 		sim->sync_clk -= (MAC_CPU_CLOCK / MAC_CPU_SYNC);
 
+		if (sim->sync_audio) {
+			if (mac_audio_sync (sim) == 0) {
+				return;
+			}
+		}
+
 		us1 = pce_get_interval_us (&sim->sync_us);
 		us2 = (1000000 / MAC_CPU_SYNC);
 
@@ -133,6 +133,9 @@ struct macplus_s {
 	unsigned long      sync_us;
 	long               sync_sleep;
 
+	/* pace the emulation by the sound output */
+	int                sync_audio;
+
 	unsigned           ser_clk;
 
 	unsigned long long clk_cnt;
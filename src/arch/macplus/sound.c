@@ -248,6 +248,15 @@ void mac_sound_speaker_off (mac_sound_t *ms)
 #endif
 }
 
+int mac_sound_get_delay (mac_sound_t *ms, long *us)
+{
+	if ((ms->drv == NULL) || (ms->silence_cnt >= MAC_SOUND_SILENCE)) {
+		return (1);
+	}
+
+	return (snd_get_delay (ms->drv, ms->cnt, us));
+}
+
 void mac_sound_vbl (mac_sound_t *ms)
 {
 	if (ms->sbuf == NULL) {
@@ -65,6 +65,8 @@ void mac_sound_set_enable (mac_sound_t *ms, int on);
 
 int mac_sound_set_driver (mac_sound_t *ms, const char *driver);
 
+int mac_sound_get_delay (mac_sound_t *ms, long *us);
+
 void mac_sound_vbl (mac_sound_t *ms);
 
 void mac_sound_clock (mac_sound_t *ms, unsigned long cnt);
@@ -37,6 +37,27 @@
 /* #define MAC_VIDEO_VB2 (((342 + 28) * (512 + 192) * 7833600) / MAC_VIDEO_PFREQ) */
 #define MAC_VIDEO_VB2 130240
 
+/* the frame duration in microseconds */
+#define MAC_VIDEO_FRAME_US ((1000000ULL * (342 + 28) * (512 + 192)) / MAC_VIDEO_PFREQ)
+
+
+/*
+ * Rebuild the expansion table from the colors and the brightness
+ */
+static
+void mac_video_set_mono (mac_video_t *mv)
+{
+	unsigned      i;
+	unsigned char col0[3], col1[3];
+
+	for (i = 0; i < 3; i++) {
+		col0[i] = (mv->brightness * mv->col0[i]) / 255;
+		col1[i] = (mv->brightness * mv->col1[i]) / 255;
+	}
+
+	/* set bits are drawn in col0 */
+	mono_tab_set_color (&mv->mono, col1, col0);
+}
 
 int mac_video_init (mac_video_t *mv, unsigned w, unsigned h)
 {
@@ -56,7 +77,7 @@ int mac_video_init (mac_video_t *mv, unsigned w, unsigned h)
 		return (1);
 	}
 
-	mv->rgb = malloc (3UL * (unsigned long) w * mv->cmp_cnt);
+	mv->rgb = malloc (4UL * (unsigned long) w * mv->cmp_cnt);
 
 	if (mv->rgb == NULL) {
 		return (1);
@@ -72,6 +93,8 @@ int mac_video_init (mac_video_t *mv, unsigned w, unsigned h)
 	mv->col1[1] = 0xff;
 	mv->col1[2] = 0xff;
 
+	mono_tab_init (&mv->mono, mv->col1, mv->col0);
+
 	mv->clk = 0;
 
 	mv->vbi_val = 0;
@@ -127,6 +150,7 @@ void mac_video_set_terminal (mac_video_t *mv, terminal_t *trm)
 	mv->trm = trm;
 
 	if (mv->trm != NULL) {
+		trm_set_bpp (mv->trm, 4);
 		trm_open (mv->trm, mv->w, mv->h);
 	}
 }
@@ -140,6 +164,8 @@ void mac_video_set_color (mac_video_t *mv, unsigned long col0, unsigned long col
 		mv->col1[i] = (col1 >> (8 * (2 - i))) & 0xff;
 	}
 
+	mac_video_set_mono (mv);
+
 	mv->force = 1;
 }
 
@@ -152,6 +178,8 @@ void mac_video_set_brightness (mac_video_t *mv, unsigned val)
 	if (mv->brightness != val) {
 		mv->force = 1;
 		mv->brightness = val;
+
+		mac_video_set_mono (mv);
 	}
 }
 
@@ -173,11 +201,9 @@ static
 void mac_video_update (mac_video_t *mv)
 {
 	unsigned            y;
-	unsigned            i, j;
 	unsigned            k, n;
 	const unsigned char *src;
 	unsigned char       *dst, *rgb;
-	unsigned char       col0[3], col1[3];
 
 	if (mv->trm == NULL) {
 		return;
@@ -187,11 +213,6 @@ void mac_video_update (mac_video_t *mv)
 		return;
 	}
 
-	for (i = 0; i < 3; i++) {
-		col0[i] = (mv->brightness * mv->col0[i]) / 255;
-		col1[i] = (mv->brightness * mv->col1[i]) / 255;
-	}
-
 	trm_set_size (mv->trm, mv->w, mv->h);
 
 	src = mv->vbuf;
@@ -211,21 +232,7 @@ void mac_video_update (mac_video_t *mv)
 		if (mv->force || (memcmp (dst, src, k) != 0)) {
 			memcpy (dst, src, k);
 
-			j = 0;
-			for (i = 0; i < (8 * k); i++) {
-				if (dst[i >> 3] & (0x80 >> (i & 7))) {
-					rgb[j + 0] = col0[0];
-					rgb[j + 1] = col0[1];
-					rgb[j + 2] = col0[2];
-				}
-				else {
-					rgb[j + 0] = col1[0];
-					rgb[j + 1] = col1[1];
-					rgb[j + 2] = col1[2];
-				}
-
-				j += 3;
-			}
+			mono_tab_expand (&mv->mono, rgb, dst, k);
 
 			trm_set_lines (mv->trm, rgb, y, n);
 		}
@@ -260,7 +267,10 @@ void mac_video_clock (mac_video_t *mv, unsigned long n)
 
 	if (old < MAC_VIDEO_VB1) {
 		/* vbl start */
-		mac_video_update (mv);
+		if ((mv->trm != NULL) && (trm_skip_frame (mv->trm, MAC_VIDEO_FRAME_US) == 0)) {
+			mac_video_update (mv);
+		}
+
 		mac_video_set_vbi (mv, 1);
 	}
 
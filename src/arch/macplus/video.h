@@ -24,6 +24,7 @@
 #define PCE_MACPLUS_VIDEO_H 1
 
 
+#include <drivers/video/mono.h>
 #include <drivers/video/terminal.h>
 
 
@@ -45,6 +46,9 @@ typedef struct {
 	unsigned char       col0[3];
 	unsigned char       col1[3];
 
+	/* the expansion table, built from the colors and the brightness */
+	mono_tab_t          mono;
+
 	unsigned long       clk;
 
 	terminal_t          *trm;
@@ -49,7 +49,7 @@ static mon_cmd_t par_cmd[] = {
 	{ "pq", "[c|f|s]", "prefetch queue clear/fill/status" },
 	{ "p", "[cnt]", "execute cnt instructions, without trace in calls [1]" },
 	{ "r", "[reg val]", "set a register" },
-	{ "s", "[what]", "print status (cpu|disks|icu|mem||ppi|pic|rc759|tcu|time)" },
+	{ "s", "[what]", "print status (cpu|disks|icu|mem||ppi|pic|rc759|tcu|term|time)" },
 	{ "t", "[cnt]", "execute cnt instructions [1]" },
 	{ "u", "[addr [cnt [mode]]]", "disassemble" }
 };
@@ -342,6 +342,18 @@ void print_state_fdc (rc759_fdc_t *fdc)
 	}
 }
 
+static
+void print_state_term (terminal_t *trm)
+{
+	if (trm == NULL) {
+		return;
+	}
+
+	pce_prt_sep ("TERMINAL");
+
+	trm_print_info (trm, pce_get_fp_out());
+}
+
 static
 void print_state_video (e82730_t *crt)
 {
@@ -684,6 +696,8 @@ void rc759_cmd_hm (cmd_t *cmd)
 		"emu.parport2.driver  <driver>\n"
 		"emu.parport2.file    <filename>\n"
 		"\n"
+		"emu.term.capture     [<filename>]\n"
+		"emu.term.frame_skip  <max>\n"
 		"emu.term.fullscreen  \"0\" | \"1\"\n"
 		"emu.term.fullscreen.toggle\n"
 		"emu.term.grab\n"
@@ -1128,6 +1142,9 @@ void rc759_cmd_s (cmd_t *cmd, rc759_t *sim)
 		else if (cmd_match (cmd, "tcu")) {
 			print_state_tcu (&sim->tcu);
 		}
+		else if (cmd_match (cmd, "term")) {
+			print_state_term (sim->trm);
+		}
 		else if (cmd_match (cmd, "video")) {
 			print_state_video (&sim->crt);
 		}
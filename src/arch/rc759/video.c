@@ -25,6 +25,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 
 #define E82730_STATUS_VDIP 0x0100
@@ -39,42 +40,43 @@
 #endif
 
 
-static unsigned char e82730_rgb[4 * 16] = {
-	0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0xaa, 0x00,
-	0x00, 0xaa, 0x00, 0x00,
-	0x00, 0xaa, 0xaa, 0x00,
-	0xaa, 0x00, 0x00, 0x00,
-	0xaa, 0x00, 0xaa, 0x00,
-	0xaa, 0xaa, 0x00, 0x00,
-	0xaa, 0xaa, 0xaa, 0x00,
-	0x55, 0x55, 0x55, 0x00,
-	0x55, 0x55, 0xff, 0x00,
-	0x55, 0xff, 0x55, 0x00,
-	0x55, 0xff, 0xff, 0x00,
-	0xff, 0x55, 0x55, 0x00,
-	0xff, 0x55, 0xff, 0x00,
-	0xff, 0xff, 0x55, 0x00,
-	0xff, 0xff, 0xff, 0x00
+/* the colors as 32 bit terminal pixels, see TRM_XRGB() */
+static uint32_t e82730_rgb[16] = {
+	0x000000,
+	0x0000aa,
+	0x00aa00,
+	0x00aaaa,
+	0xaa0000,
+	0xaa00aa,
+	0xaaaa00,
+	0xaaaaaa,
+	0x555555,
+	0x5555ff,
+	0x55ff55,
+	0x55ffff,
+	0xff5555,
+	0xff55ff,
+	0xffff55,
+	0xffffff
 };
 
-static unsigned char e82730_rgb_mono[4 * 16] = {
-	0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00,
-	0xaa, 0xaa, 0xaa, 0x00,
-	0xaa, 0xaa, 0xaa, 0x00,
-	0xaa, 0xaa, 0xaa, 0x00,
-	0xaa, 0xaa, 0xaa, 0x00,
-	0x55, 0x55, 0x55, 0x00,
-	0x55, 0x55, 0x55, 0x00,
-	0x55, 0x55, 0x55, 0x00,
-	0x55, 0x55, 0x55, 0x00,
-	0xff, 0xff, 0xff, 0x00,
-	0xff, 0xff, 0xff, 0x00,
-	0xff, 0xff, 0xff, 0x00,
-	0xff, 0xff, 0xff, 0x00
+static uint32_t e82730_rgb_mono[16] = {
+	0x000000,
+	0x000000,
+	0x000000,
+	0x000000,
+	0xaaaaaa,
+	0xaaaaaa,
+	0xaaaaaa,
+	0xaaaaaa,
+	0x555555,
+	0x555555,
+	0x555555,
+	0x555555,
+	0xffffff,
+	0xffffff,
+	0xffffff,
+	0xffffff
 };
 
 
@@ -182,6 +184,10 @@ void e82730_set_clock (e82730_t *crt, unsigned long mul, unsigned long div)
 void e82730_set_terminal (e82730_t *crt, terminal_t *trm)
 {
 	crt->trm = trm;
+
+	if (crt->trm != NULL) {
+		trm_set_bpp (crt->trm, 4);
+	}
 }
 
 void e82730_set_monochrome (e82730_t *crt, int val)
@@ -361,7 +367,7 @@ void e82730_set_buf_size (e82730_t *crt, unsigned w, unsigned h)
 	unsigned long cnt;
 	unsigned char *buf;
 
-	cnt = 3 * (unsigned long) w * (unsigned long) h;
+	cnt = 4 * (unsigned long) w * (unsigned long) h;
 
 	if (crt->buf_cnt != cnt) {
 		buf = realloc (crt->buf, cnt);
@@ -829,28 +835,20 @@ void e82730_line_empty (e82730_t *crt, e82730_rowbuf_t *rb, unsigned char *p)
 
 	for (i = 0; i < crt->buf_w; i++) {
 		if (((crt->buf_y & 0x0f) < 8) == ((i & 0x0f) < 8)) {
-			*(p++) = 0x80;
-			*(p++) = 0x80;
-			*(p++) = 0x80;
+			*(uint32_t *) p = TRM_XRGB (0x80, 0x80, 0x80);
 		}
 		else {
-			*(p++) = 0x00;
-			*(p++) = 0x00;
-			*(p++) = 0x00;
+			*(uint32_t *) p = TRM_XRGB (0x00, 0x00, 0x00);
 		}
+
+		p += 4;
 	}
 }
 
 static
 void e82730_line_blank (e82730_t *crt, unsigned char *p)
 {
-	unsigned i;
-
-	for (i = 0; i < crt->buf_w; i++) {
-		*(p++) = 0x00;
-		*(p++) = 0x00;
-		*(p++) = 0x00;
-	}
+	memset (p, 0, 4UL * crt->buf_w);
 }
 
 static
@@ -894,7 +892,7 @@ void e82730_line_text (e82730_t *crt, e82730_rowbuf_t *rb, unsigned char *p)
 	int                 curs;
 	unsigned            i;
 	unsigned            idx, val, adr, msk, atr;
-	const unsigned char *fg, *bg;
+	uint32_t            fg, bg;
 
 	idx = 0;
 	val = 0;
@@ -902,8 +900,8 @@ void e82730_line_text (e82730_t *crt, e82730_rowbuf_t *rb, unsigned char *p)
 
 	curs = 0;
 
-	fg = &crt->rgb[4 * 15];
-	bg = &crt->rgb[4 * 0];
+	fg = crt->rgb[15];
+	bg = crt->rgb[0];
 
 	for (i = 0; i < crt->buf_w; i++) {
 		if (msk == 0) {
@@ -911,8 +909,8 @@ void e82730_line_text (e82730_t *crt, e82730_rowbuf_t *rb, unsigned char *p)
 				atr = (rb->buf[idx] >> 10) & 0x1f;
 				atr = crt->palette[atr];
 
-				fg = &crt->rgb[(atr >> 2) & 0x3c];
-				bg = &crt->rgb[(atr << 2) & 0x3c];
+				fg = crt->rgb[(atr >> 4) & 0x0f];
+				bg = crt->rgb[atr & 0x0f];
 
 				adr = rb->buf[idx] & 0x3ff;
 				adr = ((adr << 4) | crt->cur_row_idx) << 1;
@@ -941,7 +939,7 @@ void e82730_line_text (e82730_t *crt, e82730_rowbuf_t *rb, unsigned char *p)
 			}
 
 			if (curs) {
-				const unsigned char *tmp;
+				uint32_t tmp;
 
 				tmp = fg;
 				fg = bg;
@@ -949,16 +947,8 @@ void e82730_line_text (e82730_t *crt, e82730_rowbuf_t *rb, unsigned char *p)
 			}
 		}
 
-		if (val & 0x8000) {
-			*(p++) = fg[0];
-			*(p++) = fg[1];
-			*(p++) = fg[2];
-		}
-		else {
-			*(p++) = bg[0];
-			*(p++) = bg[1];
-			*(p++) = bg[2];
-		}
+		*(uint32_t *) p = (val & 0x8000) ? fg : bg;
+		p += 4;
 
 		val = (val << 1) & 0xffff;
 		msk = (msk << 1) & 0xffff;
@@ -977,7 +967,7 @@ void e82730_line (e82730_t *crt)
 
 	rb = crt->rbp[0];
 
-	p = crt->buf + crt->buf_y * 3UL * crt->buf_w;
+	p = crt->buf + crt->buf_y * 4UL * crt->buf_w;
 
 	if (rb->ready == 0) {
 		e82730_line_empty (crt, rb, p);
@@ -1037,6 +1027,26 @@ void e82730_rowbuf_switch (e82730_t *crt)
 	crt->rbp[1]->fullrowdesc_cnt = 0;
 }
 
+/*
+ * Get the frame duration in microseconds
+ *
+ * This assumes that the input clock divisor is the input clock frequency,
+ * which makes the multiplier the CRT clock frequency.
+ */
+static
+unsigned long e82730_get_frame_us (const e82730_t *crt)
+{
+	unsigned long long clk;
+
+	if (crt->input_clock_mul < 2) {
+		return (0);
+	}
+
+	clk = 1000000ULL * crt->mode_line_length * crt->mode_frame_length;
+
+	return (clk / crt->input_clock_mul);
+}
+
 static
 void e82730_clock_line (e82730_t *crt)
 {
@@ -1112,11 +1122,11 @@ void e82730_clock_line (e82730_t *crt)
 
 	if (crt->cur_line >= crt->mode_frame_length) {
 		while ((crt->buf_y < crt->buf_min_h) && (crt->buf_y < crt->buf_h)) {
-			e82730_line_blank (crt, crt->buf + crt->buf_y * 3UL * crt->buf_w);
+			e82730_line_blank (crt, crt->buf + crt->buf_y * 4UL * crt->buf_w);
 			crt->buf_y += 1;
 		}
 
-		if (crt->trm != NULL) {
+		if ((crt->trm != NULL) && (trm_skip_frame (crt->trm, e82730_get_frame_us (crt)) == 0)) {
 			trm_set_size (crt->trm, crt->buf_w, crt->buf_y);
 			trm_set_lines (crt->trm, crt->buf, 0, crt->buf_y);
 			trm_update (crt->trm);
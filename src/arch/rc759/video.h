@@ -95,7 +95,7 @@ typedef struct {
 	unsigned long   input_clock_mul;
 	unsigned long   input_clock_div;
 
-	unsigned char   *rgb;
+	const uint32_t  *rgb;
 
 	unsigned char   *buf;
 	unsigned long   buf_cnt;
@@ -505,6 +505,7 @@ void v20_cmd_hm (cmd_t *cmd)
 		"emu.cpu.speed        <factor>\n"
 		"emu.cpu.speed.step   <adjustment>\n"
 		"\n"
+		"emu.term.capture     [<filename>]\n"
 		"emu.term.fullscreen  \"0\" | \"1\"\n"
 		"emu.term.fullscreen.toggle\n"
 		"emu.term.grab\n"
@@ -57,7 +57,7 @@ static
 void v20_setup_vic20 (vic20_t *sim, ini_sct_t *ini)
 {
 	unsigned  speed;
-	int       pal, aspeed;
+	int       pal, aspeed, saudio;
 	ini_sct_t *sct;
 
 	sct = ini_next_sct (ini, NULL, "system");
@@ -65,6 +65,7 @@ void v20_setup_vic20 (vic20_t *sim, ini_sct_t *ini)
 	ini_get_uint16 (sct, "speed", &speed, 1);
 	ini_get_bool (sct, "pal", &pal, 0);
 	ini_get_bool (sct, "auto_speed", &aspeed, 1);
+	ini_get_bool (sct, "sync_audio", &saudio, 0);
 
 	sim->pal = (pal != 0);
 	sim->clock = sim->pal ? V20_CLOCK_PAL : V20_CLOCK_NTSC;
@@ -74,12 +75,14 @@ void v20_setup_vic20 (vic20_t *sim, ini_sct_t *ini)
 	sim->speed_auto = (aspeed != 0);
 	sim->speed_tape = 0;
 
+	sim->sync_audio = (saudio != 0);
+
 	sim->framedrop_base = 0;
 	sim->framedrop_tape = 0;
 
 	pce_log_tag (MSG_INF, "VIC20:",
-		"cpu=6502 clock=%lu speed=%u autospeed=%d pal=%d\n",
-		sim->clock, sim->speed, sim->speed_auto, sim->pal
+		"cpu=6502 clock=%lu speed=%u autospeed=%d pal=%d sync-audio=%d\n",
+		sim->clock, sim->speed, sim->speed_auto, sim->pal, sim->sync_audio
 	);
 
 	sim->cpu = e6502_new();
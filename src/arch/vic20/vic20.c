@@ -321,6 +321,36 @@ void v20_clock_resync (vic20_t *sim)
 	pce_get_interval_us (&sim->sync_us);
 }
 
+/*
+ * Synchronize the emulation with the sound output
+ *
+ * This is only done at normal speed, in warp mode the sound output
+ * is too fast anyway.
+ */
+static
+int v20_audio_sync (vic20_t *sim)
+{
+	long us;
+
+	if (sim->speed != 1) {
+		return (1);
+	}
+
+	if (v20_video_get_sound_delay (&sim->video, &us)) {
+		return (1);
+	}
+
+	if (us >= (1000000 / V20_CPU_SYNC)) {
+		pce_usleep (us);
+	}
+
+	/* resume real time synchronization from here if the sound stops */
+	sim->sync_sleep = 0;
+	pce_get_interval_us (&sim->sync_us);
+
+	return (0);
+}
+
 static
 void v20_clock_sync (vic20_t *sim, unsigned long n)
 {
@@ -341,6 +371,12 @@ void v20_clock_sync (vic20_t *sim, unsigned long n)
 
 	sim->sync_clk -= fct;
 
+	if (sim->sync_audio) {
+		if (v20_audio_sync (sim) == 0) {
+			return;
+		}
+	}
+
 	us1 = pce_get_interval_us (&sim->sync_us);
 	us2 = (1000000 / V20_CPU_SYNC);
 
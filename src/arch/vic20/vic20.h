@@ -89,6 +89,9 @@ typedef struct vic20_s {
 	unsigned long sync_us;
 	long          sync_sleep;
 
+	/* pace the emulation by the sound output */
+	char          sync_audio;
+
 	unsigned      clk_div;
 } vic20_t;
 
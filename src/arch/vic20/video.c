@@ -65,11 +65,10 @@ void v20_video_update_palette (vic20_video_t *vid)
 	unsigned      v;
 	double        ts[4], td[3];
 	double        ch, sh;
+	unsigned char rgb[3];
 	double        *s;
-	unsigned char *d;
 
 	s = vic_pal_ypbpr;
-	d = vid->palette;
 
 	sh = sin (vid->hue * (M_PI / 180.0));
 	ch = cos (vid->hue * (M_PI / 180.0));
@@ -98,8 +97,10 @@ void v20_video_update_palette (vic20_video_t *vid)
 				v = (unsigned) (256.0 * td[j]);
 			}
 
-			*(d++) = v;
+			rgb[j] = v;
 		}
+
+		vid->palette[i] = TRM_XRGB (rgb[0], rgb[1], rgb[2]);
 	}
 
 	vid->update_palette = 0;
@@ -108,9 +109,8 @@ void v20_video_update_palette (vic20_video_t *vid)
 static
 void v20_video_hsync (vic20_video_t *vid, unsigned y, unsigned w, const unsigned char *buf)
 {
-	unsigned            i;
-	unsigned char       *p;
-	const unsigned char *s;
+	unsigned i;
+	uint32_t *p;
 
 	if (vid->framedrop > 0) {
 		return;
@@ -135,14 +135,10 @@ void v20_video_hsync (vic20_video_t *vid, unsigned y, unsigned w, const unsigned
 		v20_video_update_palette (vid);
 	}
 
-	p = vid->buf + (3 * vid->w * (y - vid->y));
+	p = vid->buf + (vid->w * (y - vid->y));
 
 	for (i = 0; i < w; i++) {
-		s = vid->palette + 3 * (buf[i] & 0x0f);
-
-		*(p++) = *(s++);
-		*(p++) = *(s++);
-		*(p++) = *(s++);
+		p[i] = vid->palette[buf[i] & 0x0f];
 	}
 }
 
@@ -208,7 +204,7 @@ void v20_video_init (vic20_video_t *vid)
 		vid->colram[i] = 0;
 	}
 
-	for (i = 0; i < (3 * VIC20_VIDEO_BUF); i++) {
+	for (i = 0; i < VIC20_VIDEO_BUF; i++) {
 		vid->buf[i] = 0;
 	}
 
@@ -291,6 +287,7 @@ void v20_video_set_term (vic20_video_t *vid, terminal_t *trm)
 	vid->trm = trm;
 
 	if (trm != NULL) {
+		trm_set_bpp (trm, 4);
 		trm_open (trm, vid->w, vid->h);
 		trm_set_aspect_ratio (trm, 4, 3);
 	}
@@ -322,6 +319,15 @@ int v20_video_set_sound_driver (vic20_video_t *vid, const char *drv)
 	return (0);
 }
 
+int v20_video_get_sound_delay (vic20_video_t *vid, long *us)
+{
+	if (vid->snd == NULL) {
+		return (1);
+	}
+
+	return (snd_get_delay (vid->snd, vid->vic.snd_buf_cnt, us));
+}
+
 void v20_video_set_memmap (vic20_video_t *vid, memory_t *mem)
 {
 	e6560_set_memmap (&vid->vic, 0x00, 64, NULL);
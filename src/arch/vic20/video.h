@@ -64,11 +64,12 @@ typedef struct {
 	unsigned long clock;
 	unsigned long srate;
 
-	unsigned char palette[16 * 3];
+	/* the colors as 32 bit terminal pixels, see TRM_XRGB() */
+	uint32_t      palette[16];
 
 	unsigned char colram[1024];
 
-	unsigned char buf[3 * VIC20_VIDEO_BUF];
+	uint32_t      buf[VIC20_VIDEO_BUF];
 } vic20_video_t;
 
 
@@ -84,6 +85,8 @@ void v20_video_set_term (vic20_video_t *vid, terminal_t *trm);
 
 int v20_video_set_sound_driver (vic20_video_t *vid, const char *drv);
 
+int v20_video_get_sound_delay (vic20_video_t *vid, long *us);
+
 void v20_video_set_memmap (vic20_video_t *vid, memory_t *mem);
 
 void v20_video_set_hue (vic20_video_t *vid, double val);
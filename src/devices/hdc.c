@@ -500,6 +500,7 @@ void hdc_cmd_fmttrk (hdc_t *hdc)
 /* Command 08: read */
 
 static void hdc_cmd_read_next (hdc_t *hdc);
+static void hdc_cmd_read_done (void *ext, dsk_aio_t *aio);
 
 static
 void hdc_cmd_read_error (hdc_t *hdc, unsigned code)
@@ -529,6 +530,7 @@ static
 void hdc_cmd_read_next (hdc_t *hdc)
 {
 	unsigned d, c, h, s;
+	uint32_t lba;
 	disk_t   *dsk;
 
 	d = hdc->id.d & 1;
@@ -549,7 +551,28 @@ void hdc_cmd_read_next (hdc_t *hdc)
 	);
 #endif
 
-	if (dsk_read_chs (dsk, hdc->buf, c, h, s + 1, 1)) {
+	if (dsk_get_lba (dsk, c, h, s + 1, &lba)) {
+		hdc_cmd_read_error (hdc, 0x12);
+		return;
+	}
+
+	hdc->delay = 0;
+	hdc->cont = NULL;
+
+	dsk_aio_read (&hdc->aio, dsk, hdc->buf, lba, 1, hdc_cmd_read_done, hdc);
+}
+
+/*
+ * The sector has been read, possibly by the disk thread
+ */
+static
+void hdc_cmd_read_done (void *ext, dsk_aio_t *aio)
+{
+	hdc_t *hdc;
+
+	hdc = ext;
+
+	if (aio->result) {
 		hdc_cmd_read_error (hdc, 0x12);
 		return;
 	}
@@ -595,6 +618,7 @@ void hdc_cmd_read (hdc_t *hdc)
 /* Command 0A: write */
 
 static void hdc_cmd_write_next (hdc_t *hdc);
+static void hdc_cmd_write_done (void *ext, dsk_aio_t *aio);
 
 static
 void hdc_cmd_write_error (hdc_t *hdc, unsigned code)
@@ -622,6 +646,7 @@ static
 void hdc_cmd_write_next (hdc_t *hdc)
 {
 	unsigned d, c, h, s;
+	uint32_t lba;
 	disk_t   *dsk;
 
 	d = hdc->id.d & 1;
@@ -642,7 +667,28 @@ void hdc_cmd_write_next (hdc_t *hdc)
 	);
 #endif
 
-	if (dsk_write_chs (dsk, hdc->buf, c, h, s + 1, 1)) {
+	if (dsk_get_lba (dsk, c, h, s + 1, &lba)) {
+		hdc_cmd_write_error (hdc, 0x12);
+		return;
+	}
+
+	hdc->delay = 0;
+	hdc->cont = NULL;
+
+	dsk_aio_write (&hdc->aio, dsk, hdc->buf, lba, 1, hdc_cmd_write_done, hdc);
+}
+
+/*
+ * The sector has been written, possibly by the disk thread
+ */
+static
+void hdc_cmd_write_done (void *ext, dsk_aio_t *aio)
+{
+	hdc_t *hdc;
+
+	hdc = ext;
+
+	if (aio->result) {
 		hdc_cmd_write_error (hdc, 0x12);
 		return;
 	}
@@ -1546,6 +1592,8 @@ hdc_t *hdc_new (unsigned long addr)
 
 	hdc->dsks = NULL;
 
+	dsk_aio_init (&hdc->aio);
+
 	hdc->delay = 0;
 
 	hdc->cont = NULL;
@@ -1564,6 +1612,7 @@ hdc_t *hdc_new (unsigned long addr)
 void hdc_del (hdc_t *hdc)
 {
 	if (hdc != NULL) {
+		dsk_aio_cancel (&hdc->aio);
 		mem_blk_free (&hdc->blk);
 		free (hdc);
 	}
@@ -1645,6 +1694,8 @@ void hdc_reset (hdc_t *hdc)
 	fprintf (stderr, "HDC: reset\n");
 #endif
 
+	dsk_aio_cancel (&hdc->aio);
+
 	hdc->status = 0;
 	hdc->mask = 0;
 
@@ -1675,6 +1726,8 @@ void hdc_reset (hdc_t *hdc)
 
 void hdc_clock (hdc_t *hdc, unsigned long cnt)
 {
+	dsk_aio_check (&hdc->aio);
+
 	if (hdc->delay == 0) {
 		return;
 	}
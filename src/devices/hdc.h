@@ -28,6 +28,7 @@
 #include <devices/memory.h>
 
 #include <drivers/block/block.h>
+#include <drivers/block/blkaio.h>
 
 
 typedef struct {
@@ -74,6 +75,9 @@ typedef struct hdc_t {
 
 	disks_t        *dsks;
 
+	/* the current sector read or write request */
+	dsk_aio_t      aio;
+
 	unsigned long  delay;
 
 	void           (*cont) (struct hdc_t *hdc);
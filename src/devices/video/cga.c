@@ -69,6 +69,9 @@
 #define CGA_COMPOSITE_AUTO  1
 #define CGA_COMPOSITE_FORCE 2
 
+/* the number of composite sample windows (9 samples, 2 bits each) */
+#define CGA_COMP_WIN (1UL << 18)
+
 
 static void cga_del (cga_t *cga);
 
@@ -93,6 +96,7 @@ unsigned char cga_rgb[16][3] = {
 	{ 0xff, 0xff, 0xff }
 };
 
+
 static char cga_color_burst[8][8] = {
 	{ 0, 0, 0, 0, 0, 0, 0, 0 },
 	{ 0, 0, 0, 1, 1, 1, 1, 0 },
@@ -105,6 +109,15 @@ static char cga_color_burst[8][8] = {
 };
 
 
+/*
+ * Get a color as a 32 bit terminal pixel
+ */
+static
+uint32_t cga_get_xrgb (unsigned idx)
+{
+	return (TRM_XRGB (cga_rgb[idx][0], cga_rgb[idx][1], cga_rgb[idx][2]));
+}
+
 static
 void cga_set_composite (cga_t *cga, unsigned mode)
 {
@@ -128,6 +141,7 @@ void cga_set_hue (cga_t *cga, int val)
 	}
 
 	cga->comp_tab_ok = 0;
+	cga->comp_lut_ok = 0;
 	cga->mod_cnt = 2;
 }
 
@@ -136,6 +150,7 @@ void cga_set_saturation (cga_t *cga, int val)
 {
 	cga->saturation = (double) val / 100.0;
 	cga->comp_tab_ok = 0;
+	cga->comp_lut_ok = 0;
 	cga->mod_cnt = 2;
 }
 
@@ -144,6 +159,7 @@ void cga_set_brightness (cga_t *cga, int val)
 {
 	cga->brightness = (double) val / 100.0;
 	cga->comp_tab_ok = 0;
+	cga->comp_lut_ok = 0;
 	cga->mod_cnt = 2;
 }
 
@@ -166,51 +182,43 @@ unsigned char *cga_get_rgbi_buf (cga_t *cga, unsigned w)
 	return (tmp);
 }
 
+/*
+ * Compute one output pixel of the composite decoder
+ *
+ * win holds the last 9 composite samples (two per pixel), 2 bits each
+ * (bit 0 is luma, bit 1 is chroma) with the newest sample in bits 0-1.
+ * phase is the pixel position modulo 4.
+ */
 static
-void cga_line_composite (cga_t *cga, unsigned char *dst, const unsigned char *src, unsigned w)
+uint32_t cga_comp_pixel (const cga_t *cga, unsigned long win, unsigned phase)
 {
-	unsigned i, j, x, rgbi;
-	unsigned r, g, b;
-	double   Ys[8], Is[8], Qs[8];
+	unsigned h, i, j, k, smp;
 	double   R, G, B, Y, I, Q;
-	double   luma, chroma, composite;
-
-	rgbi = 0;
-	luma = 0.0;
+	double   composite;
 
 	R = 0.0;
 	G = 0.0;
 	B = 0.0;
 
-	for (j = 0; j < 8; j++) {
-		Ys[j] = 0.0;
-		Is[j] = 0.0;
-		Qs[j] = 0.0;
-	}
-
-	for (x = 0; x < (2 * w); x++) {
-		if ((x & 1) == 0) {
-			rgbi = *(src++);
-			luma = (rgbi & 8) ? 0.333 : 0.000;
-		}
+	for (h = 0; h < 2; h++) {
+		i = (2 * phase + h) & 7;
 
-		i = x & 7;
+		Y = 0.0;
+		I = 0.0;
+		Q = 0.0;
 
-		chroma = cga_color_burst[rgbi & 7][i] ? 0.666 : 0.000;
-		composite = luma + chroma;
+		/* the current sample first, then the 7 previous ones, oldest first */
+		for (j = 0; j < 8; j++) {
+			k = (j == 0) ? 0 : (8 - j);
 
-		Ys[i] = composite;
-		Is[i] = composite * cga->sin_cos_tab[i + 8];
-		Qs[i] = composite * cga->sin_cos_tab[i];
+			smp = (win >> (2 * (k + 1 - h))) & 3;
 
-		Y = Ys[i];
-		I = Is[i];
-		Q = Qs[i];
+			composite = (smp & 1) ? 0.333 : 0.000;
+			composite += (smp & 2) ? 0.666 : 0.000;
 
-		for (j = 1; j < 8; j++) {
-			Y += Ys[(i + j) & 7];
-			I += Is[(i + j) & 7];
-			Q += Qs[(i + j) & 7];
+			Y += composite;
+			I += composite * cga->sin_cos_tab[((i - k) & 7) + 8];
+			Q += composite * cga->sin_cos_tab[(i - k) & 7];
 		}
 
 		if (Y > 8*1.0000) Y = 8*1.0000; else if (Y < 0.0) Y = 0.0;
@@ -224,22 +232,79 @@ void cga_line_composite (cga_t *cga, unsigned char *dst, const unsigned char *sr
 		R += Y + 0.9562948323208939905 * I + 0.6210251254447287141 * Q;
 		G += Y - 0.2721214740839773195 * I - 0.6473809535176157223 * Q;
 		B += Y - 1.1069899085671282160 * I + 1.7046149754988293290 * Q;
+	}
+
+	return (TRM_XRGB (
+		(R <= 0.0) ? 0 : ((R >= 16.0) ? 255 : (unsigned) (16.0 * R)),
+		(G <= 0.0) ? 0 : ((G >= 16.0) ? 255 : (unsigned) (16.0 * G)),
+		(B <= 0.0) ? 0 : ((B >= 16.0) ? 255 : (unsigned) (16.0 * B))
+	));
+}
+
+/*
+ * Create the composite decoder lookup table
+ *
+ * The table is indexed by the pixel phase and the 9 sample window.
+ */
+static
+void cga_make_comp_lut (cga_t *cga)
+{
+	unsigned      phase;
+	unsigned long win;
+	uint32_t      *dst;
+
+	if (cga->comp_lut == NULL) {
+		cga->comp_lut = malloc (4UL * 4UL * CGA_COMP_WIN);
+
+		if (cga->comp_lut == NULL) {
+			return;
+		}
+	}
+
+	dst = cga->comp_lut;
+
+	for (phase = 0; phase < 4; phase++) {
+		for (win = 0; win < CGA_COMP_WIN; win++) {
+			*(dst++) = cga_comp_pixel (cga, win, phase);
+		}
+	}
+
+	cga->comp_lut_ok = 1;
+}
+
+static
+void cga_line_composite (cga_t *cga, unsigned char *dst, const unsigned char *src, unsigned w)
+{
+	unsigned       x, rgbi, phase, smp;
+	unsigned long  win;
+	const uint32_t *lut;
+
+	if (cga->comp_lut_ok == 0) {
+		cga_make_comp_lut (cga);
+	}
 
-		if (x & 1) {
-			if (R <= 0.0) r = 0; else if (R >= 16.0) r = 255; else r = 16.0 * R;
-			if (G <= 0.0) g = 0; else if (G >= 16.0) g = 255; else g = 16.0 * G;
-			if (B <= 0.0) b = 0; else if (B >= 16.0) b = 255; else b = 16.0 * B;
+	lut = cga->comp_lut_ok ? cga->comp_lut : NULL;
 
-			dst[0] = r;
-			dst[1] = g;
-			dst[2] = b;
+	win = 0;
 
-			dst += 3;
+	for (x = 0; x < w; x++) {
+		rgbi = src[x];
+		phase = x & 3;
 
-			R = 0.0;
-			G = 0.0;
-			B = 0.0;
+		smp = (rgbi & 8) ? 0x05 : 0x00;
+		smp |= cga_color_burst[rgbi & 7][2 * phase] ? 0x08 : 0x00;
+		smp |= cga_color_burst[rgbi & 7][2 * phase + 1] ? 0x02 : 0x00;
+
+		win = ((win << 4) | smp) & (CGA_COMP_WIN - 1);
+
+		if (lut != NULL) {
+			*(uint32_t *) dst = lut[(unsigned long) phase * CGA_COMP_WIN + win];
+		}
+		else {
+			*(uint32_t *) dst = cga_comp_pixel (cga, win, phase);
 		}
+
+		dst += 4;
 	}
 }
 
@@ -257,10 +322,9 @@ void cga_make_comp_tab (cga_t *cga)
 	double              hue, sat, lum;
 	double              hv, sh, ch;
 	const unsigned char *src;
-	unsigned char       *dst;
 
 	if (cga->comp_tab == NULL) {
-		cga->comp_tab = malloc (5 * 16 * 3);
+		cga->comp_tab = malloc (5 * 16 * sizeof (uint32_t));
 	}
 
 	hue = cga->hue;
@@ -302,11 +366,11 @@ void cga_make_comp_tab (cga_t *cga)
 			g = (g < 0.0) ? 0.0 : ((g > 1.0) ? 1.0 : g);
 			b = (b < 0.0) ? 0.0 : ((b > 1.0) ? 1.0 : b);
 
-			dst = cga->comp_tab + 3 * (16 * j + i);
-
-			dst[0] = (unsigned char) (src[0] * r);
-			dst[1] = (unsigned char) (src[1] * g);
-			dst[2] = (unsigned char) (src[2] * b);
+			cga->comp_tab[16 * j + i] = TRM_XRGB (
+				(unsigned char) (src[0] * r),
+				(unsigned char) (src[1] * g),
+				(unsigned char) (src[2] * b)
+			);
 		}
 	}
 
@@ -320,7 +384,30 @@ void cga_line_blank (cga_t *cga, unsigned row)
 
 	ptr = pce_video_get_row_ptr (&cga->video, row);
 
-	memset (ptr, 0, 3 * cga->video.buf_w);
+	memset (ptr, 0, 4 * cga->video.buf_w);
+}
+
+/*
+ * Get a text mode character from the glyph cache
+ */
+static
+const unsigned char *cga_get_glyph (cga_t *cga, unsigned char code, unsigned char attr)
+{
+	unsigned      i;
+	int           new;
+	unsigned char *glyph;
+
+	glyph = glc_get (&cga->glyph, code | (attr << 8), &new);
+
+	if ((glyph != NULL) && new) {
+		for (i = 0; i < 8; i++) {
+			glc_set_row (&cga->glyph, glyph + 32 * i, cga->font[8 * code + i],
+				cga_rgb[attr & 15], cga_rgb[(attr >> 4) & 15]
+			);
+		}
+	}
+
+	return (glyph);
 }
 
 /*
@@ -335,12 +422,15 @@ void cga_line_mode0 (cga_t *cga, unsigned row)
 	unsigned char       code, attr;
 	unsigned char       val, mask, cmask;
 	unsigned char       *ptr;
-	const unsigned char *reg, *col, *fg, *bg;
+	uint32_t            fg, bg;
+	const unsigned char *reg, *glyph;
 	e6845_t             *crt;
 
 	reg = cga->reg;
 	crt = &cga->crtc;
 
+	glc_set_size (&cga->glyph, 8, 8);
+
 	hd = e6845_get_hd (crt);
 
 	cga->video.buf_next_w = 8 * hd;
@@ -374,8 +464,21 @@ void cga_line_mode0 (cga_t *cga, unsigned row)
 			attr &= 0x7f;
 		}
 
-		fg = cga_rgb[attr & 15];
-		bg = cga_rgb[(attr >> 4) & 15];
+		if ((crt->ra < 8) && ((addr & amask) != caddr)) {
+			glyph = cga_get_glyph (cga, code, attr);
+
+			if (glyph != NULL) {
+				memcpy (ptr, glyph + 32 * crt->ra, 32);
+
+				ptr += 32;
+				addr += 1;
+
+				continue;
+			}
+		}
+
+		fg = cga_get_xrgb (attr & 15);
+		bg = cga_get_xrgb ((attr >> 4) & 15);
 
 		val = cga->font[8 * code + crt->ra];
 
@@ -386,12 +489,9 @@ void cga_line_mode0 (cga_t *cga, unsigned row)
 		mask = 0x80;
 
 		for (j = 0; j < 8; j++) {
-			col = (val & mask) ? fg : bg;
-
-			*(ptr++) = col[0];
-			*(ptr++) = col[1];
-			*(ptr++) = col[2];
+			*(uint32_t *) ptr = (val & mask) ? fg : bg;
 
+			ptr += 4;
 			mask >>= 1;
 		}
 
@@ -405,10 +505,10 @@ void cga_line_mode0 (cga_t *cga, unsigned row)
 static
 void cga_line_mode1 (cga_t *cga, unsigned row)
 {
-	unsigned            i, j;
-	unsigned            hd, addr, val;
-	unsigned char       *ptr;
-	const unsigned char *col;
+	unsigned      i, j;
+	unsigned      hd, addr, val;
+	unsigned char *ptr;
+	uint32_t      pal[4];
 
 	hd = e6845_get_hd (&cga->crtc);
 
@@ -421,17 +521,18 @@ void cga_line_mode1 (cga_t *cga, unsigned row)
 	ptr = pce_video_get_row_ptr (&cga->video, row);
 	addr = (cga->crtc.ma ^ ((cga->crtc.ra & 1) << 12)) << 1;
 
+	for (i = 0; i < 4; i++) {
+		pal[i] = cga_get_xrgb (cga->pal[i]);
+	}
+
 	for (i = 0; i < hd; i++) {
 		val = cga->mem[addr & 0x3fff];
 		val = (val << 8) | cga->mem[(addr + 1) & 0x3fff];
 
 		for (j = 0; j < 8; j++) {
-			col = cga_rgb[cga->pal[(val >> 14) & 3]];
-
-			*(ptr++) = col[0];
-			*(ptr++) = col[1];
-			*(ptr++) = col[2];
+			*(uint32_t *) ptr = pal[(val >> 14) & 3];
 
+			ptr += 4;
 			val <<= 2;
 		}
 
@@ -489,10 +590,9 @@ void cga_line_mode1c (cga_t *cga, unsigned row)
 static
 void cga_line_mode2 (cga_t *cga, unsigned row)
 {
-	unsigned            i, j;
-	unsigned            hd, addr, val;
+	unsigned            i;
+	unsigned            hd, addr;
 	unsigned char       *ptr;
-	const unsigned char *fg, *bg, *col;
 
 	hd = e6845_get_hd (&cga->crtc);
 
@@ -505,23 +605,12 @@ void cga_line_mode2 (cga_t *cga, unsigned row)
 	ptr = pce_video_get_row_ptr (&cga->video, row);
 	addr = (cga->crtc.ma ^ ((cga->crtc.ra & 1) << 12)) << 1;
 
-	fg = cga_rgb[cga->reg[CGA_CSEL] & 15];
-	bg = cga_rgb[0];
+	mono_tab_set_color (&cga->mono, cga_rgb[0], cga_rgb[cga->reg[CGA_CSEL] & 15]);
 
 	for (i = 0; i < hd; i++) {
-		val = cga->mem[addr & 0x3fff];
-		val = (val << 8) | cga->mem[(addr + 1) & 0x3fff];
-
-		for (j = 0; j < 16; j++) {
-			col = (val & 0x8000) ? fg : bg;
-
-			*(ptr++) = col[0];
-			*(ptr++) = col[1];
-			*(ptr++) = col[2];
-
-			val <<= 1;
-		}
+		mono_tab_expand (&cga->mono, ptr, cga->mem + (addr & 0x3fff), 2);
 
+		ptr += 64;
 		addr += 2;
 	}
 }
@@ -575,11 +664,10 @@ void cga_line_mode2c (cga_t *cga, unsigned row)
 static
 void cga_line_mode2c_auto (cga_t *cga, unsigned row)
 {
-	unsigned            i;
-	unsigned            hd, addr, val;
-	unsigned            avgmsk, avgval, pat;
-	unsigned char       *ptr;
-	const unsigned char *col;
+	unsigned      i;
+	unsigned      hd, addr, val;
+	unsigned      avgmsk, avgval, pat;
+	unsigned char *ptr;
 
 	if (cga->comp_tab_ok == 0) {
 		cga_make_comp_tab (cga);
@@ -626,11 +714,9 @@ void cga_line_mode2c_auto (cga_t *cga, unsigned row)
 			avgval += 1;
 		}
 
-		col = cga->comp_tab + 3 * (16 * avgval + (pat & 0x0f));
+		*(uint32_t *) ptr = cga->comp_tab[16 * avgval + (pat & 0x0f)];
 
-		*(ptr++) = col[0];
-		*(ptr++) = col[1];
-		*(ptr++) = col[2];
+		ptr += 4;
 
 		val <<= 1;
 	}
@@ -689,24 +775,52 @@ void cga_hsync (cga_t *cga)
 	}
 }
 
+/*
+ * Get the frame duration in microseconds
+ */
+static
+unsigned long cga_get_frame_us (cga_t *cga)
+{
+	unsigned long cfreq, clk;
+
+	if (cga->reg[CGA_MODE] & CGA_MODE_CS) {
+		cfreq = CGA_CFREQ1;
+	}
+	else {
+		cfreq = CGA_CFREQ2;
+	}
+
+	clk = (unsigned long) (e6845_get_ht (&cga->crtc) + 1) * e6845_get_vtl (&cga->crtc);
+
+	return ((1000000ULL * clk) / cfreq);
+}
+
 static
 void cga_vsync (cga_t *cga)
 {
+	int     skip;
 	video_t *vid;
 
 	vid = &cga->video;
 
-	if ((cga->term != NULL) && (vid->buf_w > 0) && (vid->buf_h > 0)) {
-		trm_set_size (cga->term, vid->buf_w, vid->buf_h);
+	skip = 0;
 
-		if (cga->mod_cnt > 0) {
-			trm_set_lines (cga->term, vid->buf, 0, vid->buf_h);
+	if ((cga->term != NULL) && (vid->buf_w > 0) && (vid->buf_h > 0)) {
+		if (trm_skip_frame (cga->term, cga_get_frame_us (cga))) {
+			skip = 1;
 		}
+		else {
+			trm_set_size (cga->term, vid->buf_w, vid->buf_h);
 
-		trm_update (cga->term);
+			if (cga->mod_cnt > 0) {
+				trm_set_lines (cga->term, vid->buf, 0, vid->buf_h);
+			}
+
+			trm_update (cga->term);
+		}
 	}
 
-	if (cga->mod_cnt > 0) {
+	if ((skip == 0) && (cga->mod_cnt > 0)) {
 		cga->mod_cnt -= 1;
 	}
 
@@ -721,7 +835,7 @@ void cga_vsync (cga_t *cga)
 	}
 
 	if ((vid->buf_w != vid->buf_next_w) || (vid->buf_h != vid->buf_next_h)) {
-		pce_video_set_buf_size (vid, vid->buf_next_w, vid->buf_next_h, 3);
+		pce_video_set_buf_size (vid, vid->buf_next_w, vid->buf_next_h, 4);
 		cga->mod_cnt = 1;
 	}
 
@@ -775,6 +889,8 @@ void cga_set_font (cga_t *cga, unsigned font)
 		cga->font = cga_font_thin;
 	}
 
+	glc_invalidate (&cga->glyph);
+
 	cga->mod_cnt = 2;
 }
 
@@ -1168,6 +1284,7 @@ void cga_set_terminal (cga_t *cga, terminal_t *trm)
 	cga->term = trm;
 
 	if (cga->term != NULL) {
+		trm_set_bpp (cga->term, 4);
 		trm_open (cga->term, 640, 200);
 	}
 }
@@ -1219,6 +1336,11 @@ void cga_init (cga_t *cga, unsigned long io, unsigned long addr)
 	cga->term = NULL;
 	cga->font = cga_font_thick;
 	cga->clock = 0;
+
+	glc_init (&cga->glyph, 4096);
+	glc_set_bpp (&cga->glyph, 4);
+	mono_tab_init (&cga->mono, cga_rgb[0], cga_rgb[15]);
+
 	cga->mod_cnt = 0;
 
 	cga->rgbi_max = 0;
@@ -1236,6 +1358,8 @@ void cga_init (cga_t *cga, unsigned long io, unsigned long addr)
 	cga->composite = CGA_COMPOSITE_AUTO;
 	cga->comp_tab_ok = 0;
 	cga->comp_tab = NULL;
+	cga->comp_lut_ok = 0;
+	cga->comp_lut = NULL;
 	cga->hue = 0.0;
 	cga->saturation = 2.0 / 3.0;
 	cga->brightness = 1.0;
@@ -1249,6 +1373,10 @@ void cga_free (cga_t *cga)
 	e6845_free (&cga->crtc);
 
 	free (cga->rgbi_buf);
+	free (cga->comp_tab);
+	free (cga->comp_lut);
+
+	glc_free (&cga->glyph);
 
 	mem_blk_del (cga->memblk);
 	mem_blk_del (cga->regblk);
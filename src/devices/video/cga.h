@@ -26,7 +26,9 @@
 
 #include <chipset/e6845.h>
 #include <devices/memory.h>
+#include <devices/video/glyph.h>
 #include <devices/video/video.h>
+#include <drivers/video/mono.h>
 #include <drivers/video/terminal.h>
 #include <libini/libini.h>
 
@@ -44,6 +46,8 @@ typedef struct {
 	terminal_t          *term;
 
 	const unsigned char *font;
+	glyph_cache_t       glyph;
+	mono_tab_t          mono;
 
 	unsigned long       clock;
 
@@ -60,9 +64,12 @@ typedef struct {
 
 	unsigned char       composite;
 	char                comp_tab_ok;
-	unsigned char       *comp_tab;
+	uint32_t            *comp_tab;
 	double              sin_cos_tab[16];
 
+	char                comp_lut_ok;
+	uint32_t            *comp_lut;
+
 	double              hue;
 	double              saturation;
 	double              brightness;
@@ -22,6 +22,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <lib/log.h>
 #include <lib/msg.h>
@@ -155,6 +156,19 @@
 
 #define EGA_UPDATE_DIRTY   1
 #define EGA_UPDATE_RETRACE 2
+#define EGA_UPDATE_MEM     4
+
+/* log2 of the number of video memory bytes per dirty flag */
+#define EGA_DIRTY_SHIFT 4
+
+
+/* expand a 4 bit plane mask into a mask for a video memory word */
+static const uint32_t ega_plane_msk[16] = {
+	0x00000000, 0x000000ff, 0x0000ff00, 0x0000ffff,
+	0x00ff0000, 0x00ff00ff, 0x00ffff00, 0x00ffffff,
+	0xff000000, 0xff0000ff, 0xff00ff00, 0xff00ffff,
+	0xffff0000, 0xffff00ff, 0xffffff00, 0xffffffff
+};
 
 
 static void ega_clock (ega_t *ega, unsigned long cnt);
@@ -203,6 +217,8 @@ void ega_set_switches (ega_t *ega, unsigned val)
 	ega->switches = val;
 
 	ega->monitor = mon[val & 0x0f];
+
+	glc_invalidate (&ega->glyph);
 }
 
 /*
@@ -366,6 +382,19 @@ void ega_get_palette (ega_t *ega, unsigned idx,
 	}
 }
 
+/*
+ * Get a palette entry as a 32 bit terminal pixel
+ */
+static
+uint32_t ega_get_xrgb (ega_t *ega, unsigned idx)
+{
+	unsigned char r, g, b;
+
+	ega_get_palette (ega, idx, &r, &g, &b);
+
+	return (TRM_XRGB (r, g, b));
+}
+
 /*
  * Get a transformed CRTC address
  */
@@ -449,14 +478,38 @@ unsigned long ega_get_dotclock (ega_t *ega)
 	return (clk);
 }
 
+/*
+ * Get the frame duration in microseconds
+ */
+static
+unsigned long ega_get_frame_us (ega_t *ega)
+{
+	unsigned long long clk;
+
+	clk = 1000000ULL * ega->clk_vt;
+
+	if (ega->reg_seq[EGA_SEQ_CLOCK] & EGA_SEQ_CLOCK_DC) {
+		clk *= 2;
+	}
+
+	if (ega->reg[EGA_MOUT] & EGA_MOUT_CS) {
+		clk /= EGA_PFREQ1;
+	}
+	else {
+		clk /= EGA_PFREQ0;
+	}
+
+	return (clk);
+}
+
 /*
  * Get a pointer to the bitmap for a character
  */
 static
-const unsigned char *ega_get_font (ega_t *ega, unsigned chr, unsigned atr)
+const uint32_t *ega_get_font (ega_t *ega, unsigned chr, unsigned atr)
 {
-	const unsigned char *fnt;
-	unsigned            ofs;
+	const uint32_t *fnt;
+	unsigned       ofs;
 
 	ofs = ega->reg_seq[EGA_SEQ_CMAPSEL];
 
@@ -467,7 +520,8 @@ const unsigned char *ega_get_font (ega_t *ega, unsigned chr, unsigned atr)
 		ofs = ofs & 0x03;
 	}
 
-	fnt = ega->mem + 0x20000 + (16384 * ofs) + (32 * (chr & 0xff));
+	/* the font is in plane 2 */
+	fnt = ega->vram + (16384 * ofs) + (32 * (chr & 0xff));
 
 	return (fnt);
 }
@@ -481,7 +535,7 @@ int ega_set_buf_size (ega_t *ega, unsigned w, unsigned h)
 	unsigned long cnt;
 	unsigned char *tmp;
 
-	cnt = 3UL * (unsigned long) w * (unsigned long) h;
+	cnt = 4UL * (unsigned long) w * (unsigned long) h;
 
 	if (cnt > ega->bufmax) {
 		tmp = realloc (ega->buf, cnt);
@@ -493,12 +547,85 @@ int ega_set_buf_size (ega_t *ega, unsigned w, unsigned h)
 		ega->bufmax = cnt;
 	}
 
+	if (h > ega->linemax) {
+		tmp = realloc (ega->line_dirty, h);
+		if (tmp == NULL) {
+			return (1);
+		}
+
+		ega->line_dirty = tmp;
+		ega->linemax = h;
+	}
+
 	ega->buf_w = w;
 	ega->buf_h = h;
 
 	return (0);
 }
 
+/*
+ * Check if any of cnt consecutive CRTC addresses starting at addr
+ * refers to video memory that was modified since the last update
+ */
+static
+int ega_get_cells_dirty (ega_t *ega, unsigned addr, unsigned cnt, unsigned row)
+{
+	unsigned p;
+
+	while (cnt > 0) {
+		p = ega_get_crtc_addr (ega, addr, row);
+
+		if (ega->mem_dirty[p >> EGA_DIRTY_SHIFT]) {
+			return (1);
+		}
+
+		addr = (addr + 1) & 0xffff;
+		cnt -= 1;
+	}
+
+	return (0);
+}
+
+/*
+ * Get the number of character clocks that are fetched after the first
+ * one in a graphics mode scanline
+ */
+static
+unsigned ega_get_line_fetch (unsigned hpp, unsigned w, unsigned cw)
+{
+	if (hpp >= cw) {
+		return (1 + (w - 1) / cw);
+	}
+
+	return ((hpp + w - 1) / cw);
+}
+
+/*
+ * Send the modified lines of the internal buffer to the terminal
+ */
+static
+void ega_set_lines (ega_t *ega)
+{
+	unsigned y, y0;
+
+	y = 0;
+
+	while (y < ega->buf_h) {
+		if (ega->line_dirty[y] == 0) {
+			y += 1;
+			continue;
+		}
+
+		y0 = y;
+
+		while ((y < ega->buf_h) && ega->line_dirty[y]) {
+			y += 1;
+		}
+
+		trm_set_lines (ega->term, ega->buf + 4UL * y0 * ega->buf_w, y0, y - y0);
+	}
+}
+
 /*
  * Draw a character in the internal buffer
  */
@@ -511,8 +638,8 @@ void ega_mode0_update_char (ega_t *ega, unsigned char *dst, unsigned w,
 	unsigned            c1, c2;
 	unsigned            ull;
 	int                 incrs, elg, blk;
-	unsigned char       fg[3], bg[3];
-	const unsigned char *fnt;
+	uint32_t            fg, bg;
+	const uint32_t      *fnt;
 
 	blk = 0;
 
@@ -524,8 +651,8 @@ void ega_mode0_update_char (ega_t *ega, unsigned char *dst, unsigned w,
 		a &= 0x7f;
 	}
 
-	ega_get_palette (ega, a & 0x0f, fg, fg + 1, fg + 2);
-	ega_get_palette (ega, (a >> 4) & 0x0f, bg, bg + 1, bg + 2);
+	fg = ega_get_xrgb (ega, a & 0x0f);
+	bg = ega_get_xrgb (ega, (a >> 4) & 0x0f);
 
 	c1 = ega->reg_crt[EGA_CRT_CS] & 0x1f;
 	c2 = ega->reg_crt[EGA_CRT_CE] & 0x1f;
@@ -558,7 +685,7 @@ void ega_mode0_update_char (ega_t *ega, unsigned char *dst, unsigned w,
 			val = 0xffff;
 		}
 		else {
-			val = fnt[y] << 1;
+			val = ((fnt[y] >> 16) & 0xff) << 1;
 
 			if (elg) {
 				val |= (val >> 1) & 1;
@@ -580,21 +707,50 @@ void ega_mode0_update_char (ega_t *ega, unsigned char *dst, unsigned w,
 		}
 
 		for (x = 0; x < cw; x++) {
-			if (val & 0x100) {
-				dst[3 * x + 0] = fg[0];
-				dst[3 * x + 1] = fg[1];
-				dst[3 * x + 2] = fg[2];
-			}
-			else {
-				dst[3 * x + 0] = bg[0];
-				dst[3 * x + 1] = bg[1];
-				dst[3 * x + 2] = bg[2];
-			}
+			((uint32_t *) dst)[x] = (val & 0x100) ? fg : bg;
 
 			val <<= 1;
 		}
 
-		dst += 3 * w;
+		dst += 4 * w;
+	}
+}
+
+/*
+ * Draw a character in the internal buffer using the glyph cache
+ */
+static
+void ega_mode0_draw_char (ega_t *ega, unsigned char *dst, unsigned w,
+	unsigned cw, unsigned ch, unsigned c, unsigned a, int crs)
+{
+	unsigned      y;
+	int           new;
+	unsigned long key;
+	unsigned char *src;
+
+	src = NULL;
+
+	if (crs == 0) {
+		key = (c & 0xff) | ((a & 0xff) << 8) | ((ega->blink_on != 0) << 16);
+		src = glc_get (&ega->glyph, key, &new);
+	}
+
+	if (src == NULL) {
+		ega_mode0_update_char (ega, dst, w, cw, ch, c, a, crs);
+		return;
+	}
+
+	if (new) {
+		ega_mode0_update_char (ega, src, ega->glyph.w,
+			ega->glyph.w, ega->glyph.h, c, a, 0
+		);
+	}
+
+	for (y = 0; y < ch; y++) {
+		memcpy (dst, src, 4 * cw);
+
+		src += 4 * ega->glyph.w;
+		dst += 4 * w;
 	}
 }
 
@@ -602,13 +758,13 @@ void ega_mode0_update_char (ega_t *ega, unsigned char *dst, unsigned w,
  * Update text mode
  */
 static
-void ega_update_text (ega_t *ega)
+void ega_update_text (ega_t *ega, int all)
 {
 	unsigned            x, y, w, h, cw, ch;
 	unsigned            w2, h2;
 	unsigned            addr, rptr, rofs, p;
-	unsigned            cpos;
-	const unsigned char *src;
+	unsigned            cpos, cnt;
+	const uint32_t      *src;
 	unsigned char       *dst;
 
 	w = ega_get_w (ega);
@@ -620,13 +776,19 @@ void ega_update_text (ega_t *ega)
 		return;
 	}
 
-	src = ega->mem;
+	src = ega->vram;
 	dst = ega->buf;
 
 	addr = ega->latch_addr;
 	rofs = 2 * ega->reg_crt[EGA_CRT_OFS];
 	cpos = ega_get_cursor (ega);
 
+	memset (ega->line_dirty, 0, h);
+
+	glc_set_size (&ega->glyph, cw, ch);
+
+	cnt = (w + cw - 1) / cw;
+
 	y = 0;
 
 	while (y < h) {
@@ -636,11 +798,20 @@ void ega_update_text (ega_t *ega)
 			h2 = ch;
 		}
 
-		dst = ega->buf + 3UL * y * w;
+		dst = ega->buf + 4UL * y * w;
 
 		rptr = addr;
 
-		x = 0;
+		if (all || ega_get_cells_dirty (ega, addr, cnt, 0)) {
+			memset (ega->line_dirty + y, 1, h2);
+			x = 0;
+		}
+		else {
+			/* skip character rows that have not been modified */
+			rptr = (addr + cnt) & 0xffff;
+			x = w;
+		}
+
 		while (x < w) {
 			w2 = w - x;
 
@@ -650,8 +821,8 @@ void ega_update_text (ega_t *ega)
 
 			p = ega_get_crtc_addr (ega, rptr, 0);
 
-			ega_mode0_update_char (ega, dst + 3 * x, w, w2, h2,
-				src[p], src[p + 0x10000], rptr == cpos
+			ega_mode0_draw_char (ega, dst + 4 * x, w, w2, h2,
+				src[p] & 0xff, (src[p] >> 8) & 0xff, rptr == cpos
 			);
 
 			rptr = (rptr + 1) & 0xffff;
@@ -669,17 +840,18 @@ void ega_update_text (ega_t *ega)
  * Update graphics mode
  */
 static
-void ega_update_graphics (ega_t *ega)
+void ega_update_graphics (ega_t *ega, int all)
 {
 	unsigned            x, y, w, h;
 	unsigned            row, col, cw, ch;
-	unsigned            lcmp, hpp;
+	unsigned            lcmp, hpp, fetch;
 	unsigned            addr, rptr, rofs, ptr;
 	unsigned char       blink1, blink2;
 	unsigned            msk, bit;
 	unsigned            idx;
 	unsigned char       buf[4];
-	const unsigned char *src;
+	uint32_t            val;
+	const uint32_t      *src;
 	unsigned char       *dst;
 
 	w = ega_get_w (ega);
@@ -693,6 +865,8 @@ void ega_update_graphics (ega_t *ega)
 		return;
 	}
 
+	memset (ega->line_dirty, 0, h);
+
 	if (ega->reg_atc[EGA_ATC_MODE] & EGA_ATC_MODE_EB) {
 		blink1 = 0xff;
 		blink2 = ega->blink_on ? 0xff : 0x00;
@@ -704,7 +878,7 @@ void ega_update_graphics (ega_t *ega)
 
 	hpp = ega->latch_hpp;
 
-	src = ega->mem;
+	src = ega->vram;
 	dst = ega->buf;
 
 	addr = ega->latch_addr;
@@ -714,16 +888,28 @@ void ega_update_graphics (ega_t *ega)
 	y = 0;
 
 	while (y < h) {
-		dst = ega->buf + 3UL * y * w;
+		dst = ega->buf + 4UL * y * w;
 
 		rptr = addr;
 
+		fetch = ega_get_line_fetch (hpp, w, cw);
+
+		if (all || ega_get_cells_dirty (ega, addr, fetch + 1, row)) {
+			ega->line_dirty[y] = 1;
+			x = 0;
+		}
+		else {
+			/* skip scanlines that have not been modified */
+			x = w;
+		}
+
 		ptr = ega_get_crtc_addr (ega, rptr, row);
 
-		buf[0] = src[ptr + 0x00000];
-		buf[1] = src[ptr + 0x10000];
-		buf[2] = src[ptr + 0x20000];
-		buf[3] = (src[ptr + 0x30000] ^ blink1) | blink2;
+		val = src[ptr];
+		buf[0] = val & 0xff;
+		buf[1] = (val >> 8) & 0xff;
+		buf[2] = (val >> 16) & 0xff;
+		buf[3] = (((val >> 24) & 0xff) ^ blink1) | blink2;
 
 		msk = 0x80 >> (hpp & 7);
 		bit = (2 * hpp) & 6;
@@ -731,16 +917,15 @@ void ega_update_graphics (ega_t *ega)
 
 		rptr = (rptr + 1) & 0xffff;
 
-		x = 0;
-
 		while (x < w) {
 			if (col >= cw) {
 				ptr = ega_get_crtc_addr (ega, rptr, row);
 
-				buf[0] = src[ptr + 0x00000];
-				buf[1] = src[ptr + 0x10000];
-				buf[2] = src[ptr + 0x20000];
-				buf[3] = (src[ptr + 0x30000] ^ blink1) | blink2;
+				val = src[ptr];
+				buf[0] = val & 0xff;
+				buf[1] = (val >> 8) & 0xff;
+				buf[2] = (val >> 16) & 0xff;
+				buf[3] = (((val >> 24) & 0xff) ^ blink1) | blink2;
 
 				msk = 0x80;
 				bit = 0;
@@ -769,9 +954,9 @@ void ega_update_graphics (ega_t *ega)
 				msk >>= 1;
 			}
 
-			ega_get_palette (ega, idx, dst, dst + 1, dst + 2);
+			*(uint32_t *) dst = ega_get_xrgb (ega, idx);
 
-			dst += 3;
+			dst += 4;
 			col += 1;
 			x += 1;
 		}
@@ -811,20 +996,21 @@ void ega_update_blank (ega_t *ega)
 		for (x = 0; x < 320; x++) {
 			fx = (x % 16) < 8;
 
-			dst[0] = (fx != fy) ? 0x20 : 0x00;
-			dst[1] = dst[0];
-			dst[2] = dst[0];
+			*(uint32_t *) dst = (fx != fy) ? TRM_XRGB (0x20, 0x20, 0x20) : 0;
 
-			dst += 3;
+			dst += 4;
 		}
 	}
 }
 
 /*
  * Update the internal screen buffer
+ *
+ * If all is false, only lines that refer to modified video memory
+ * are redrawn.
  */
 static
-void ega_update (ega_t *ega)
+void ega_update (ega_t *ega, int all)
 {
 	int      show;
 	unsigned w, h;
@@ -852,15 +1038,16 @@ void ega_update (ega_t *ega)
 
 	if (show == 0) {
 		ega_update_blank (ega);
-		return;
+		memset (ega->line_dirty, 1, ega->buf_h);
 	}
-
-	if (ega->reg_grc[EGA_GRC_MISC] & EGA_GRC_MISC_GM) {
-		ega_update_graphics (ega);
+	else if (ega->reg_grc[EGA_GRC_MISC] & EGA_GRC_MISC_GM) {
+		ega_update_graphics (ega, all);
 	}
 	else {
-		ega_update_text (ega);
+		ega_update_text (ega, all);
 	}
+
+	memset (ega->mem_dirty, 0, sizeof (ega->mem_dirty));
 }
 
 
@@ -909,10 +1096,7 @@ unsigned char ega_mem_get_uint8 (ega_t *ega, unsigned long addr)
 
 	rdmode = (ega->reg_grc[EGA_GRC_MODE] >> 3) & 1;
 
-	ega->latch[0] = ega->mem[addr + 0x00000];
-	ega->latch[1] = ega->mem[addr + 0x10000];
-	ega->latch[2] = ega->mem[addr + 0x20000];
-	ega->latch[3] = ega->mem[addr + 0x30000];
+	ega->latch = ega->vram[addr];
 
 	if (rdmode == 0) {
 		unsigned map;
@@ -923,32 +1107,18 @@ unsigned char ega_mem_get_uint8 (ega_t *ega, unsigned long addr)
 			map = (map & 0x02) + a0;
 		}
 
-		return (ega->latch[map]);
+		return ((ega->latch >> (8 * map)) & 0xff);
 	}
 	else {
-		unsigned char msk, val, c1, c2;
+		uint32_t val;
 
-		val = 0x00;
-		msk = 0x80;
+		/* a bit is set in val for every pixel that does not match */
+		val = ega->latch ^ ega_plane_msk[ega->reg_grc[EGA_GRC_COLCMP] & 0x0f];
+		val &= ega_plane_msk[ega->reg_grc[EGA_GRC_CDC] & 0x0f];
+		val |= val >> 16;
+		val |= val >> 8;
 
-		while (msk != 0) {
-			c1 = (ega->latch[0] & msk) ? 0x01 : 0x00;
-			c1 |= (ega->latch[1] & msk) ? 0x02 : 0x00;
-			c1 |= (ega->latch[2] & msk) ? 0x04 : 0x00;
-			c1 |= (ega->latch[3] & msk) ? 0x08 : 0x00;
-			c1 &= ega->reg_grc[EGA_GRC_CDC];
-
-			c2 = ega->reg_grc[EGA_GRC_COLCMP];
-			c2 &= ega->reg_grc[EGA_GRC_CDC];
-
-			if (c1 == c2) {
-				val |= msk;
-			}
-
-			msk >>= 1;
-		}
-
-		return (val);
+		return (~val & 0xff);
 	}
 
 	return (0);
@@ -975,8 +1145,7 @@ void ega_mem_set_uint8 (ega_t *ega, unsigned long addr, unsigned char val)
 	unsigned      wrmode;
 	unsigned      rot;
 	unsigned char mapmsk, bitmsk;
-	unsigned char esr, set;
-	unsigned char col[4];
+	uint32_t      esr, msk, col;
 
 	if ((ega->reg[EGA_MOUT] & EGA_MOUT_ERAM) == 0) {
 		return;
@@ -1022,27 +1191,18 @@ void ega_mem_set_uint8 (ega_t *ega, unsigned long addr, unsigned char val)
 		rot = ega->reg_grc[EGA_GRC_ROTATE] & 7;
 		val = ((val >> rot) | (val << (8 - rot))) & 0xff;
 
-		esr = ega->reg_grc[EGA_GRC_ENABLESR];
-		set = ega->reg_grc[EGA_GRC_SETRESET];
+		esr = ega_plane_msk[ega->reg_grc[EGA_GRC_ENABLESR] & 0x0f];
 
-		col[0] = (esr & 0x01) ? ((set & 0x01) ? 0xff : 0x00) : val;
-		col[1] = (esr & 0x02) ? ((set & 0x02) ? 0xff : 0x00) : val;
-		col[2] = (esr & 0x04) ? ((set & 0x04) ? 0xff : 0x00) : val;
-		col[3] = (esr & 0x08) ? ((set & 0x08) ? 0xff : 0x00) : val;
+		col = (val * 0x01010101UL) & ~esr;
+		col |= ega_plane_msk[ega->reg_grc[EGA_GRC_SETRESET] & 0x0f] & esr;
 		break;
 
 	case 1: /* write mode 1 */
-		col[0] = ega->latch[0];
-		col[1] = ega->latch[1];
-		col[2] = ega->latch[2];
-		col[3] = ega->latch[3];
+		col = ega->latch;
 		break;
 
 	case 2: /* write mode 2 */
-		col[0] = (val & 0x01) ? 0xff : 0x00;
-		col[1] = (val & 0x02) ? 0xff : 0x00;
-		col[2] = (val & 0x04) ? 0xff : 0x00;
-		col[3] = (val & 0x08) ? 0xff : 0x00;
+		col = ega_plane_msk[val & 0x0f];
 		break;
 
 	default:
@@ -1055,52 +1215,37 @@ void ega_mem_set_uint8 (ega_t *ega, unsigned long addr, unsigned char val)
 			break;
 
 		case 1: /* and */
-			col[0] &= ega->latch[0];
-			col[1] &= ega->latch[1];
-			col[2] &= ega->latch[2];
-			col[3] &= ega->latch[3];
+			col &= ega->latch;
 			break;
 
 		case 2: /* or */
-			col[0] |= ega->latch[0];
-			col[1] |= ega->latch[1];
-			col[2] |= ega->latch[2];
-			col[3] |= ega->latch[3];
+			col |= ega->latch;
 			break;
 
 		case 3: /* xor */
-			col[0] ^= ega->latch[0];
-			col[1] ^= ega->latch[1];
-			col[2] ^= ega->latch[2];
-			col[3] ^= ega->latch[3];
+			col ^= ega->latch;
 			break;
 		}
 	}
 
 	bitmsk = ega->reg_grc[EGA_GRC_BITMASK];
 
-	col[0] = (col[0] & bitmsk) | (ega->latch[0] & ~bitmsk);
-	col[1] = (col[1] & bitmsk) | (ega->latch[1] & ~bitmsk);
-	col[2] = (col[2] & bitmsk) | (ega->latch[2] & ~bitmsk);
-	col[3] = (col[3] & bitmsk) | (ega->latch[3] & ~bitmsk);
+	msk = bitmsk * 0x01010101UL;
+	col = (col & msk) | (ega->latch & ~msk);
 
-	if (mapmsk & 0x01) {
-		ega->mem[addr + 0x00000] = col[0];
-	}
+	msk = ega_plane_msk[mapmsk & 0x0f];
+	ega->vram[addr] = (ega->vram[addr] & ~msk) | (col & msk);
 
-	if (mapmsk & 0x02) {
-		ega->mem[addr + 0x10000] = col[1];
-	}
+	ega->mem_dirty[addr >> EGA_DIRTY_SHIFT] = 1;
 
-	if (mapmsk & 0x04) {
-		ega->mem[addr + 0x20000] = col[2];
+	if ((mapmsk & 0x04) && ((ega->reg_grc[EGA_GRC_MISC] & EGA_GRC_MISC_GM) == 0)) {
+		/* the font is in plane 2 */
+		ega->update_state |= EGA_UPDATE_DIRTY;
+		glc_invalidate (&ega->glyph);
 	}
-
-	if (mapmsk & 0x08) {
-		ega->mem[addr + 0x30000] = col[3];
+	else {
+		ega->update_state |= EGA_UPDATE_MEM;
 	}
-
-	ega->update_state |= EGA_UPDATE_DIRTY;
 }
 
 static
@@ -1132,6 +1277,11 @@ void ega_atc_set_reg (ega_t *ega, unsigned reg, unsigned char val)
 	ega->reg_atc[reg] = val;
 
 	ega->update_state |= EGA_UPDATE_DIRTY;
+
+	if ((reg < 16) || (reg == EGA_ATC_MODE) || (reg == EGA_ATC_CPE)) {
+		/* the palette and the text attributes */
+		glc_invalidate (&ega->glyph);
+	}
 }
 
 
@@ -1166,6 +1316,7 @@ void ega_seq_set_reg (ega_t *ega, unsigned reg, unsigned char val)
 	case EGA_SEQ_CMAPSEL: /* 3 */
 		ega->reg_seq[EGA_SEQ_CMAPSEL] = val;
 		ega->update_state |= EGA_UPDATE_DIRTY;
+		glc_invalidate (&ega->glyph);
 		break;
 
 	case EGA_SEQ_MODE: /* 4 */
@@ -1193,6 +1344,7 @@ void ega_grc_set_reg (ega_t *ega, unsigned reg, unsigned char val)
 
 	if (reg == EGA_GRC_MODE) {
 		ega->update_state |= EGA_UPDATE_DIRTY;
+		glc_invalidate (&ega->glyph);
 	}
 }
 
@@ -1235,6 +1387,10 @@ void ega_crtc_set_reg (ega_t *ega, unsigned reg, unsigned char val)
 	ega_set_timing (ega);
 
 	ega->update_state |= EGA_UPDATE_DIRTY;
+
+	if ((reg == EGA_CRT_MS) || (reg == EGA_CRT_ULL)) {
+		glc_invalidate (&ega->glyph);
+	}
 }
 
 
@@ -1456,6 +1612,11 @@ void ega_set_crtc_data (ega_t *ega, unsigned char val)
 static
 void ega_set_misc_out (ega_t *ega, unsigned char val)
 {
+	if ((ega->reg[EGA_MOUT] ^ val) & EGA_MOUT_VSP) {
+		/* the palette depends on the video subsystem */
+		glc_invalidate (&ega->glyph);
+	}
+
 	ega->reg[EGA_MOUT] = val;
 
 	ega->update_state |= EGA_UPDATE_DIRTY;
@@ -1552,6 +1713,12 @@ void ega_set_terminal (ega_t *ega, terminal_t *trm)
 {
 	ega->term = trm;
 
+	if (trm != NULL) {
+		trm_set_bpp (trm, 4);
+	}
+
+	ega->update_state |= EGA_UPDATE_DIRTY;
+
 	if (ega->term != NULL) {
 		trm_open (ega->term, 640, 400);
 	}
@@ -1624,7 +1791,7 @@ void ega_redraw (ega_t *ega, int now)
 {
 	if (now) {
 		if (ega->term != NULL) {
-			ega_update (ega);
+			ega_update (ega, 1);
 			trm_set_size (ega->term, ega->buf_w, ega->buf_h);
 			trm_set_lines (ega->term, ega->buf, 0, ega->buf_h);
 			trm_update (ega->term);
@@ -1686,17 +1853,29 @@ void ega_clock (ega_t *ega, unsigned long cnt)
 		}
 	}
 
-	if (ega->term != NULL) {
+	if (ega->term == NULL) {
+		ega->update_state = EGA_UPDATE_RETRACE;
+	}
+	else if (trm_skip_frame (ega->term, ega_get_frame_us (ega))) {
+		/* keep the update state for the next presented frame */
+		ega->update_state |= EGA_UPDATE_RETRACE;
+	}
+	else {
 		if (ega->update_state & EGA_UPDATE_DIRTY) {
-			ega_update (ega);
+			ega_update (ega, 1);
 			trm_set_size (ega->term, ega->buf_w, ega->buf_h);
 			trm_set_lines (ega->term, ega->buf, 0, ega->buf_h);
 		}
+		else if (ega->update_state & EGA_UPDATE_MEM) {
+			ega_update (ega, 0);
+			trm_set_size (ega->term, ega->buf_w, ega->buf_h);
+			ega_set_lines (ega);
+		}
 
 		trm_update (ega->term);
-	}
 
-	ega->update_state = EGA_UPDATE_RETRACE;
+		ega->update_state = EGA_UPDATE_RETRACE;
+	}
 
 	if ((ega->reg_crt[EGA_CRT_VRE] & EGA_CRT_VRE_EVI) == 0) {
 		/* vertical retrace interrupt enabled */
@@ -1714,6 +1893,11 @@ void ega_free (ega_t *ega)
 {
 	mem_blk_del (ega->memblk);
 	mem_blk_del (ega->regblk);
+
+	glc_free (&ega->glyph);
+
+	free (ega->line_dirty);
+	free (ega->buf);
 }
 
 void ega_del (ega_t *ega)
@@ -1756,7 +1940,8 @@ void ega_init (ega_t *ega, unsigned long io, unsigned long addr)
 	ega->memblk->get_uint8 = (void *) ega_mem_get_uint8;
 	ega->memblk->get_uint16 = (void *) ega_mem_get_uint16;
 	ega->mem = ega->memblk->data;
-	mem_blk_clear (ega->memblk, 0x00);
+	ega->vram = (uint32_t *) ega->mem;
+	memset (ega->mem, 0, 256UL * 1024UL);
 
 	ega->regblk = mem_blk_new (io, 0x30, 1);
 	ega->regblk->ext = ega;
@@ -1783,9 +1968,7 @@ void ega_init (ega_t *ega, unsigned long io, unsigned long addr)
 		ega->reg_crt[i] = 0;
 	}
 
-	for (i = 0; i < 4; i++) {
-		ega->latch[i] = 0;
-	}
+	ega->latch = 0;
 
 	ega->latch_addr = 0;
 	ega->latch_hpp = 0;
@@ -1807,6 +1990,14 @@ void ega_init (ega_t *ega, unsigned long io, unsigned long addr)
 	ega->bufmax = 0;
 	ega->buf = NULL;
 
+	ega->linemax = 0;
+	ega->line_dirty = NULL;
+
+	glc_init (&ega->glyph, 4096);
+	glc_set_bpp (&ega->glyph, 4);
+
+	memset (ega->mem_dirty, 0, sizeof (ega->mem_dirty));
+
 	ega->update_state = 0;
 
 	ega->set_irq_ext = NULL;
@@ -24,8 +24,11 @@
 #define PCE_VIDEO_EGA_H 1
 
 
+#include <stdint.h>
+
 #include <libini/libini.h>
 #include <drivers/video/terminal.h>
+#include <devices/video/glyph.h>
 #include <devices/video/video.h>
 
 
@@ -37,6 +40,13 @@ typedef struct ega_s {
 	mem_blk_t     *memblk;
 	unsigned char *mem;
 
+	/*
+	 * The video memory, as 64K 32 bit words. Each word contains
+	 * the bytes of the four planes at one address, with plane 0
+	 * in bits 0-7 and plane 3 in bits 24-31.
+	 */
+	uint32_t      *vram;
+
 	mem_blk_t     *regblk;
 	unsigned char *reg;
 
@@ -50,7 +60,8 @@ typedef struct ega_s {
 
 	char          atc_flipflop;
 
-	unsigned char latch[4];
+	/* the latches, in the same format as vram */
+	uint32_t      latch;
 
 	/* the switch settings */
 	unsigned char switches;
@@ -73,6 +84,15 @@ typedef struct ega_s {
 	unsigned long bufmax;
 	unsigned char *buf;
 
+	/* one flag per line in buf, set if the line was redrawn */
+	unsigned      linemax;
+	unsigned char *line_dirty;
+
+	/* one flag per 16 bytes of video memory, set if modified */
+	unsigned char mem_dirty[4096];
+
+	glyph_cache_t glyph;
+
 	unsigned char update_state;
 
 	void          *set_irq_ext;
@@ -0,0 +1,187 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/devices/video/glyph.c                                    *
+ * Created:     2026-10-18 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "glyph.h"
+
+
+#define GLC_KEY_NONE 0xffffffffUL
+
+
+void glc_init (glyph_cache_t *glc, unsigned cnt)
+{
+	glc->w = 0;
+	glc->h = 0;
+	glc->bpp = 3;
+
+	glc->cnt = 1;
+
+	while (glc->cnt < cnt) {
+		glc->cnt *= 2;
+	}
+
+	glc->flush = 0;
+
+	glc->key = NULL;
+	glc->data = NULL;
+}
+
+void glc_free (glyph_cache_t *glc)
+{
+	free (glc->key);
+	free (glc->data);
+
+	glc->key = NULL;
+	glc->data = NULL;
+
+	glc->w = 0;
+	glc->h = 0;
+}
+
+static
+void glc_clear (glyph_cache_t *glc)
+{
+	unsigned i;
+
+	for (i = 0; i < glc->cnt; i++) {
+		glc->key[i] = GLC_KEY_NONE;
+	}
+
+	glc->flush = 0;
+}
+
+void glc_invalidate (glyph_cache_t *glc)
+{
+	glc->flush = 1;
+}
+
+int glc_set_size (glyph_cache_t *glc, unsigned w, unsigned h)
+{
+	unsigned char *data;
+
+	if ((glc->w == w) && (glc->h == h) && (glc->data != NULL)) {
+		return (0);
+	}
+
+	if (glc->key == NULL) {
+		glc->key = malloc (glc->cnt * sizeof (unsigned long));
+
+		if (glc->key == NULL) {
+			return (1);
+		}
+	}
+
+	data = realloc (glc->data, (unsigned long) glc->cnt * glc->bpp * w * h);
+
+	if (data == NULL) {
+		glc_free (glc);
+		return (1);
+	}
+
+	glc->data = data;
+	glc->w = w;
+	glc->h = h;
+
+	glc_clear (glc);
+
+	return (0);
+}
+
+void glc_set_bpp (glyph_cache_t *glc, unsigned bpp)
+{
+	bpp = (bpp == 4) ? 4 : 3;
+
+	if (glc->bpp == bpp) {
+		return;
+	}
+
+	free (glc->data);
+
+	glc->data = NULL;
+	glc->bpp = bpp;
+}
+
+unsigned char *glc_get (glyph_cache_t *glc, unsigned long key, int *new)
+{
+	unsigned idx;
+
+	if (glc->data == NULL) {
+		return (NULL);
+	}
+
+	if (glc->flush) {
+		glc_clear (glc);
+	}
+
+	key &= GLC_KEY_NONE;
+
+	idx = (unsigned) ((key * 0x9e3779b1UL) & 0xffffffffUL);
+	idx = (idx >> 16) ^ (idx & 0xffff);
+	idx &= glc->cnt - 1;
+
+	if (glc->key[idx] == key) {
+		*new = 0;
+	}
+	else {
+		glc->key[idx] = key;
+		*new = 1;
+	}
+
+	return (glc->data + (unsigned long) glc->bpp * glc->w * glc->h * idx);
+}
+
+void glc_set_row (const glyph_cache_t *glc, unsigned char *dst, unsigned val,
+	const unsigned char *fg, const unsigned char *bg)
+{
+	unsigned            x, msk;
+	const unsigned char *col;
+
+	msk = 1U << (glc->w - 1);
+
+	if (glc->bpp == 4) {
+		uint32_t c0, c1;
+
+		c0 = ((uint32_t) bg[0] << 16) | ((uint32_t) bg[1] << 8) | bg[2];
+		c1 = ((uint32_t) fg[0] << 16) | ((uint32_t) fg[1] << 8) | fg[2];
+
+		for (x = 0; x < glc->w; x++) {
+			((uint32_t *) dst)[x] = (val & msk) ? c1 : c0;
+			msk >>= 1;
+		}
+
+		return;
+	}
+
+	for (x = 0; x < glc->w; x++) {
+		col = (val & msk) ? fg : bg;
+
+		dst[0] = col[0];
+		dst[1] = col[1];
+		dst[2] = col[2];
+
+		dst += 3;
+		msk >>= 1;
+	}
+}
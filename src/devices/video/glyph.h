@@ -0,0 +1,103 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/devices/video/glyph.h                                    *
+ * Created:     2026-10-18 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#ifndef PCE_VIDEO_GLYPH_H
+#define PCE_VIDEO_GLYPH_H 1
+
+
+/*!***************************************************************************
+ * @short A cache of text mode character cells expanded to RGB
+ *
+ * Each glyph is identified by a key that is chosen by the video device
+ * and usually combines the character code, the attribute and the blink
+ * phase. The cache is direct mapped, a glyph that is not in the cache
+ * replaces the glyph in its slot and must be rendered by the caller.
+ *****************************************************************************/
+typedef struct {
+	/* the glyph size in pixels */
+	unsigned      w;
+	unsigned      h;
+
+	/* bytes per pixel, 3 (RGB) or 4 (XRGB) */
+	unsigned      bpp;
+
+	/* the number of slots, a power of 2 */
+	unsigned      cnt;
+
+	/* the cache is cleared on the next lookup */
+	char          flush;
+
+	unsigned long *key;
+	unsigned char *data;
+} glyph_cache_t;
+
+
+void glc_init (glyph_cache_t *glc, unsigned cnt);
+
+void glc_free (glyph_cache_t *glc);
+
+/*!***************************************************************************
+ * @short Discard all cached glyphs
+ *
+ * This must be called whenever the font or the palette changes. It is
+ * cheap, the slots are only cleared on the next lookup.
+ *****************************************************************************/
+void glc_invalidate (glyph_cache_t *glc);
+
+/*!***************************************************************************
+ * @short  Set the glyph size
+ * @return Zero if successful, nonzero otherwise
+ *
+ * If the size changes, all cached glyphs are discarded.
+ *****************************************************************************/
+int glc_set_size (glyph_cache_t *glc, unsigned w, unsigned h);
+
+/*!***************************************************************************
+ * @short Set the pixel format
+ * @param bpp 3 for RGB pixels or 4 for 32 bit XRGB words, as in terminal_t
+ *
+ * If the format changes, all cached glyphs are discarded. The new format
+ * takes effect with the next call to glc_set_size().
+ *****************************************************************************/
+void glc_set_bpp (glyph_cache_t *glc, unsigned bpp);
+
+/*!***************************************************************************
+ * @short  Look up a glyph
+ * @param  key The glyph key
+ * @retval new Set to 1 if the glyph was not in the cache, 0 otherwise
+ * @return The glyph pixels (w * h * bpp bytes) or NULL on error
+ *
+ * If new is set, the caller must render the glyph into the returned
+ * buffer before the next call to glc_get().
+ *****************************************************************************/
+unsigned char *glc_get (glyph_cache_t *glc, unsigned long key, int *new);
+
+/*!***************************************************************************
+ * @short Expand one glyph row
+ * @param dst The destination row (w * bpp bytes)
+ * @param val The row bits, bit (w - 1) is the leftmost pixel
+ *****************************************************************************/
+void glc_set_row (const glyph_cache_t *glc, unsigned char *dst, unsigned val,
+	const unsigned char *fg, const unsigned char *bg);
+
+
+#endif
@@ -72,7 +72,98 @@ void hgc_line_blank (hgc_t *hgc, unsigned row)
 
 	ptr = pce_video_get_row_ptr (&hgc->video, row);
 
-	memset (ptr, 0, 3 * hgc->video.buf_w);
+	memset (ptr, 0, 4 * hgc->video.buf_w);
+}
+
+/*
+ * Get the foreground and background colors for an attribute
+ */
+static
+void hgc_get_colors (hgc_t *hgc, unsigned char attr, int blink,
+	const unsigned char **fg, const unsigned char **bg)
+{
+	unsigned fgi, bgi;
+
+	switch (attr & 0x7f) {
+	case 0x00:
+	case 0x08:
+		fgi = 0;
+		bgi = 0;
+		break;
+
+	case 0x70:
+		fgi = 0;
+		bgi = ((attr & 0x80) && !blink) ? 3 : 2;
+		break;
+
+	case 0x78:
+		fgi = 1;
+		bgi = ((attr & 0x80) && !blink) ? 3 : 2;
+		break;
+
+	default:
+		fgi = (attr & 0x08) ? 3 : 2;
+		bgi = 0;
+		break;
+	}
+
+	*fg = hgc->rgb[fgi];
+	*bg = hgc->rgb[bgi];
+}
+
+/*
+ * Get the 9 pixels of a character row, bit 8 is the leftmost pixel
+ */
+static
+unsigned hgc_get_row (hgc_t *hgc, unsigned char code, unsigned char attr,
+	unsigned ra, int blink)
+{
+	unsigned val;
+
+	val = hgc->font[14 * code + (ra & 0x0f)] << 1;
+
+	if ((code & 0xe0) == 0xc0) {
+		val |= (val >> 1) & 1;
+	}
+
+	if (((attr & 7) == 1) && (ra == 13)) {
+		val = 0x1ff;
+	}
+
+	if ((attr & 0x80) && blink && (hgc->blink == 0)) {
+		val = 0;
+	}
+
+	return (val);
+}
+
+/*
+ * Get a text mode character from the glyph cache
+ */
+static
+const unsigned char *hgc_get_glyph (hgc_t *hgc, unsigned char code, unsigned char attr, int blink)
+{
+	unsigned            i;
+	int                 new;
+	unsigned long       key;
+	unsigned char       *glyph;
+	const unsigned char *fg, *bg;
+
+	key = code | (attr << 8) | ((blink != 0) << 16) | ((hgc->blink != 0) << 17);
+
+	glyph = glc_get (&hgc->glyph, key, &new);
+
+	if ((glyph != NULL) && new) {
+		hgc_get_colors (hgc, attr, blink, &fg, &bg);
+
+		for (i = 0; i < 14; i++) {
+			glc_set_row (&hgc->glyph, glyph + 36 * i,
+				hgc_get_row (hgc, code, attr, i, blink), fg, bg
+			);
+		}
+	}
+
+	return (glyph);
 }
 
 static
@@ -83,8 +174,8 @@ void hgc_line_text (hgc_t *hgc, unsigned row)
 	unsigned            addr, caddr;
 	unsigned char       code, attr;
 	int                 blink;
-	unsigned            fgi, bgi;
-	const unsigned char *mem, *col, *fg, *bg;
+	uint32_t            c0, c1;
+	const unsigned char *mem, *fg, *bg, *glyph;
 	unsigned char       *ptr;
 
 	hd = hgc->crtc.reg[E6845_REG_HD];
@@ -114,57 +205,34 @@ void hgc_line_text (hgc_t *hgc, unsigned row)
 		code = mem[(2 * addr + 0) & 0x7fff];
 		attr = mem[(2 * addr + 1) & 0x7fff];
 
-		val = hgc->font[14 * code + (hgc->crtc.ra & 0x0f)] << 1;
+		if ((hgc->crtc.ra < 14) && (addr != caddr)) {
+			glyph = hgc_get_glyph (hgc, code, attr, blink);
 
-		if ((code & 0xe0) == 0xc0) {
-			val |= (val >> 1) & 1;
-		}
+			if (glyph != NULL) {
+				memcpy (ptr, glyph + 36 * hgc->crtc.ra, 36);
 
-		if (((attr & 7) == 1) && (hgc->crtc.ra == 13)) {
-			val = 0x1ff;
-		}
+				ptr += 36;
+				addr += 1;
 
-		if ((attr & 0x80) && blink && (hgc->blink == 0)) {
-			val = 0;
+				continue;
+			}
 		}
 
+		val = hgc_get_row (hgc, code, attr, hgc->crtc.ra, blink);
+
 		if (addr == caddr) {
 			val |= cmask;
 		}
 
-		switch (attr & 0x7f) {
-		case 0x00:
-		case 0x08:
-			fgi = 0;
-			bgi = 0;
-			break;
-
-		case 0x70:
-			fgi = 0;
-			bgi = ((attr & 0x80) && !blink) ? 3 : 2;
-			break;
-
-		case 0x78:
-			fgi = 1;
-			bgi = ((attr & 0x80) && !blink) ? 3 : 2;
-			break;
-
-		default:
-			fgi = (attr & 0x08) ? 3 : 2;
-			bgi = 0;
-			break;
-		}
+		hgc_get_colors (hgc, attr, blink, &fg, &bg);
 
-		fg = hgc->rgb[fgi];
-		bg = hgc->rgb[bgi];
+		c1 = TRM_XRGB (fg[0], fg[1], fg[2]);
+		c0 = TRM_XRGB (bg[0], bg[1], bg[2]);
 
 		for (j = 0; j < 9; j++) {
-			col = (val & 0x100) ? fg : bg;
-
-			*(ptr++) = col[0];
-			*(ptr++) = col[1];
-			*(ptr++) = col[2];
+			*(uint32_t *) ptr = (val & 0x100) ? c1 : c0;
 
+			ptr += 4;
 			val <<= 1;
 		}
 
@@ -175,9 +243,9 @@ void hgc_line_text (hgc_t *hgc, unsigned row)
 static
 void hgc_line_graph (hgc_t *hgc, unsigned row)
 {
-	unsigned            i, j;
-	unsigned            hd, val, addr, ra, ma;
-	const unsigned char *mem, *col, *fg, *bg;
+	unsigned            i;
+	unsigned            hd, addr, ra, ma;
+	const unsigned char *mem;
 	unsigned char       *ptr;
 
 	hd = hgc->crtc.reg[E6845_REG_HD];
@@ -194,25 +262,12 @@ void hgc_line_graph (hgc_t *hgc, unsigned row)
 	mem = hgc->mem + ((hgc->reg[HGC_MODE] & HGC_MODE_PAGE1) ? 0x8000 : 0);
 	ptr = pce_video_get_row_ptr (&hgc->video, row);
 
-	fg = hgc->rgb[4];
-	bg = hgc->rgb[0];
-
 	for (i = 0; i < hd; i++) {
 		addr = (ma & 0x1fff) | ra;
 
-		val = mem[addr];
-		val = (val << 8) | mem[addr + 1];
-
-		for (j = 0; j < 16; j++) {
-			col = (val & 0x8000) ? fg : bg;
-
-			*(ptr++) = col[0];
-			*(ptr++) = col[1];
-			*(ptr++) = col[2];
-
-			val <<= 1;
-		}
+		mono_tab_expand (&hgc->mono, ptr, mem + addr, 2);
 
+		ptr += 64;
 		ma += 2;
 	}
 }
@@ -281,7 +336,7 @@ void hgc_vsync (hgc_t *hgc)
 	}
 
 	if ((vid->buf_w != vid->buf_next_w) || (vid->buf_h != vid->buf_next_h)) {
-		pce_video_set_buf_size (vid, vid->buf_next_w, vid->buf_next_h, 3);
+		pce_video_set_buf_size (vid, vid->buf_next_w, vid->buf_next_h, 4);
 		hgc->mod_cnt = 1;
 	}
 
@@ -333,6 +388,9 @@ void hgc_set_color_index (hgc_t *hgc, unsigned i, unsigned long col)
 		hgc->rgb[i][1] = (col >> 8) & 0xff;
 		hgc->rgb[i][2] = col & 0xff;
 		hgc->mod_cnt = 2;
+
+		glc_invalidate (&hgc->glyph);
+		mono_tab_set_color (&hgc->mono, hgc->rgb[0], hgc->rgb[4]);
 	}
 }
 
@@ -657,6 +715,7 @@ void hgc_set_terminal (hgc_t *hgc, terminal_t *trm)
 	hgc->term = trm;
 
 	if (hgc->term != NULL) {
+		trm_set_bpp (hgc->term, 4);
 		trm_open (hgc->term, 720, 350);
 	}
 }
@@ -716,6 +775,13 @@ hgc_t *hgc_new (unsigned long io, unsigned long mem)
 	hgc->mod_cnt = 0;
 	hgc->lfsr = 1;
 
+	glc_init (&hgc->glyph, 4096);
+	glc_set_bpp (&hgc->glyph, 4);
+	glc_set_size (&hgc->glyph, 9, 14);
+
+	memset (hgc->rgb, 0, sizeof (hgc->rgb));
+	mono_tab_init (&hgc->mono, hgc->rgb[0], hgc->rgb[4]);
+
 	hgc->blink = 0;
 	hgc->blink_cnt = 0;
 	hgc->blink_rate = 16;
@@ -734,6 +800,8 @@ void hgc_del (hgc_t *hgc)
 		mem_blk_del (hgc->memblk);
 		mem_blk_del (hgc->regblk);
 
+		glc_free (&hgc->glyph);
+
 		free (hgc);
 	}
 }
@@ -61,7 +61,98 @@ void mda_line_blank (mda_t *mda, unsigned row)
 
 	ptr = pce_video_get_row_ptr (&mda->video, row);
 
-	memset (ptr, 0, 3 * mda->video.buf_w);
+	memset (ptr, 0, 4 * mda->video.buf_w);
+}
+
+/*
+ * Get the foreground and background colors for an attribute
+ */
+static
+void mda_get_colors (mda_t *mda, unsigned char attr, int blink,
+	const unsigned char **fg, const unsigned char **bg)
+{
+	unsigned fgi, bgi;
+
+	switch (attr & 0x7f) {
+	case 0x00:
+	case 0x08:
+		fgi = 0;
+		bgi = 0;
+		break;
+
+	case 0x70:
+		fgi = 0;
+		bgi = ((attr & 0x80) && !blink) ? 3 : 2;
+		break;
+
+	case 0x78:
+		fgi = 1;
+		bgi = ((attr & 0x80) && !blink) ? 3 : 2;
+		break;
+
+	default:
+		fgi = (attr & 0x08) ? 3 : 2;
+		bgi = 0;
+		break;
+	}
+
+	*fg = mda->rgb[fgi];
+	*bg = mda->rgb[bgi];
+}
+
+/*
+ * Get the 9 pixels of a character row, bit 8 is the leftmost pixel
+ */
+static
+unsigned mda_get_row (mda_t *mda, unsigned char code, unsigned char attr,
+	unsigned ra, int blink)
+{
+	unsigned val;
+
+	val = mda->font[14 * code + (ra & 0x0f)] << 1;
+
+	if ((code & 0xe0) == 0xc0) {
+		val |= (val >> 1) & 1;
+	}
+
+	if (((attr & 7) == 1) && (ra == 13)) {
+		val = 0x1ff;
+	}
+
+	if ((attr & 0x80) && blink && (mda->blink == 0)) {
+		val = 0;
+	}
+
+	return (val);
+}
+
+/*
+ * Get a text mode character from the glyph cache
+ */
+static
+const unsigned char *mda_get_glyph (mda_t *mda, unsigned char code, unsigned char attr, int blink)
+{
+	unsigned            i;
+	int                 new;
+	unsigned long       key;
+	unsigned char       *glyph;
+	const unsigned char *fg, *bg;
+
+	key = code | (attr << 8) | ((blink != 0) << 16) | ((mda->blink != 0) << 17);
+
+	glyph = glc_get (&mda->glyph, key, &new);
+
+	if ((glyph != NULL) && new) {
+		mda_get_colors (mda, attr, blink, &fg, &bg);
+
+		for (i = 0; i < 14; i++) {
+			glc_set_row (&mda->glyph, glyph + 36 * i,
+				mda_get_row (mda, code, attr, i, blink), fg, bg
+			);
+		}
+	}
+
+	return (glyph);
 }
 
 static
@@ -72,8 +163,8 @@ void mda_line_text (mda_t *mda, unsigned row)
 	unsigned            addr, caddr;
 	unsigned char       code, attr;
 	int                 blink;
-	unsigned            fgi, bgi;
-	const unsigned char *fg, *bg, *col;
+	uint32_t            c0, c1;
+	const unsigned char *fg, *bg, *glyph;
 	unsigned char       *ptr;
 
 	hd = e6845_get_hd (&mda->crtc);
@@ -102,57 +193,34 @@ void mda_line_text (mda_t *mda, unsigned row)
 		code = mda->mem[(2 * addr + 0) & 0x0fff];
 		attr = mda->mem[(2 * addr + 1) & 0x0fff];
 
-		val = mda->font[14 * code + (mda->crtc.ra & 0x0f)] << 1;
+		if ((mda->crtc.ra < 14) && (addr != caddr)) {
+			glyph = mda_get_glyph (mda, code, attr, blink);
 
-		if ((code & 0xe0) == 0xc0) {
-			val |= (val >> 1) & 1;
-		}
+			if (glyph != NULL) {
+				memcpy (ptr, glyph + 36 * mda->crtc.ra, 36);
 
-		if (((attr & 7) == 1) && (mda->crtc.ra == 13)) {
-			val = 0x1ff;
-		}
+				ptr += 36;
+				addr += 1;
 
-		if ((attr & 0x80) && blink && (mda->blink == 0)) {
-			val = 0;
+				continue;
+			}
 		}
 
+		val = mda_get_row (mda, code, attr, mda->crtc.ra, blink);
+
 		if (addr == caddr) {
 			val |= cmask;
 		}
 
-		switch (attr & 0x7f) {
-		case 0x00:
-		case 0x08:
-			fgi = 0;
-			bgi = 0;
-			break;
-
-		case 0x70:
-			fgi = 0;
-			bgi = ((attr & 0x80) && !blink) ? 3 : 2;
-			break;
-
-		case 0x78:
-			fgi = 1;
-			bgi = ((attr & 0x80) && !blink) ? 3 : 2;
-			break;
-
-		default:
-			fgi = (attr & 0x08) ? 3 : 2;
-			bgi = 0;
-			break;
-		}
+		mda_get_colors (mda, attr, blink, &fg, &bg);
 
-		fg = mda->rgb[fgi];
-		bg = mda->rgb[bgi];
+		c1 = TRM_XRGB (fg[0], fg[1], fg[2]);
+		c0 = TRM_XRGB (bg[0], bg[1], bg[2]);
 
 		for (j = 0; j < 9; j++) {
-			col = (val & 0x100) ? fg : bg;
-
-			*(ptr++) = col[0];
-			*(ptr++) = col[1];
-			*(ptr++) = col[2];
+			*(uint32_t *) ptr = (val & 0x100) ? c1 : c0;
 
+			ptr += 4;
 			val <<= 1;
 		}
 
@@ -221,7 +289,7 @@ void mda_vsync (mda_t *mda)
 	}
 
 	if ((vid->buf_w != vid->buf_next_w) || (vid->buf_h != vid->buf_next_h)) {
-		pce_video_set_buf_size (vid, vid->buf_next_w, vid->buf_next_h, 3);
+		pce_video_set_buf_size (vid, vid->buf_next_w, vid->buf_next_h, 4);
 		mda->mod_cnt = 1;
 	}
 
@@ -267,6 +335,8 @@ void mda_set_color_index (mda_t *mda, unsigned i, unsigned long col)
 		mda->rgb[i][1] = (col >> 8) & 0xff;
 		mda->rgb[i][2] = col & 0xff;
 		mda->mod_cnt = 2;
+
+		glc_invalidate (&mda->glyph);
 	}
 }
 
@@ -495,6 +565,7 @@ void mda_set_terminal (mda_t *mda, terminal_t *trm)
 	mda->term = trm;
 
 	if (mda->term != NULL) {
+		trm_set_bpp (mda->term, 4);
 		trm_open (mda->term, 720, 350);
 	}
 }
@@ -553,6 +624,10 @@ mda_t *mda_new (unsigned long io, unsigned long mem)
 	mda->mod_cnt = 0;
 	mda->lfsr = 1;
 
+	glc_init (&mda->glyph, 4096);
+	glc_set_bpp (&mda->glyph, 4);
+	glc_set_size (&mda->glyph, 9, 14);
+
 	mda->blink = 0;
 	mda->blink_cnt = 0;
 	mda->blink_rate = 16;
@@ -571,6 +646,8 @@ void mda_del (mda_t *mda)
 		mem_blk_del (mda->memblk);
 		mem_blk_del (mda->regblk);
 
+		glc_free (&mda->glyph);
+
 		free (mda);
 	}
 }
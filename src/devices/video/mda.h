@@ -26,6 +26,7 @@
 
 #include <chipset/e6845.h>
 #include <devices/memory.h>
+#include <devices/video/glyph.h>
 #include <devices/video/video.h>
 #include <drivers/video/terminal.h>
 #include <libini/libini.h>
@@ -43,6 +44,7 @@ typedef struct {
 	terminal_t          *term;
 
 	const unsigned char *font;
+	glyph_cache_t       glyph;
 
 	unsigned long       clock;
 
@@ -78,42 +78,45 @@
 static void m24_del (m24_t *m24);
 
 
-unsigned char m24_rgbi[16 * 4] = {
-	0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0xaa, 0x00,
-	0x00, 0xaa, 0x00, 0x00,
-	0x00, 0xaa, 0xaa, 0x00,
-	0xaa, 0x00, 0x00, 0x00,
-	0xaa, 0x00, 0xaa, 0x00,
-	0xaa, 0x55, 0x00, 0x00,
-	0xaa, 0xaa, 0xaa, 0x00,
-	0x55, 0x55, 0x55, 0x00,
-	0x55, 0x55, 0xff, 0x00,
-	0x55, 0xff, 0x55, 0x00,
-	0x55, 0xff, 0xff, 0x00,
-	0xff, 0x55, 0x55, 0x00,
-	0xff, 0x55, 0xff, 0x00,
-	0xff, 0xff, 0x55, 0x00,
-	0xff, 0xff, 0xff, 0x00
+/* the colors as 32 bit terminal pixels, see TRM_XRGB() */
+static
+uint32_t m24_rgbi[16] = {
+	0x000000,
+	0x0000aa,
+	0x00aa00,
+	0x00aaaa,
+	0xaa0000,
+	0xaa00aa,
+	0xaa5500,
+	0xaaaaaa,
+	0x555555,
+	0x5555ff,
+	0x55ff55,
+	0x55ffff,
+	0xff5555,
+	0xff55ff,
+	0xffff55,
+	0xffffff
 };
 
-unsigned char m24_gray[16 * 4] = {
-	0x00, 0x00, 0x00, 0x00,
-	0x18, 0x18, 0x18, 0x00,
-	0x30, 0x30, 0x30, 0x00,
-	0x48, 0x48, 0x48, 0x00,
-	0x60, 0x60, 0x60, 0x00,
-	0x78, 0x78, 0x78, 0x00,
-	0x90, 0x90, 0x90, 0x00,
-	0xaa, 0xaa, 0xaa, 0x00,
-	0x55, 0x55, 0x55, 0x00,
-	0x6d, 0x6d, 0x6d, 0x00,
-	0x85, 0x85, 0x85, 0x00,
-	0x9d, 0x9d, 0x9d, 0x00,
-	0xb6, 0xb6, 0xb6, 0x00,
-	0xce, 0xce, 0xce, 0x00,
-	0xe6, 0xe6, 0xe6, 0x00,
-	0xff, 0xff, 0xff, 0x00
+static
+uint32_t m24_gray[16] = {
+	0x000000,
+	0x181818,
+	0x303030,
+	0x484848,
+	0x606060,
+	0x787878,
+	0x909090,
+	0xaaaaaa,
+	0x555555,
+	0x6d6d6d,
+	0x858585,
+	0x9d9d9d,
+	0xb6b6b6,
+	0xcecece,
+	0xe6e6e6,
+	0xffffff
 };
 
 
@@ -124,7 +127,7 @@ void m24_line_blank (m24_t *m24, unsigned row)
 
 	p = pce_video_get_row_ptr (&m24->video, row);
 
-	memset (p, 0, 3 * m24->video.buf_w);
+	memset (p, 0, 4 * m24->video.buf_w);
 }
 
 /*
@@ -139,7 +142,8 @@ void m24_line_mode0 (m24_t *m24, unsigned row)
 	unsigned            addr, caddr, amask;
 	unsigned char       code, attr;
 	unsigned char       val, mask, cmask;
-	const unsigned char *font, *fg, *bg, *col;
+	uint32_t            fg, bg, col;
+	const unsigned char *font;
 	unsigned char       *ptr;
 
 	hd = e6845_get_hd (&m24->crtc);
@@ -196,17 +200,16 @@ void m24_line_mode0 (m24_t *m24, unsigned row)
 			val |= cmask;
 		}
 
-		fg = m24->rgbi + 4 * (attr & 15);
-		bg = m24->rgbi + 4 * ((attr >> 4) & 15);
+		fg = m24->rgbi[attr & 15];
+		bg = m24->rgbi[(attr >> 4) & 15];
 
 		mask = 0x80;
 
 		for (j = 0; j < 8; j++) {
 			col = (val & mask) ? fg : bg;
 
-			*(ptr++) = col[0];
-			*(ptr++) = col[1];
-			*(ptr++) = col[2];
+			*(uint32_t *) ptr = col;
+			ptr += 4;
 
 			mask >>= 1;
 		}
@@ -223,8 +226,8 @@ void m24_line_mode1 (m24_t *m24, unsigned row)
 {
 	unsigned            i, j;
 	unsigned            hd, addr, val;
+	uint32_t            col;
 	unsigned char       *ptr;
-	const unsigned char *col;
 
 	hd = e6845_get_hd (&m24->crtc);
 
@@ -242,11 +245,10 @@ void m24_line_mode1 (m24_t *m24, unsigned row)
 		val = (val << 8) | m24->mem[(addr + 1) & 0x7fff];
 
 		for (j = 0; j < 8; j++) {
-			col = m24->rgbi + 4 * m24->pal[(val >> 14) & 3];
+			col = m24->rgbi[m24->pal[(val >> 14) & 3]];
 
-			*(ptr++) = col[0];
-			*(ptr++) = col[1];
-			*(ptr++) = col[2];
+			*(uint32_t *) ptr = col;
+			ptr += 4;
 
 			val <<= 2;
 		}
@@ -263,8 +265,8 @@ void m24_line_mode2 (m24_t *m24, unsigned row)
 {
 	unsigned            i, j;
 	unsigned            hd, addr, val;
+	uint32_t            fg, bg, col;
 	unsigned char       *ptr;
-	const unsigned char *fg, *bg, *col;
 
 	hd = e6845_get_hd (&m24->crtc);
 
@@ -285,8 +287,8 @@ void m24_line_mode2 (m24_t *m24, unsigned row)
 		addr |= (m24->crtc.ra & 2) << 12;
 	}
 
-	fg = m24->rgbi + 4 * (m24->reg[M24_CSEL] & 15);
-	bg = m24->rgbi;
+	fg = m24->rgbi[m24->reg[M24_CSEL] & 15];
+	bg = m24->rgbi[0];
 
 	for (i = 0; i < hd; i++) {
 		val = m24->mem[addr & 0x7fff];
@@ -295,9 +297,8 @@ void m24_line_mode2 (m24_t *m24, unsigned row)
 		for (j = 0; j < 16; j++) {
 			col = (val & 0x8000) ? fg : bg;
 
-			*(ptr++) = col[0];
-			*(ptr++) = col[1];
-			*(ptr++) = col[2];
+			*(uint32_t *) ptr = col;
+			ptr += 4;
 
 			val <<= 1;
 		}
@@ -378,7 +379,7 @@ void m24_vsync (m24_t *m24)
 	}
 
 	if ((vid->buf_w != vid->buf_next_w) || (vid->buf_h != vid->buf_next_h)) {
-		pce_video_set_buf_size (vid, vid->buf_next_w, vid->buf_next_h, 3);
+		pce_video_set_buf_size (vid, vid->buf_next_w, vid->buf_next_h, 4);
 		m24->mod_cnt = 1;
 	}
 
@@ -768,6 +769,7 @@ void m24_set_terminal (m24_t *m24, terminal_t *trm)
 	m24->term = trm;
 
 	if (m24->term != NULL) {
+		trm_set_bpp (m24->term, 4);
 		trm_open (m24->term, 640, 400);
 	}
 }
@@ -44,7 +44,7 @@ typedef struct {
 	terminal_t          *term;
 
 	const unsigned char *font;
-	const unsigned char *rgbi;
+	const uint32_t      *rgbi;
 	const unsigned char *scrambler;
 
 	unsigned long       clock;
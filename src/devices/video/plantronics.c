@@ -74,24 +74,25 @@
 static void pla_del (plantronics_t *pla);
 
 
-static
-unsigned char pla_rgb[16][3] = {
-	{ 0x00, 0x00, 0x00 },
-	{ 0x00, 0x00, 0xaa },
-	{ 0x00, 0xaa, 0x00 },
-	{ 0x00, 0xaa, 0xaa },
-	{ 0xaa, 0x00, 0x00 },
-	{ 0xaa, 0x00, 0xaa },
-	{ 0xaa, 0x55, 0x00 },
-	{ 0xaa, 0xaa, 0xaa },
-	{ 0x55, 0x55, 0x55 },
-	{ 0x55, 0x55, 0xff },
-	{ 0x55, 0xff, 0x55 },
-	{ 0x55, 0xff, 0xff },
-	{ 0xff, 0x55, 0x55 },
-	{ 0xff, 0x55, 0xff },
-	{ 0xff, 0xff, 0x55 },
-	{ 0xff, 0xff, 0xff }
+/* the CGA colors as 32 bit terminal pixels, see TRM_XRGB() */
+static
+uint32_t pla_rgb[16] = {
+	0x000000,
+	0x0000aa,
+	0x00aa00,
+	0x00aaaa,
+	0xaa0000,
+	0xaa00aa,
+	0xaa5500,
+	0xaaaaaa,
+	0x555555,
+	0x5555ff,
+	0x55ff55,
+	0x55ffff,
+	0xff5555,
+	0xff55ff,
+	0xffff55,
+	0xffffff
 };
 
 
@@ -102,7 +103,7 @@ void pla_line_blank (plantronics_t *pla, unsigned row)
 
 	ptr = pce_video_get_row_ptr (&pla->video, row);
 
-	memset (ptr, 0, 3 * pla->video.buf_w);
+	memset (ptr, 0, 4 * pla->video.buf_w);
 }
 
 /*
@@ -117,7 +118,8 @@ void pla_line_mode0 (plantronics_t *pla, unsigned row)
 	unsigned char       code, attr;
 	unsigned char       val, mask, cmask;
 	unsigned char       *ptr;
-	const unsigned char *reg, *col, *fg, *bg;
+	uint32_t            fg, bg;
+	const unsigned char *reg;
 	e6845_t             *crt;
 
 	reg = pla->reg;
@@ -168,12 +170,9 @@ void pla_line_mode0 (plantronics_t *pla, unsigned row)
 		mask = 0x80;
 
 		for (j = 0; j < 8; j++) {
-			col = (val & mask) ? fg : bg;
-
-			*(ptr++) = col[0];
-			*(ptr++) = col[1];
-			*(ptr++) = col[2];
+			*(uint32_t *) ptr = (val & mask) ? fg : bg;
 
+			ptr += 4;
 			mask >>= 1;
 		}
 
@@ -187,10 +186,9 @@ void pla_line_mode0 (plantronics_t *pla, unsigned row)
 static
 void pla_line_mode1 (plantronics_t *pla, unsigned row)
 {
-	unsigned            i, j;
-	unsigned            hd, addr, val;
-	unsigned char       *ptr;
-	const unsigned char *col;
+	unsigned      i, j;
+	unsigned      hd, addr, val;
+	unsigned char *ptr;
 
 	hd = e6845_get_hd (&pla->crtc);
 
@@ -208,12 +206,9 @@ void pla_line_mode1 (plantronics_t *pla, unsigned row)
 		val = (val << 8) | pla->mem[(addr + 1) & 0x7fff];
 
 		for (j = 0; j < 8; j++) {
-			col = pla_rgb[pla->pal[(val >> 14) & 3]];
-
-			*(ptr++) = col[0];
-			*(ptr++) = col[1];
-			*(ptr++) = col[2];
+			*(uint32_t *) ptr = pla_rgb[pla->pal[(val >> 14) & 3]];
 
+			ptr += 4;
 			val <<= 2;
 		}
 
@@ -227,10 +222,10 @@ void pla_line_mode1 (plantronics_t *pla, unsigned row)
 static
 void pla_line_mode2 (plantronics_t *pla, unsigned row)
 {
-	unsigned            i, j;
-	unsigned            hd, addr, val;
-	unsigned char       *ptr;
-	const unsigned char *fg, *bg, *col;
+	unsigned      i, j;
+	unsigned      hd, addr, val;
+	unsigned char *ptr;
+	uint32_t      fg, bg;
 
 	hd = e6845_get_hd (&pla->crtc);
 
@@ -251,12 +246,9 @@ void pla_line_mode2 (plantronics_t *pla, unsigned row)
 		val = (val << 8) | pla->mem[(addr + 1) & 0x7fff];
 
 		for (j = 0; j < 16; j++) {
-			col = (val & 0x8000) ? fg : bg;
-
-			*(ptr++) = col[0];
-			*(ptr++) = col[1];
-			*(ptr++) = col[2];
+			*(uint32_t *) ptr = (val & 0x8000) ? fg : bg;
 
+			ptr += 4;
 			val <<= 1;
 		}
 
@@ -270,10 +262,9 @@ void pla_line_mode2 (plantronics_t *pla, unsigned row)
 static
 void pla_line_mode3 (plantronics_t *pla, unsigned row)
 {
-	unsigned            i, j;
-	unsigned            hd, addr, val0, val1, idx;
-	unsigned char       *ptr;
-	const unsigned char *col;
+	unsigned      i, j;
+	unsigned      hd, addr, val0, val1, idx;
+	unsigned char *ptr;
 
 	hd = e6845_get_hd (&pla->crtc);
 
@@ -296,11 +287,10 @@ void pla_line_mode3 (plantronics_t *pla, unsigned row)
 		for (j = 0; j < 8; j++) {
 			idx = ((val1 >> 15) & 1) | ((val0 >> 13) & 2);
 			idx |= ((val0 >> 13) & 4) | ((val1 >> 11) & 8);
-			col = pla_rgb[idx];
 
-			*(ptr++) = col[0];
-			*(ptr++) = col[1];
-			*(ptr++) = col[2];
+			*(uint32_t *) ptr = pla_rgb[idx];
+
+			ptr += 4;
 
 			val0 <<= 2;
 			val1 <<= 2;
@@ -316,10 +306,9 @@ void pla_line_mode3 (plantronics_t *pla, unsigned row)
 static
 void pla_line_mode4 (plantronics_t *pla, unsigned row)
 {
-	unsigned            i, j;
-	unsigned            hd, addr, val0, val1, idx;
-	unsigned char       *ptr;
-	const unsigned char *col;
+	unsigned      i, j;
+	unsigned      hd, addr, val0, val1, idx;
+	unsigned char *ptr;
 
 	hd = e6845_get_hd (&pla->crtc);
 
@@ -342,11 +331,10 @@ void pla_line_mode4 (plantronics_t *pla, unsigned row)
 		for (j = 0; j < 16; j++) {
 			idx = ((val0 >> 15) & 1) | ((val1 >> 14) & 2);
 			idx = pla->pal[idx];
-			col = pla_rgb[idx];
 
-			*(ptr++) = col[0];
-			*(ptr++) = col[1];
-			*(ptr++) = col[2];
+			*(uint32_t *) ptr = pla_rgb[idx];
+
+			ptr += 4;
 
 			val0 <<= 1;
 			val1 <<= 1;
@@ -437,7 +425,7 @@ void pla_vsync (plantronics_t *pla)
 	}
 
 	if ((vid->buf_w != vid->buf_next_w) || (vid->buf_h != vid->buf_next_h)) {
-		pce_video_set_buf_size (vid, vid->buf_next_w, vid->buf_next_h, 3);
+		pce_video_set_buf_size (vid, vid->buf_next_w, vid->buf_next_h, 4);
 		pla->mod_cnt = 1;
 	}
 
@@ -881,6 +869,7 @@ void pla_set_terminal (plantronics_t *pla, terminal_t *trm)
 	pla->term = trm;
 
 	if (pla->term != NULL) {
+		trm_set_bpp (pla->term, 4);
 		trm_open (pla->term, 640, 200);
 	}
 }
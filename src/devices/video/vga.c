@@ -22,6 +22,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <lib/log.h>
 #include <lib/msg.h>
@@ -164,6 +165,19 @@
 
 #define VGA_UPDATE_DIRTY   1
 #define VGA_UPDATE_RETRACE 2
+#define VGA_UPDATE_MEM     4
+
+/* log2 of the number of video memory bytes per dirty flag */
+#define VGA_DIRTY_SHIFT 4
+
+
+/* expand a 4 bit plane mask into a mask for a video memory word */
+static const uint32_t vga_plane_msk[16] = {
+	0x00000000, 0x000000ff, 0x0000ff00, 0x0000ffff,
+	0x00ff0000, 0x00ff00ff, 0x00ffff00, 0x00ffffff,
+	0xff000000, 0xff0000ff, 0xff00ff00, 0xff00ffff,
+	0xffff0000, 0xffff00ff, 0xffffff00, 0xffffffff
+};
 
 
 static void vga_clock (vga_t *vga, unsigned long cnt);
@@ -339,6 +353,19 @@ void vga_get_palette (vga_t *vga, unsigned idx,
 	*b = vga->reg_dac[idx + 2];
 }
 
+/*
+ * Get a palette entry as a 32 bit terminal pixel
+ */
+static
+uint32_t vga_get_xrgb (vga_t *vga, unsigned idx)
+{
+	unsigned char r, g, b;
+
+	vga_get_palette (vga, idx, &r, &g, &b);
+
+	return (TRM_XRGB (r, g, b));
+}
+
 /*
  * Get a transformed CRTC address
  */
@@ -362,6 +389,24 @@ unsigned vga_get_crtc_addr (vga_t *vga, unsigned addr, unsigned row)
 	return (addr);
 }
 
+/*
+ * Get a video memory word
+ */
+static
+uint32_t vga_get_vram (const vga_t *vga, unsigned addr)
+{
+	const unsigned char *p;
+
+	if (vga->lfb_on && ((addr & 3) == 0)) {
+		/* in chain 4 mode, the planes at addr are bytes addr to addr + 3 */
+		p = vga->lfb + addr;
+
+		return (p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24));
+	}
+
+	return (vga->vram[addr]);
+}
+
 /*
  * Set the timing values from the CRT registers
  */
@@ -438,15 +483,39 @@ unsigned long vga_get_dotclock (vga_t *vga)
 	return (clk);
 }
 
+/*
+ * Get the frame duration in microseconds
+ */
+static
+unsigned long vga_get_frame_us (vga_t *vga)
+{
+	unsigned long long clk;
+
+	clk = 1000000ULL * vga->clk_vt;
+
+	if (vga->reg_seq[VGA_SEQ_CLOCK] & VGA_SEQ_CLOCK_DC) {
+		clk *= 2;
+	}
+
+	if (((vga->reg[VGA_MOUT] >> 2) & 3) == 0) {
+		clk /= VGA_PFREQ0;
+	}
+	else {
+		clk /= VGA_PFREQ1;
+	}
+
+	return (clk);
+}
+
 /*
  * Get a pointer to the bitmap for a character
  */
 static
-const unsigned char *vga_get_font (vga_t *vga, unsigned chr, unsigned atr)
+const uint32_t *vga_get_font (vga_t *vga, unsigned chr, unsigned atr)
 {
-	const unsigned char *fnt;
-	unsigned char       sel;
-	unsigned            ofs;
+	const uint32_t *fnt;
+	unsigned char  sel;
+	unsigned       ofs;
 
 	sel = vga->reg_seq[VGA_SEQ_CMAPSEL];
 
@@ -457,7 +526,8 @@ const unsigned char *vga_get_font (vga_t *vga, unsigned chr, unsigned atr)
 		ofs = ((sel << 1) & 0x06) | ((sel >> 4) & 0x01);
 	}
 
-	fnt = vga->mem + 0x20000 + (8192 * ofs) + (32 * (chr & 0xff));
+	/* the font is in plane 2 */
+	fnt = vga->vram + (8192 * ofs) + (32 * (chr & 0xff));
 
 	return (fnt);
 }
@@ -471,7 +541,7 @@ int vga_set_buf_size (vga_t *vga, unsigned w, unsigned h)
 	unsigned long cnt;
 	unsigned char *tmp;
 
-	cnt = 3UL * (unsigned long) w * (unsigned long) h;
+	cnt = 4UL * (unsigned long) w * (unsigned long) h;
 
 	if (cnt > vga->bufmax) {
 		tmp = realloc (vga->buf, cnt);
@@ -483,12 +553,85 @@ int vga_set_buf_size (vga_t *vga, unsigned w, unsigned h)
 		vga->bufmax = cnt;
 	}
 
+	if (h > vga->linemax) {
+		tmp = realloc (vga->line_dirty, h);
+		if (tmp == NULL) {
+			return (1);
+		}
+
+		vga->line_dirty = tmp;
+		vga->linemax = h;
+	}
+
 	vga->buf_w = w;
 	vga->buf_h = h;
 
 	return (0);
 }
 
+/*
+ * Check if any of cnt consecutive CRTC addresses starting at addr
+ * refers to video memory that was modified since the last update
+ */
+static
+int vga_get_cells_dirty (vga_t *vga, unsigned addr, unsigned cnt, unsigned row)
+{
+	unsigned p;
+
+	while (cnt > 0) {
+		p = vga_get_crtc_addr (vga, addr, row);
+
+		if (vga->mem_dirty[p >> VGA_DIRTY_SHIFT]) {
+			return (1);
+		}
+
+		addr = (addr + 1) & 0xffff;
+		cnt -= 1;
+	}
+
+	return (0);
+}
+
+/*
+ * Get the number of character clocks that are fetched after the first
+ * one in a graphics mode scanline
+ */
+static
+unsigned vga_get_line_fetch (unsigned hpp, unsigned w, unsigned cw)
+{
+	if (hpp >= cw) {
+		return (1 + (w - 1) / cw);
+	}
+
+	return ((hpp + w - 1) / cw);
+}
+
+/*
+ * Send the modified lines of the internal buffer to the terminal
+ */
+static
+void vga_set_lines (vga_t *vga)
+{
+	unsigned y, y0;
+
+	y = 0;
+
+	while (y < vga->buf_h) {
+		if (vga->line_dirty[y] == 0) {
+			y += 1;
+			continue;
+		}
+
+		y0 = y;
+
+		while ((y < vga->buf_h) && vga->line_dirty[y]) {
+			y += 1;
+		}
+
+		trm_set_lines (vga->term, vga->buf + 4UL * y0 * vga->buf_w, y0, y - y0);
+	}
+}
+
 /*
  * Draw a character in the internal buffer
  */
@@ -501,8 +644,8 @@ void vga_mode0_update_char (vga_t *vga, unsigned char *dst, unsigned w,
 	unsigned            c1, c2;
 	unsigned            ull;
 	int                 incrs, elg, blk;
-	unsigned char       fg[3], bg[3];
-	const unsigned char *fnt;
+	uint32_t            fg, bg;
+	const uint32_t      *fnt;
 
 	blk = 0;
 
@@ -514,8 +657,8 @@ void vga_mode0_update_char (vga_t *vga, unsigned char *dst, unsigned w,
 		a &= 0x7f;
 	}
 
-	vga_get_palette (vga, a & 0x0f, fg, fg + 1, fg + 2);
-	vga_get_palette (vga, (a >> 4) & 0x0f, bg, bg + 1, bg + 2);
+	fg = vga_get_xrgb (vga, a & 0x0f);
+	bg = vga_get_xrgb (vga, (a >> 4) & 0x0f);
 
 	c1 = vga->reg_crt[VGA_CRT_CS] & 0x1f;
 	c2 = vga->reg_crt[VGA_CRT_CE] & 0x1f;
@@ -548,7 +691,7 @@ void vga_mode0_update_char (vga_t *vga, unsigned char *dst, unsigned w,
 			val = 0xffff;
 		}
 		else {
-			val = fnt[y] << 1;
+			val = ((fnt[y] >> 16) & 0xff) << 1;
 
 			if (elg) {
 				val |= (val >> 1) & 1;
@@ -570,21 +713,50 @@ void vga_mode0_update_char (vga_t *vga, unsigned char *dst, unsigned w,
 		}
 
 		for (x = 0; x < cw; x++) {
-			if (val & 0x100) {
-				dst[3 * x + 0] = fg[0];
-				dst[3 * x + 1] = fg[1];
-				dst[3 * x + 2] = fg[2];
-			}
-			else {
-				dst[3 * x + 0] = bg[0];
-				dst[3 * x + 1] = bg[1];
-				dst[3 * x + 2] = bg[2];
-			}
+			((uint32_t *) dst)[x] = (val & 0x100) ? fg : bg;
 
 			val <<= 1;
 		}
 
-		dst += 3 * w;
+		dst += 4 * w;
+	}
+}
+
+/*
+ * Draw a character in the internal buffer using the glyph cache
+ */
+static
+void vga_mode0_draw_char (vga_t *vga, unsigned char *dst, unsigned w,
+	unsigned cw, unsigned ch, unsigned c, unsigned a, int crs)
+{
+	unsigned      y;
+	int           new;
+	unsigned long key;
+	unsigned char *src;
+
+	src = NULL;
+
+	if (crs == 0) {
+		key = (c & 0xff) | ((a & 0xff) << 8) | ((vga->blink_on != 0) << 16);
+		src = glc_get (&vga->glyph, key, &new);
+	}
+
+	if (src == NULL) {
+		vga_mode0_update_char (vga, dst, w, cw, ch, c, a, crs);
+		return;
+	}
+
+	if (new) {
+		vga_mode0_update_char (vga, src, vga->glyph.w,
+			vga->glyph.w, vga->glyph.h, c, a, 0
+		);
+	}
+
+	for (y = 0; y < ch; y++) {
+		memcpy (dst, src, 4 * cw);
+
+		src += 4 * vga->glyph.w;
+		dst += 4 * w;
 	}
 }
 
@@ -592,13 +764,13 @@ void vga_mode0_update_char (vga_t *vga, unsigned char *dst, unsigned w,
  * Update text mode
  */
 static
-void vga_update_text (vga_t *vga)
+void vga_update_text (vga_t *vga, int all)
 {
 	unsigned            x, y, w, h, cw, ch;
 	unsigned            w2, h2;
 	unsigned            addr, rptr, rofs, p;
-	unsigned            cpos;
-	const unsigned char *src;
+	unsigned            cpos, cnt;
+	const uint32_t      *src;
 	unsigned char       *dst;
 
 	w = vga_get_w (vga);
@@ -610,13 +782,19 @@ void vga_update_text (vga_t *vga)
 		return;
 	}
 
-	src = vga->mem;
+	src = vga->vram;
 	dst = vga->buf;
 
 	addr = vga->latch_addr;
 	rofs = 2 * vga->reg_crt[VGA_CRT_OFS];
 	cpos = vga_get_cursor (vga);
 
+	memset (vga->line_dirty, 0, h);
+
+	glc_set_size (&vga->glyph, cw, ch);
+
+	cnt = (w + cw - 1) / cw;
+
 	y = 0;
 
 	while (y < h) {
@@ -626,11 +804,20 @@ void vga_update_text (vga_t *vga)
 			h2 = ch;
 		}
 
-		dst = vga->buf + 3UL * y * w;
+		dst = vga->buf + 4UL * y * w;
 
 		rptr = addr;
 
-		x = 0;
+		if (all || vga_get_cells_dirty (vga, addr, cnt, 0)) {
+			memset (vga->line_dirty + y, 1, h2);
+			x = 0;
+		}
+		else {
+			/* skip character rows that have not been modified */
+			rptr = (addr + cnt) & 0xffff;
+			x = w;
+		}
+
 		while (x < w) {
 			w2 = w - x;
 
@@ -640,8 +827,8 @@ void vga_update_text (vga_t *vga)
 
 			p = vga_get_crtc_addr (vga, rptr, 0);
 
-			vga_mode0_update_char (vga, dst + 3 * x, w, w2, h2,
-				src[p], src[p + 0x10000], rptr == cpos
+			vga_mode0_draw_char (vga, dst + 4 * x, w, w2, h2,
+				src[p] & 0xff, (src[p] >> 8) & 0xff, rptr == cpos
 			);
 
 			rptr = (rptr + 1) & 0xffff;
@@ -666,18 +853,19 @@ void vga_update_text (vga_t *vga)
  * There's lots of room for optimizations here.
  */
 static
-void vga_update_graphics (vga_t *vga)
+void vga_update_graphics (vga_t *vga, int all)
 {
 	unsigned            x, y, w, h;
 	unsigned            row0, row1, col, cw, ch, dsr;
 	unsigned            addr, rptr, rofs, ptr;
-	unsigned            lcmp, hpp;
+	unsigned            lcmp, hpp, fetch;
 	unsigned char       blink1, blink2;
 	unsigned            msk, bit;
 	unsigned            idx;
 	unsigned char       buf[4];
 	int                 m256, mcga;
-	const unsigned char *src;
+	uint32_t            val;
+	uint32_t            pal[256];
 	unsigned char       *dst;
 
 	w = vga_get_w (vga);
@@ -713,6 +901,8 @@ void vga_update_graphics (vga_t *vga)
 		return;
 	}
 
+	memset (vga->line_dirty, 0, h);
+
 	if (vga->reg_atc[VGA_ATC_MODE] & VGA_ATC_MODE_EB) {
 		blink1 = 0xff;
 		blink2 = vga->blink_on ? 0xff : 0x00;
@@ -724,12 +914,17 @@ void vga_update_graphics (vga_t *vga)
 
 	hpp = vga->latch_hpp;
 
-	src = vga->mem;
 	dst = vga->buf;
 
 	m256 = ((vga->reg_grc[VGA_GRC_MODE] & VGA_GRC_MODE_C256) != 0);
 	mcga = ((vga->reg_grc[VGA_GRC_MODE] & VGA_GRC_MODE_SR) != 0);
 
+	if (m256) {
+		for (idx = 0; idx < 256; idx++) {
+			pal[idx] = vga_get_xrgb (vga, idx);
+		}
+	}
+
 	addr = vga->latch_addr;
 	rofs = 2 * vga->reg_crt[VGA_CRT_OFS];
 
@@ -749,19 +944,31 @@ void vga_update_graphics (vga_t *vga)
 			}
 		}
 
-		dst = vga->buf + 3UL * y * w;
+		dst = vga->buf + 4UL * y * w;
 
 		rptr = addr;
 
+		fetch = vga_get_line_fetch (hpp, w, cw);
+
+		if (all || vga_get_cells_dirty (vga, addr, fetch + 1, row1)) {
+			vga->line_dirty[y] = 1;
+			x = 0;
+		}
+		else {
+			/* skip scanlines that have not been modified */
+			rptr = (addr + fetch) & 0xffff;
+			x = w;
+		}
+
 		col = 0;
-		x = 0;
 
 		ptr = vga_get_crtc_addr (vga, rptr, row1);
 
-		buf[0] = src[ptr + 0x00000];
-		buf[1] = src[ptr + 0x10000];
-		buf[2] = src[ptr + 0x20000];
-		buf[3] = (src[ptr + 0x30000] ^ blink1) | blink2;
+		val = vga_get_vram (vga, ptr);
+		buf[0] = val & 0xff;
+		buf[1] = (val >> 8) & 0xff;
+		buf[2] = (val >> 16) & 0xff;
+		buf[3] = (((val >> 24) & 0xff) ^ blink1) | blink2;
 
 		msk = 0x80 >> (hpp & 7);
 
@@ -774,29 +981,50 @@ void vga_update_graphics (vga_t *vga)
 
 		col = hpp;
 
-		while (x < w) {
+		while (m256 && (x < w)) {
+			/* VGA 256 color mode */
+
 			if (col >= cw) {
 				rptr = (rptr + 1) & 0xffff;
 
 				ptr = vga_get_crtc_addr (vga, rptr, row1);
 
-				buf[0] = src[ptr + 0x00000];
-				buf[1] = src[ptr + 0x10000];
-				buf[2] = src[ptr + 0x20000];
-				buf[3] = (src[ptr + 0x30000] ^ blink1) | blink2;
+				val = vga_get_vram (vga, ptr);
+				buf[0] = val & 0xff;
+				buf[1] = (val >> 8) & 0xff;
+				buf[2] = (val >> 16) & 0xff;
+				buf[3] = (((val >> 24) & 0xff) ^ blink1) | blink2;
 
-				msk = 0x80;
 				bit = 0;
 				col = 0;
 			}
 
-			if (m256) {
-				/* VGA 256 color mode */
+			*(uint32_t *) dst = pal[buf[bit & 3]];
 
-				idx = buf[bit & 3];
-				bit += 1;
+			dst += 4;
+			bit += 1;
+			col += 1;
+			x += 1;
+		}
+
+		while (x < w) {
+			if (col >= cw) {
+				rptr = (rptr + 1) & 0xffff;
+
+				ptr = vga_get_crtc_addr (vga, rptr, row1);
+
+				val = vga_get_vram (vga, ptr);
+				buf[0] = val & 0xff;
+				buf[1] = (val >> 8) & 0xff;
+				buf[2] = (val >> 16) & 0xff;
+				buf[3] = (((val >> 24) & 0xff) ^ blink1) | blink2;
+
+				msk = 0x80;
+				bit = 0;
+				col = 0;
 			}
-			else if (mcga) {
+
+			if (mcga) {
 				/* CGA 4 color mode */
 
 				idx = (buf[0] >> (6 - bit)) & 0x03;
@@ -818,9 +1046,9 @@ void vga_update_graphics (vga_t *vga)
 				msk >>= 1;
 			}
 
-			vga_get_palette (vga, idx, dst, dst + 1, dst + 2);
+			*(uint32_t *) dst = vga_get_xrgb (vga, idx);
 
-			dst += 3;
+			dst += 4;
 			col += 1;
 			x += 1;
 		}
@@ -870,20 +1098,21 @@ void vga_update_blank (vga_t *vga)
 		for (x = 0; x < vga->buf_w; x++) {
 			fx = (x % 16) < 8;
 
-			dst[0] = (fx != fy) ? 0x20 : 0x00;
-			dst[1] = dst[0];
-			dst[2] = dst[0];
+			*(uint32_t *) dst = (fx != fy) ? TRM_XRGB (0x20, 0x20, 0x20) : 0;
 
-			dst += 3;
+			dst += 4;
 		}
 	}
 }
 
 /*
  * Update the internal screen buffer
+ *
+ * If all is false, only lines that refer to modified video memory
+ * are redrawn.
  */
 static
-void vga_update (vga_t *vga)
+void vga_update (vga_t *vga, int all)
 {
 	int      show;
 	unsigned w, h;
@@ -908,15 +1137,16 @@ void vga_update (vga_t *vga)
 
 	if (show == 0) {
 		vga_update_blank (vga);
-		return;
+		memset (vga->line_dirty, 1, vga->buf_h);
 	}
-
-	if (vga->reg_grc[VGA_GRC_MISC] & VGA_GRC_MISC_GM) {
-		vga_update_graphics (vga);
+	else if (vga->reg_grc[VGA_GRC_MISC] & VGA_GRC_MISC_GM) {
+		vga_update_graphics (vga, all);
 	}
 	else {
-		vga_update_text (vga);
+		vga_update_text (vga, all);
 	}
+
+	memset (vga->mem_dirty, 0, sizeof (vga->mem_dirty));
 }
 
 
@@ -968,10 +1198,7 @@ unsigned char vga_mem_get_uint8 (vga_t *vga, unsigned long addr)
 
 	rdmode = (vga->reg_grc[VGA_GRC_MODE] >> 3) & 1;
 
-	vga->latch[0] = vga->mem[addr + 0x00000];
-	vga->latch[1] = vga->mem[addr + 0x10000];
-	vga->latch[2] = vga->mem[addr + 0x20000];
-	vga->latch[3] = vga->mem[addr + 0x30000];
+	vga->latch = vga_get_vram (vga, addr);
 
 	if (rdmode == 0) {
 		unsigned map;
@@ -985,32 +1212,18 @@ unsigned char vga_mem_get_uint8 (vga_t *vga, unsigned long addr)
 			map = (map & 0x02) + (a0 & 1);
 		}
 
-		return (vga->latch[map]);
+		return ((vga->latch >> (8 * map)) & 0xff);
 	}
 	else {
-		unsigned char msk, val, c1, c2;
-
-		val = 0x00;
-		msk = 0x80;
-
-		while (msk != 0) {
-			c1 = (vga->latch[0] & msk) ? 0x01 : 0x00;
-			c1 |= (vga->latch[1] & msk) ? 0x02 : 0x00;
-			c1 |= (vga->latch[2] & msk) ? 0x04 : 0x00;
-			c1 |= (vga->latch[3] & msk) ? 0x08 : 0x00;
-			c1 &= vga->reg_grc[VGA_GRC_CDC];
-
-			c2 = vga->reg_grc[VGA_GRC_COLCMP];
-			c2 &= vga->reg_grc[VGA_GRC_CDC];
-
-			if (c1 == c2) {
-				val |= msk;
-			}
+		uint32_t val;
 
-			msk >>= 1;
-		}
+		/* a bit is set in val for every pixel that does not match */
+		val = vga->latch ^ vga_plane_msk[vga->reg_grc[VGA_GRC_COLCMP] & 0x0f];
+		val &= vga_plane_msk[vga->reg_grc[VGA_GRC_CDC] & 0x0f];
+		val |= val >> 16;
+		val |= val >> 8;
 
-		return (val);
+		return (~val & 0xff);
 	}
 
 	return (0);
@@ -1037,8 +1250,7 @@ void vga_mem_set_uint8 (vga_t *vga, unsigned long addr, unsigned char val)
 	unsigned      wrmode;
 	unsigned      rot;
 	unsigned char mapmsk, bitmsk;
-	unsigned char esr, set;
-	unsigned char col[4];
+	uint32_t      esr, msk, col;
 
 	if ((vga->reg[VGA_MOUT] & VGA_MOUT_ERAM) == 0) {
 		return;
@@ -1089,27 +1301,18 @@ void vga_mem_set_uint8 (vga_t *vga, unsigned long addr, unsigned char val)
 		rot = vga->reg_grc[VGA_GRC_ROTATE] & 7;
 		val = ((val >> rot) | (val << (8 - rot))) & 0xff;
 
-		esr = vga->reg_grc[VGA_GRC_ENABLESR];
-		set = vga->reg_grc[VGA_GRC_SETRESET];
+		esr = vga_plane_msk[vga->reg_grc[VGA_GRC_ENABLESR] & 0x0f];
 
-		col[0] = (esr & 0x01) ? ((set & 0x01) ? 0xff : 0x00) : val;
-		col[1] = (esr & 0x02) ? ((set & 0x02) ? 0xff : 0x00) : val;
-		col[2] = (esr & 0x04) ? ((set & 0x04) ? 0xff : 0x00) : val;
-		col[3] = (esr & 0x08) ? ((set & 0x08) ? 0xff : 0x00) : val;
+		col = (val * 0x01010101UL) & ~esr;
+		col |= vga_plane_msk[vga->reg_grc[VGA_GRC_SETRESET] & 0x0f] & esr;
 		break;
 
 	case 1: /* write mode 1 */
-		col[0] = vga->latch[0];
-		col[1] = vga->latch[1];
-		col[2] = vga->latch[2];
-		col[3] = vga->latch[3];
+		col = vga->latch;
 		break;
 
 	case 2: /* write mode 2 */
-		col[0] = (val & 0x01) ? 0xff : 0x00;
-		col[1] = (val & 0x02) ? 0xff : 0x00;
-		col[2] = (val & 0x04) ? 0xff : 0x00;
-		col[3] = (val & 0x08) ? 0xff : 0x00;
+		col = vga_plane_msk[val & 0x0f];
 		break;
 
 	case 3: /* write mode 3 */
@@ -1118,12 +1321,7 @@ void vga_mem_set_uint8 (vga_t *vga, unsigned long addr, unsigned char val)
 
 		bitmsk &= val;
 
-		set = vga->reg_grc[VGA_GRC_SETRESET];
-
-		col[0] = (set & 0x01) ? 0xff : 0x00;
-		col[1] = (set & 0x02) ? 0xff : 0x00;
-		col[2] = (set & 0x04) ? 0xff : 0x00;
-		col[3] = (set & 0x08) ? 0xff : 0x00;
+		col = vga_plane_msk[vga->reg_grc[VGA_GRC_SETRESET] & 0x0f];
 		break;
 
 	default:
@@ -1137,50 +1335,35 @@ void vga_mem_set_uint8 (vga_t *vga, unsigned long addr, unsigned char val)
 			break;
 
 		case 1: /* and */
-			col[0] &= vga->latch[0];
-			col[1] &= vga->latch[1];
-			col[2] &= vga->latch[2];
-			col[3] &= vga->latch[3];
+			col &= vga->latch;
 			break;
 
 		case 2: /* or */
-			col[0] |= vga->latch[0];
-			col[1] |= vga->latch[1];
-			col[2] |= vga->latch[2];
-			col[3] |= vga->latch[3];
+			col |= vga->latch;
 			break;
 
 		case 3: /* xor */
-			col[0] ^= vga->latch[0];
-			col[1] ^= vga->latch[1];
-			col[2] ^= vga->latch[2];
-			col[3] ^= vga->latch[3];
+			col ^= vga->latch;
 			break;
 		}
 	}
 
-	col[0] = (col[0] & bitmsk) | (vga->latch[0] & ~bitmsk);
-	col[1] = (col[1] & bitmsk) | (vga->latch[1] & ~bitmsk);
-	col[2] = (col[2] & bitmsk) | (vga->latch[2] & ~bitmsk);
-	col[3] = (col[3] & bitmsk) | (vga->latch[3] & ~bitmsk);
+	msk = bitmsk * 0x01010101UL;
+	col = (col & msk) | (vga->latch & ~msk);
 
-	if (mapmsk & 0x01) {
-		vga->mem[addr + 0x00000] = col[0];
-	}
+	msk = vga_plane_msk[mapmsk & 0x0f];
+	vga->vram[addr] = (vga->vram[addr] & ~msk) | (col & msk);
 
-	if (mapmsk & 0x02) {
-		vga->mem[addr + 0x10000] = col[1];
-	}
+	vga->mem_dirty[addr >> VGA_DIRTY_SHIFT] = 1;
 
-	if (mapmsk & 0x04) {
-		vga->mem[addr + 0x20000] = col[2];
+	if ((mapmsk & 0x04) && ((vga->reg_grc[VGA_GRC_MISC] & VGA_GRC_MISC_GM) == 0)) {
+		/* the font is in plane 2 */
+		vga->update_state |= VGA_UPDATE_DIRTY;
+		glc_invalidate (&vga->glyph);
 	}
-
-	if (mapmsk & 0x08) {
-		vga->mem[addr + 0x30000] = col[3];
+	else {
+		vga->update_state |= VGA_UPDATE_MEM;
 	}
-
-	vga->update_state |= VGA_UPDATE_DIRTY;
 }
 
 static
@@ -1195,6 +1378,150 @@ void vga_mem_set_uint16 (vga_t *vga, unsigned long addr, unsigned short val)
 }
 
 
+/*
+ * Check if CPU writes can go directly to the linear frame buffer
+ *
+ * This is the case in chain 4 graphics modes at A000 (mode 13h) if
+ * write mode 0 is used without rotation, set/reset, logical
+ * operations or bit mask.
+ */
+static
+int vga_lfb_possible (const vga_t *vga)
+{
+	if (vga->lfb == NULL) {
+		return (0);
+	}
+
+	if ((vga->reg[VGA_MOUT] & VGA_MOUT_ERAM) == 0) {
+		return (0);
+	}
+
+	if ((vga->reg_seq[VGA_SEQ_MODE] & VGA_SEQ_MODE_CH4) == 0) {
+		return (0);
+	}
+
+	if ((vga->reg_grc[VGA_GRC_MISC] & (VGA_GRC_MISC_MM | VGA_GRC_MISC_GM)) != 0x05) {
+		return (0);
+	}
+
+	if (vga->reg_grc[VGA_GRC_MODE] & VGA_GRC_MODE_WM) {
+		return (0);
+	}
+
+	if (vga->reg_grc[VGA_GRC_ROTATE] & 0x1f) {
+		return (0);
+	}
+
+	if (vga->reg_grc[VGA_GRC_ENABLESR] & 0x0f) {
+		return (0);
+	}
+
+	if (vga->reg_grc[VGA_GRC_BITMASK] != 0xff) {
+		return (0);
+	}
+
+	return (1);
+}
+
+/*
+ * Mark the video memory that was written through the linear frame buffer
+ */
+static
+void vga_lfb_set_dirty (vga_t *vga)
+{
+	unsigned            i, j;
+	const unsigned char *src;
+	unsigned char       *old;
+
+	for (i = 0; i < 65536; i += 1024) {
+		src = vga->lfb + i;
+		old = vga->lfb_old + i;
+
+		if (memcmp (src, old, 1024) == 0) {
+			continue;
+		}
+
+		for (j = 0; j < 1024; j += (1U << VGA_DIRTY_SHIFT)) {
+			if (memcmp (src + j, old + j, 1U << VGA_DIRTY_SHIFT) != 0) {
+				vga->mem_dirty[(i + j) >> VGA_DIRTY_SHIFT] = 1;
+			}
+		}
+
+		memcpy (old, src, 1024);
+
+		vga->update_state |= VGA_UPDATE_MEM;
+	}
+}
+
+/*
+ * Switch to the linear frame buffer
+ *
+ * CPU writes go directly to the memory block data, reads still go
+ * through vga_mem_get_uint8() to load the latches.
+ */
+static
+void vga_lfb_enter (vga_t *vga)
+{
+	unsigned      i;
+	uint32_t      val;
+	unsigned char *p;
+
+	for (i = 0; i < 65536; i += 4) {
+		val = vga->vram[i];
+		p = vga->lfb + i;
+
+		p[0] = val & 0xff;
+		p[1] = (val >> 8) & 0xff;
+		p[2] = (val >> 16) & 0xff;
+		p[3] = (val >> 24) & 0xff;
+	}
+
+	memcpy (vga->lfb_old, vga->lfb, 65536);
+
+	vga->memblk->data = vga->lfb;
+	vga->memblk->set_uint8 = NULL;
+	vga->memblk->set_uint16 = NULL;
+
+	vga->lfb_on = 1;
+}
+
+/*
+ * Copy the linear frame buffer back to the planes
+ */
+static
+void vga_lfb_leave (vga_t *vga)
+{
+	unsigned i;
+
+	vga_lfb_set_dirty (vga);
+
+	for (i = 0; i < 65536; i += 4) {
+		vga->vram[i] = vga_get_vram (vga, i);
+	}
+
+	vga->memblk->data = vga->mem;
+	vga->memblk->set_uint8 = (void *) vga_mem_set_uint8;
+	vga->memblk->set_uint16 = (void *) vga_mem_set_uint16;
+
+	vga->lfb_on = 0;
+}
+
+/*
+ * Leave the linear frame buffer if it can no longer be used
+ *
+ * This is called after every register write that affects CPU
+ * writes. The linear frame buffer is only entered again in the
+ * next vertical retrace.
+ */
+static
+void vga_lfb_check (vga_t *vga)
+{
+	if (vga->lfb_on && (vga_lfb_possible (vga) == 0)) {
+		vga_lfb_leave (vga);
+	}
+}
+
+
 /*
  * Get an attribute controller register
  */
@@ -1225,6 +1552,11 @@ void vga_atc_set_reg (vga_t *vga, unsigned reg, unsigned char val)
 	vga->reg_atc[reg] = val;
 
 	vga->update_state |= VGA_UPDATE_DIRTY;
+
+	if ((reg < 16) || (reg == VGA_ATC_MODE) || (reg == VGA_ATC_CPE) || (reg == VGA_ATC_CS)) {
+		/* the palette and the text attributes */
+		glc_invalidate (&vga->glyph);
+	}
 }
 
 
@@ -1272,10 +1604,12 @@ void vga_seq_set_reg (vga_t *vga, unsigned reg, unsigned char val)
 	case VGA_SEQ_CMAPSEL: /* 3 */
 		vga->reg_seq[VGA_SEQ_CMAPSEL] = val;
 		vga->update_state |= VGA_UPDATE_DIRTY;
+		glc_invalidate (&vga->glyph);
 		break;
 
 	case VGA_SEQ_MODE: /* 4 */
 		vga->reg_seq[VGA_SEQ_MODE] = val;
+		vga_lfb_check (vga);
 		break;
 	}
 }
@@ -1312,7 +1646,10 @@ void vga_grc_set_reg (vga_t *vga, unsigned reg, unsigned char val)
 
 	if (reg == VGA_GRC_MODE) {
 		vga->update_state |= VGA_UPDATE_DIRTY;
+		glc_invalidate (&vga->glyph);
 	}
+
+	vga_lfb_check (vga);
 }
 
 
@@ -1367,6 +1704,10 @@ void vga_crtc_set_reg (vga_t *vga, unsigned reg, unsigned char val)
 	vga_set_timing (vga);
 
 	vga->update_state |= VGA_UPDATE_DIRTY;
+
+	if ((reg == VGA_CRT_MS) || (reg == VGA_CRT_ULL)) {
+		glc_invalidate (&vga->glyph);
+	}
 }
 
 
@@ -1706,6 +2047,7 @@ void vga_set_dac_data (vga_t *vga, unsigned char val)
 	if (vga->reg_dac[vga->dac_addr_write] != val) {
 		vga->reg_dac[vga->dac_addr_write] = val;
 		vga->update_state |= VGA_UPDATE_DIRTY;
+		glc_invalidate (&vga->glyph);
 	}
 
 	vga->dac_addr_write += 1;
@@ -1800,6 +2142,8 @@ void vga_set_misc_out (vga_t *vga, unsigned char val)
 	vga->reg[VGA_MOUT] = val;
 
 	vga->update_state |= VGA_UPDATE_DIRTY;
+
+	vga_lfb_check (vga);
 }
 
 /*
@@ -1900,6 +2244,12 @@ void vga_set_terminal (vga_t *vga, terminal_t *trm)
 {
 	vga->term = trm;
 
+	if (trm != NULL) {
+		trm_set_bpp (trm, 4);
+	}
+
+	vga->update_state |= VGA_UPDATE_DIRTY;
+
 	if (vga->term != NULL) {
 		trm_open (vga->term, 720, 400);
 	}
@@ -1950,10 +2300,11 @@ void vga_print_info (vga_t *vga, FILE *fp)
 		vga->clk_vt, vga->clk_vd
 	);
 
-	fprintf (fp, "MOUT=%02X  ST0=%02X  ST1=%02X\n",
+	fprintf (fp, "MOUT=%02X  ST0=%02X  ST1=%02X  LFB=%d\n",
 		vga->reg[VGA_MOUT],
 		vga->reg[VGA_STATUS0],
-		vga->reg[VGA_STATUS1]
+		vga->reg[VGA_STATUS1],
+		vga->lfb_on
 	);
 
 	vga_print_regs (vga, fp, "CRT", vga->reg_crt, 25);
@@ -1972,7 +2323,7 @@ void vga_redraw (vga_t *vga, int now)
 {
 	if (now) {
 		if (vga->term != NULL) {
-			vga_update (vga);
+			vga_update (vga, 1);
 			trm_set_size (vga->term, vga->buf_w, vga->buf_h);
 			trm_set_lines (vga->term, vga->buf, 0, vga->buf_h);
 			trm_update (vga->term);
@@ -2018,6 +2369,10 @@ void vga_clock (vga_t *vga, unsigned long cnt)
 		return;
 	}
 
+	if ((vga->lfb_on == 0) && vga_lfb_possible (vga)) {
+		vga_lfb_enter (vga);
+	}
+
 	if (vga->blink_cnt > 0) {
 		vga->blink_cnt -= 1;
 
@@ -2034,17 +2389,33 @@ void vga_clock (vga_t *vga, unsigned long cnt)
 		}
 	}
 
-	if (vga->term != NULL) {
+	if (vga->term == NULL) {
+		vga->update_state = VGA_UPDATE_RETRACE;
+	}
+	else if (trm_skip_frame (vga->term, vga_get_frame_us (vga))) {
+		/* keep the update state for the next presented frame */
+		vga->update_state |= VGA_UPDATE_RETRACE;
+	}
+	else {
+		if (vga->lfb_on) {
+			vga_lfb_set_dirty (vga);
+		}
+
 		if (vga->update_state & VGA_UPDATE_DIRTY) {
-			vga_update (vga);
+			vga_update (vga, 1);
 			trm_set_size (vga->term, vga->buf_w, vga->buf_h);
 			trm_set_lines (vga->term, vga->buf, 0, vga->buf_h);
 		}
+		else if (vga->update_state & VGA_UPDATE_MEM) {
+			vga_update (vga, 0);
+			trm_set_size (vga->term, vga->buf_w, vga->buf_h);
+			vga_set_lines (vga);
+		}
 
 		trm_update (vga->term);
-	}
 
-	vga->update_state = VGA_UPDATE_RETRACE;
+		vga->update_state = VGA_UPDATE_RETRACE;
+	}
 
 	if ((vga->reg_crt[VGA_CRT_VRE] & VGA_CRT_VRE_EVI) == 0) {
 		/* vertical retrace interrupt enabled */
@@ -2060,8 +2431,19 @@ void vga_set_irq_fct (vga_t *vga, void *ext, void *fct)
 
 void vga_free (vga_t *vga)
 {
+	if (vga->lfb_on) {
+		vga_lfb_leave (vga);
+	}
+
 	mem_blk_del (vga->memblk);
 	mem_blk_del (vga->regblk);
+
+	glc_free (&vga->glyph);
+
+	free (vga->lfb_old);
+	free (vga->lfb);
+	free (vga->line_dirty);
+	free (vga->buf);
 }
 
 void vga_del (vga_t *vga)
@@ -2104,7 +2486,22 @@ void vga_init (vga_t *vga, unsigned long io, unsigned long addr)
 	vga->memblk->get_uint8 = (void *) vga_mem_get_uint8;
 	vga->memblk->get_uint16 = (void *) vga_mem_get_uint16;
 	vga->mem = vga->memblk->data;
-	mem_blk_clear (vga->memblk, 0x00);
+	vga->vram = (uint32_t *) vga->mem;
+	memset (vga->mem, 0, 256UL * 1024UL);
+
+	/*
+	 * The memory block is 128K but chain 4 mode only uses the first
+	 * 64K. Writes to the second half go to the end of lfb and are
+	 * ignored.
+	 */
+	vga->lfb_on = 0;
+	vga->lfb = malloc (128UL * 1024UL);
+	vga->lfb_old = malloc (64UL * 1024UL);
+
+	if (vga->lfb_old == NULL) {
+		free (vga->lfb);
+		vga->lfb = NULL;
+	}
 
 	vga->regblk = mem_blk_new (io, 0x30, 1);
 	vga->regblk->ext = vga;
@@ -2135,9 +2532,7 @@ void vga_init (vga_t *vga, unsigned long io, unsigned long addr)
 		vga->reg_dac[i] = 0;
 	}
 
-	for (i = 0; i < 4; i++) {
-		vga->latch[i] = 0;
-	}
+	vga->latch = 0;
 
 	vga->latch_addr = 0;
 	vga->latch_hpp = 0;
@@ -2161,9 +2556,18 @@ void vga_init (vga_t *vga, unsigned long io, unsigned long addr)
 
 	vga->bufmax = 0;
 	vga->buf = NULL;
+
 	vga->buf_w = 0;
 	vga->buf_h = 0;
 
+	vga->linemax = 0;
+	vga->line_dirty = NULL;
+
+	glc_init (&vga->glyph, 4096);
+	glc_set_bpp (&vga->glyph, 4);
+
+	memset (vga->mem_dirty, 0, sizeof (vga->mem_dirty));
+
 	vga->update_state = 0;
 
 	vga->set_irq_ext = NULL;
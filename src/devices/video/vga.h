@@ -24,8 +24,11 @@
 #define PCE_VIDEO_VGA_H 1
 
 
+#include <stdint.h>
+
 #include <libini/libini.h>
 #include <drivers/video/terminal.h>
+#include <devices/video/glyph.h>
 #include <devices/video/video.h>
 
 
@@ -37,6 +40,13 @@ typedef struct vga_s {
 	mem_blk_t     *memblk;
 	unsigned char *mem;
 
+	/*
+	 * The video memory, as 64K 32 bit words. Each word contains
+	 * the bytes of the four planes at one address, with plane 0
+	 * in bits 0-7 and plane 3 in bits 24-31.
+	 */
+	uint32_t      *vram;
+
 	mem_blk_t     *regblk;
 	unsigned char *reg;
 
@@ -55,7 +65,8 @@ typedef struct vga_s {
 	unsigned      dac_addr_write;
 	unsigned char dac_state;
 
-	unsigned char latch[4];
+	/* the latches, in the same format as vram */
+	uint32_t      latch;
 
 	char          blink_on;
 	unsigned      blink_cnt;
@@ -72,6 +83,25 @@ typedef struct vga_s {
 	unsigned long bufmax;
 	unsigned char *buf;
 
+	/* one flag per line in buf, set if the line was redrawn */
+	unsigned      linemax;
+	unsigned char *line_dirty;
+
+	/* one flag per 16 bytes of video memory, set if modified */
+	unsigned char mem_dirty[4096];
+
+	/*
+	 * The linear frame buffer for chain 4 mode. While lfb_on is
+	 * set, lfb is the memory block data and contains the chain 4
+	 * view of the planes. lfb_old is the contents at the last
+	 * check for modified video memory.
+	 */
+	int           lfb_on;
+	unsigned char *lfb;
+	unsigned char *lfb_old;
+
+	glyph_cache_t glyph;
+
 	unsigned char update_state;
 
 	void          *set_irq_ext;
@@ -92,6 +92,12 @@ void pce_video_redraw (video_t *vid, int now);
 
 void pce_video_clock1 (video_t *vid, unsigned long cnt);
 
+/*!***************************************************************************
+ * @short Set the internal screen buffer size
+ * @param bpp The bytes per pixel, 3 for RGB or 4 for 32 bit XRGB words
+ *
+ * The buffer format must match the terminal format (see trm_set_bpp()).
+ *****************************************************************************/
 int pce_video_set_buf_size (video_t *vid, unsigned w, unsigned h, unsigned bpp);
 
 unsigned char *pce_video_get_row_ptr (video_t *vid, unsigned row);
@@ -156,7 +156,7 @@ void wy700_line_blank (wy700_t *wy, unsigned row)
 
 	p = pce_video_get_row_ptr (&wy->video, row);
 
-	memset (p, 0, 3 * wy->video.buf_w);
+	memset (p, 0, 4 * wy->video.buf_w);
 }
 
 static
@@ -220,9 +220,8 @@ void wy700_line_text_1 (wy700_t *wy, unsigned row, unsigned ra)
 		for (j = 0; j < 16; j++) {
 			col = (val & 0x8000) ? fg : bg;
 
-			*(ptr++) = col;
-			*(ptr++) = col;
-			*(ptr++) = col;
+			*(uint32_t *) ptr = TRM_XRGB (col, col, col);
+			ptr += 4;
 
 			val <<= 1;
 		}
@@ -285,9 +284,8 @@ void wy700_line_320x200x4 (wy700_t *wy, unsigned row)
 			col = (val >> 8) & 0xc0;
 			col |= (col >> 2) | (col >> 4) | (col >> 6);
 
-			*(ptr++) = col;
-			*(ptr++) = col;
-			*(ptr++) = col;
+			*(uint32_t *) ptr = TRM_XRGB (col, col, col);
+			ptr += 4;
 
 			val <<= 2;
 		}
@@ -302,9 +300,8 @@ void wy700_line_320x200x4 (wy700_t *wy, unsigned row)
 static
 void wy700_line_640x200x2 (wy700_t *wy, unsigned row)
 {
-	unsigned      i, j;
-	unsigned      hd, addr, val;
-	unsigned char col;
+	unsigned      i;
+	unsigned      hd, addr;
 	unsigned char *ptr;
 
 	hd = e6845_get_hd (&wy->crtc);
@@ -320,19 +317,9 @@ void wy700_line_640x200x2 (wy700_t *wy, unsigned row)
 	addr = (wy->crtc.ma ^ ((wy->crtc.ra & 1) << 12)) << 1;
 
 	for (i = 0; i < hd; i++) {
-		val = wy->mem[addr & 0x3fff];
-		val = (val << 8) | wy->mem[(addr + 1) & 0x3fff];
-
-		for (j = 0; j < 16; j++) {
-			col = (val & 0x8000) ? 0xff : 0x00;
-
-			*(ptr++) = col;
-			*(ptr++) = col;
-			*(ptr++) = col;
-
-			val <<= 1;
-		}
+		mono_tab_expand (&wy->mono, ptr, wy->mem + (addr & 0x3fff), 2);
 
+		ptr += 64;
 		addr += 2;
 	}
 }
@@ -343,13 +330,12 @@ void wy700_line_640x200x2 (wy700_t *wy, unsigned row)
 static
 void wy700_update_640x400x2 (wy700_t *wy)
 {
-	unsigned            i, x, y;
+	unsigned            y;
 	unsigned            ofs;
-	unsigned char       val;
 	unsigned char       *dst;
 	const unsigned char *src;
 
-	pce_video_set_buf_size (&wy->video, 640, 400, 3);
+	pce_video_set_buf_size (&wy->video, 640, 400, 4);
 
 	dst = wy->video.buf;
 	ofs = 0;
@@ -358,25 +344,9 @@ void wy700_update_640x400x2 (wy700_t *wy)
 		src = wy->mem + ofs;
 		ofs += 80;
 
-		for (x = 0; x < 80; x++) {
-			val = src[x];
+		mono_tab_expand (&wy->mono, dst, src, 80);
 
-			for (i = 0; i < 8; i++) {
-				if (val & 0x80) {
-					dst[0] = 0xff;
-					dst[1] = 0xff;
-					dst[2] = 0xff;
-				}
-				else {
-					dst[0] = 0x00;
-					dst[1] = 0x00;
-					dst[2] = 0x00;
-				}
-
-				val <<= 1;
-				dst += 3;
-			}
-		}
+		dst += 32 * 80;
 	}
 }
 
@@ -392,7 +362,7 @@ void wy700_update_320x400x4 (wy700_t *wy)
 	unsigned char       *dst;
 	const unsigned char *src;
 
-	pce_video_set_buf_size (&wy->video, 320, 400, 3);
+	pce_video_set_buf_size (&wy->video, 320, 400, 4);
 
 	dst = wy->video.buf;
 	ofs = 0;
@@ -409,12 +379,10 @@ void wy700_update_320x400x4 (wy700_t *wy)
 				col |= col >> 2;
 				col |= col >> 4;
 
-				dst[0] = col;
-				dst[1] = col;
-				dst[2] = col;
+				*(uint32_t *) dst = TRM_XRGB (col, col, col);
 
 				val <<= 2;
-				dst += 3;
+				dst += 4;
 			}
 		}
 	}
@@ -426,13 +394,12 @@ void wy700_update_320x400x4 (wy700_t *wy)
 static
 void wy700_update_1280x400x2 (wy700_t *wy)
 {
-	unsigned            i, x, y;
+	unsigned            y;
 	unsigned            ofs;
-	unsigned char       val;
 	unsigned char       *dst;
 	const unsigned char *src;
 
-	pce_video_set_buf_size (&wy->video, 1280, 400, 3);
+	pce_video_set_buf_size (&wy->video, 1280, 400, 4);
 
 	dst = wy->video.buf;
 	ofs = 0;
@@ -441,25 +408,9 @@ void wy700_update_1280x400x2 (wy700_t *wy)
 		src = wy->mem + ofs;
 		ofs += 160;
 
-		for (x = 0; x < 160; x++) {
-			val = src[x];
+		mono_tab_expand (&wy->mono, dst, src, 160);
 
-			for (i = 0; i < 8; i++) {
-				if (val & 0x80) {
-					dst[0] = 0xff;
-					dst[1] = 0xff;
-					dst[2] = 0xff;
-				}
-				else {
-					dst[0] = 0x00;
-					dst[1] = 0x00;
-					dst[2] = 0x00;
-				}
-
-				val <<= 1;
-				dst += 3;
-			}
-		}
+		dst += 32 * 160;
 	}
 }
 
@@ -475,7 +426,7 @@ void wy700_update_640x400x4 (wy700_t *wy)
 	unsigned char       *dst;
 	const unsigned char *src;
 
-	pce_video_set_buf_size (&wy->video, 640, 400, 3);
+	pce_video_set_buf_size (&wy->video, 640, 400, 4);
 
 	dst = wy->video.buf;
 	ofs = 0;
@@ -492,12 +443,10 @@ void wy700_update_640x400x4 (wy700_t *wy)
 				col |= col >> 2;
 				col |= col >> 4;
 
-				dst[0] = col;
-				dst[1] = col;
-				dst[2] = col;
+				*(uint32_t *) dst = TRM_XRGB (col, col, col);
 
 				val <<= 2;
-				dst += 3;
+				dst += 4;
 			}
 		}
 	}
@@ -509,13 +458,12 @@ void wy700_update_640x400x4 (wy700_t *wy)
 static
 void wy700_update_1280x800x2 (wy700_t *wy)
 {
-	unsigned            i, x, y;
+	unsigned            y;
 	unsigned            ofs;
-	unsigned char       val;
 	unsigned char       *dst;
 	const unsigned char *src;
 
-	pce_video_set_buf_size (&wy->video, 1280, 800, 3);
+	pce_video_set_buf_size (&wy->video, 1280, 800, 4);
 
 	dst = wy->video.buf;
 	ofs = 0;
@@ -528,25 +476,9 @@ void wy700_update_1280x800x2 (wy700_t *wy)
 			ofs += 160;
 		}
 
-		for (x = 0; x < 160; x++) {
-			val = src[x];
+		mono_tab_expand (&wy->mono, dst, src, 160);
 
-			for (i = 0; i < 8; i++) {
-				if (val & 0x80) {
-					dst[0] = 0xff;
-					dst[1] = 0xff;
-					dst[2] = 0xff;
-				}
-				else {
-					dst[0] = 0x00;
-					dst[1] = 0x00;
-					dst[2] = 0x00;
-				}
-
-				val <<= 1;
-				dst += 3;
-			}
-		}
+		dst += 32 * 160;
 	}
 }
 
@@ -562,7 +494,7 @@ void wy700_update_640x800x4 (wy700_t *wy)
 	unsigned char       *dst;
 	const unsigned char *src;
 
-	pce_video_set_buf_size (&wy->video, 640, 800, 3);
+	pce_video_set_buf_size (&wy->video, 640, 800, 4);
 
 	dst = wy->video.buf;
 	ofs = 0;
@@ -583,12 +515,10 @@ void wy700_update_640x800x4 (wy700_t *wy)
 				col |= col >> 2;
 				col |= col >> 4;
 
-				dst[0] = col;
-				dst[1] = col;
-				dst[2] = col;
+				*(uint32_t *) dst = TRM_XRGB (col, col, col);
 
 				val <<= 2;
-				dst += 3;
+				dst += 4;
 			}
 		}
 	}
@@ -710,7 +640,7 @@ void wy700_vsync (wy700_t *wy)
 	}
 
 	if ((vid->buf_w != vid->buf_next_w) || (vid->buf_h != vid->buf_next_h)) {
-		pce_video_set_buf_size (vid, vid->buf_next_w, vid->buf_next_h, 3);
+		pce_video_set_buf_size (vid, vid->buf_next_w, vid->buf_next_h, 4);
 		wy->mod_cnt = 2;
 	}
 
@@ -1130,6 +1060,7 @@ void wy700_set_terminal (wy700_t *wy, terminal_t *trm)
 	wy->term = trm;
 
 	if (wy->term != NULL) {
+		trm_set_bpp (wy->term, 4);
 		trm_open (wy->term, 1280, 800);
 	}
 }
@@ -1149,6 +1080,9 @@ mem_blk_t *wy700_get_reg (wy700_t *wy)
 static
 void wy700_init (wy700_t *wy, unsigned long io, unsigned long addr)
 {
+	static const unsigned char black[3] = { 0x00, 0x00, 0x00 };
+	static const unsigned char white[3] = { 0xff, 0xff, 0xff };
+
 	pce_video_init (&wy->video);
 
 	wy->video.ext = wy;
@@ -1179,6 +1113,8 @@ void wy700_init (wy700_t *wy, unsigned long io, unsigned long addr)
 
 	wy->term = NULL;
 	wy->font = wy700_font_thick;
+
+	mono_tab_init (&wy->mono, black, white);
 	wy->clock1 = 0;
 	wy->clock2 = 0;
 
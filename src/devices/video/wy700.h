@@ -28,6 +28,7 @@
 #include <chipset/e6845.h>
 #include <devices/memory.h>
 #include <devices/video/video.h>
+#include <drivers/video/mono.h>
 #include <drivers/video/terminal.h>
 #include <libini/libini.h>
 
@@ -45,6 +46,7 @@ typedef struct {
 	terminal_t          *term;
 
 	const unsigned char *font;
+	mono_tab_t          mono;
 
 	unsigned long       clock1;
 	unsigned long       clock2;
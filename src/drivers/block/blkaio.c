@@ -0,0 +1,406 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/drivers/block/blkaio.c                                   *
+ * Created:     2026-10-19 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#include "blkaio.h"
+
+#include <stdlib.h>
+
+#ifdef PCE_ENABLE_PTHREAD
+#include <pthread.h>
+#endif
+
+
+#if defined (__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 7)))
+#define dsk_aio_load(p) __atomic_load_n ((p), __ATOMIC_ACQUIRE)
+#define dsk_aio_store(p, v) __atomic_store_n ((p), (v), __ATOMIC_RELEASE)
+#else
+#define dsk_aio_load(p) (*(volatile unsigned long *) (p))
+#define dsk_aio_store(p, v) (*(volatile unsigned long *) (p) = (v))
+#endif
+
+
+#ifdef PCE_ENABLE_PTHREAD
+
+/*
+ * There is a single worker thread for all disks. It is started when
+ * the first request for an asynchronous disk is submitted.
+ *
+ * aio_state is 0 before the worker is started, 1 while it is running
+ * and 2 if there is no worker. Without a worker, requests are executed
+ * synchronously.
+ */
+
+static int             aio_state = 0;
+static int             aio_stop = 0;
+static pthread_t       aio_thread;
+static pthread_mutex_t aio_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  aio_work = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  aio_done = PTHREAD_COND_INITIALIZER;
+
+static dsk_aio_t       *aio_head = NULL;
+static dsk_aio_t       *aio_tail = NULL;
+static dsk_aio_t       *aio_cur = NULL;
+
+/* the number of queued and running requests */
+static unsigned long   aio_pending = 0;
+
+#endif
+
+
+/*
+ * Execute a request. The disk functions are called directly because
+ * dsk_read_lba() and dsk_write_lba() would wait for this very request.
+ */
+static
+int dsk_aio_run (dsk_aio_t *req)
+{
+	disk_t *dsk;
+
+	dsk = req->dsk;
+
+	if (req->write) {
+		if (dsk->write == NULL) {
+			return (1);
+		}
+
+		return (dsk->write (dsk, req->buf, req->blk, req->cnt));
+	}
+
+	if (dsk->read == NULL) {
+		return (1);
+	}
+
+	return (dsk->read (dsk, req->buf, req->blk, req->cnt));
+}
+
+#ifdef PCE_ENABLE_PTHREAD
+
+static
+void *dsk_aio_thread (void *arg)
+{
+	dsk_aio_t *req;
+
+	pthread_mutex_lock (&aio_mutex);
+
+	while (1) {
+		while ((aio_head == NULL) && (aio_stop == 0)) {
+			pthread_cond_wait (&aio_work, &aio_mutex);
+		}
+
+		if (aio_head == NULL) {
+			break;
+		}
+
+		req = aio_head;
+		aio_head = req->next;
+
+		if (aio_head == NULL) {
+			aio_tail = NULL;
+		}
+
+		aio_cur = req;
+
+		pthread_mutex_unlock (&aio_mutex);
+
+		req->result = dsk_aio_run (req);
+
+		pthread_mutex_lock (&aio_mutex);
+
+		aio_cur = NULL;
+
+		dsk_aio_store (&aio_pending, aio_pending - 1);
+		dsk_aio_store (&req->state, DSK_AIO_DONE);
+
+		pthread_cond_broadcast (&aio_done);
+	}
+
+	pthread_mutex_unlock (&aio_mutex);
+
+	return (NULL);
+}
+
+static
+void dsk_aio_stop (void)
+{
+	if (aio_state != 1) {
+		return;
+	}
+
+	pthread_mutex_lock (&aio_mutex);
+	aio_stop = 1;
+	pthread_cond_broadcast (&aio_work);
+	pthread_mutex_unlock (&aio_mutex);
+
+	pthread_join (aio_thread, NULL);
+
+	aio_state = 2;
+}
+
+/*
+ * Wait until all requests have completed before the process forks and
+ * keep the worker idle until the fork is done.
+ */
+static
+void dsk_aio_fork_prepare (void)
+{
+	pthread_mutex_lock (&aio_mutex);
+
+	while (aio_pending > 0) {
+		pthread_cond_wait (&aio_done, &aio_mutex);
+	}
+}
+
+static
+void dsk_aio_fork_parent (void)
+{
+	pthread_mutex_unlock (&aio_mutex);
+}
+
+/*
+ * The worker doesn't exist in the child. Its condition variables may
+ * still count it as a waiter, so no new worker is started there.
+ */
+static
+void dsk_aio_fork_child (void)
+{
+	aio_state = 2;
+	aio_stop = 0;
+
+	aio_head = NULL;
+	aio_tail = NULL;
+	aio_cur = NULL;
+
+	aio_pending = 0;
+
+	pthread_mutex_unlock (&aio_mutex);
+}
+
+/*
+ * Start the worker thread if necessary. Returns non-zero if there
+ * is no worker thread.
+ */
+static
+int dsk_aio_start (void)
+{
+	if (aio_state == 0) {
+		aio_state = 2;
+
+		if (pthread_create (&aio_thread, NULL, dsk_aio_thread, NULL) == 0) {
+			aio_state = 1;
+
+			atexit (dsk_aio_stop);
+
+			pthread_atfork (dsk_aio_fork_prepare, dsk_aio_fork_parent,
+				dsk_aio_fork_child
+			);
+		}
+	}
+
+	return (aio_state != 1);
+}
+
+static
+int dsk_aio_pending (const disk_t *dsk)
+{
+	dsk_aio_t *req;
+
+	if ((aio_cur != NULL) && (aio_cur->dsk == dsk)) {
+		return (1);
+	}
+
+	req = aio_head;
+
+	while (req != NULL) {
+		if (req->dsk == dsk) {
+			return (1);
+		}
+
+		req = req->next;
+	}
+
+	return (0);
+}
+
+#endif
+
+void dsk_aio_init (dsk_aio_t *req)
+{
+	req->dsk = NULL;
+	req->write = 0;
+	req->buf = NULL;
+	req->blk = 0;
+	req->cnt = 0;
+	req->result = 0;
+	req->state = DSK_AIO_IDLE;
+	req->ext = NULL;
+	req->done = NULL;
+	req->next = NULL;
+}
+
+static
+int dsk_aio_submit (dsk_aio_t *req)
+{
+	if (req->state != DSK_AIO_IDLE) {
+		return (1);
+	}
+
+	req->result = 0;
+	req->next = NULL;
+
+#ifdef PCE_ENABLE_PTHREAD
+	if (dsk_get_async (req->dsk) && (dsk_aio_start () == 0)) {
+		pthread_mutex_lock (&aio_mutex);
+
+		if (aio_tail == NULL) {
+			aio_head = req;
+		}
+		else {
+			aio_tail->next = req;
+		}
+
+		aio_tail = req;
+
+		dsk_aio_store (&aio_pending, aio_pending + 1);
+		dsk_aio_store (&req->state, DSK_AIO_BUSY);
+
+		pthread_cond_broadcast (&aio_work);
+		pthread_mutex_unlock (&aio_mutex);
+
+		return (0);
+	}
+#endif
+
+	dsk_aio_sync (req->dsk);
+
+	req->result = dsk_aio_run (req);
+
+	if (req->done != NULL) {
+		req->done (req->ext, req);
+	}
+
+	return (0);
+}
+
+int dsk_aio_read (dsk_aio_t *req, disk_t *dsk, void *buf, uint32_t blk, uint32_t cnt,
+	dsk_aio_f fct, void *ext)
+{
+	if (req->state != DSK_AIO_IDLE) {
+		return (1);
+	}
+
+	req->dsk = dsk;
+	req->write = 0;
+	req->buf = buf;
+	req->blk = blk;
+	req->cnt = cnt;
+	req->ext = ext;
+	req->done = fct;
+
+	return (dsk_aio_submit (req));
+}
+
+int dsk_aio_write (dsk_aio_t *req, disk_t *dsk, const void *buf, uint32_t blk, uint32_t cnt,
+	dsk_aio_f fct, void *ext)
+{
+	if (req->state != DSK_AIO_IDLE) {
+		return (1);
+	}
+
+	req->dsk = dsk;
+	req->write = 1;
+	req->buf = (void *) buf;
+	req->blk = blk;
+	req->cnt = cnt;
+	req->ext = ext;
+	req->done = fct;
+
+	return (dsk_aio_submit (req));
+}
+
+int dsk_aio_busy (const dsk_aio_t *req)
+{
+	return (dsk_aio_load (&req->state) != DSK_AIO_IDLE);
+}
+
+void dsk_aio_check (dsk_aio_t *req)
+{
+	if (dsk_aio_load (&req->state) != DSK_AIO_DONE) {
+		return;
+	}
+
+	req->state = DSK_AIO_IDLE;
+
+	if (req->done != NULL) {
+		req->done (req->ext, req);
+	}
+}
+
+void dsk_aio_cancel (dsk_aio_t *req)
+{
+#ifdef PCE_ENABLE_PTHREAD
+	if (dsk_aio_load (&req->state) == DSK_AIO_BUSY) {
+		pthread_mutex_lock (&aio_mutex);
+
+		while (dsk_aio_load (&req->state) == DSK_AIO_BUSY) {
+			pthread_cond_wait (&aio_done, &aio_mutex);
+		}
+
+		pthread_mutex_unlock (&aio_mutex);
+	}
+#endif
+
+	req->state = DSK_AIO_IDLE;
+}
+
+void dsk_aio_wait (dsk_aio_t *req)
+{
+	if (dsk_aio_load (&req->state) == DSK_AIO_IDLE) {
+		return;
+	}
+
+	dsk_aio_cancel (req);
+
+	if (req->done != NULL) {
+		req->done (req->ext, req);
+	}
+}
+
+void dsk_aio_sync (disk_t *dsk)
+{
+#ifdef PCE_ENABLE_PTHREAD
+	if (dsk_aio_load (&aio_pending) == 0) {
+		return;
+	}
+
+	if ((aio_state == 1) && pthread_equal (pthread_self (), aio_thread)) {
+		return;
+	}
+
+	pthread_mutex_lock (&aio_mutex);
+
+	while (dsk_aio_pending (dsk)) {
+		pthread_cond_wait (&aio_done, &aio_mutex);
+	}
+
+	pthread_mutex_unlock (&aio_mutex);
+#endif
+}
@@ -0,0 +1,125 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/drivers/block/blkaio.h                                   *
+ * Created:     2026-10-19 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#ifndef PCE_DEVICES_BLOCK_BLKAIO_H
+#define PCE_DEVICES_BLOCK_BLKAIO_H 1
+
+
+#include <config.h>
+
+#include <drivers/block/block.h>
+
+#include <stdint.h>
+
+
+#define DSK_AIO_IDLE 0
+#define DSK_AIO_BUSY 1
+#define DSK_AIO_DONE 2
+
+
+struct dsk_aio_s;
+
+typedef void (*dsk_aio_f) (void *ext, struct dsk_aio_s *req);
+
+
+/*!***************************************************************************
+ * @short An asynchronous disk request
+ *
+ * A request is owned by the caller and can be reused once it has
+ * completed. The completion function is always called from the thread
+ * that submitted the request, either directly from dsk_aio_read() or
+ * dsk_aio_write() or later from dsk_aio_check() or dsk_aio_wait().
+ *****************************************************************************/
+typedef struct dsk_aio_s {
+	disk_t           *dsk;
+	int              write;
+	void             *buf;
+	uint32_t         blk;
+	uint32_t         cnt;
+
+	/* zero if successful */
+	int              result;
+
+	unsigned long    state;
+
+	void             *ext;
+	dsk_aio_f        done;
+
+	struct dsk_aio_s *next;
+} dsk_aio_t;
+
+
+void dsk_aio_init (dsk_aio_t *req);
+
+/*!***************************************************************************
+ * @short  Start reading blocks
+ * @param  buf  The buffer, which must stay valid until the request completes
+ * @param  fct  The completion function
+ * @return Zero if the request was accepted, nonzero otherwise
+ *
+ * If the disk is not asynchronous, the blocks are read and fct is
+ * called before this function returns.
+ *****************************************************************************/
+int dsk_aio_read (dsk_aio_t *req, disk_t *dsk, void *buf, uint32_t blk, uint32_t cnt,
+	dsk_aio_f fct, void *ext
+);
+
+/*!***************************************************************************
+ * @short  Start writing blocks
+ * @return Zero if the request was accepted, nonzero otherwise
+ *****************************************************************************/
+int dsk_aio_write (dsk_aio_t *req, disk_t *dsk, const void *buf, uint32_t blk, uint32_t cnt,
+	dsk_aio_f fct, void *ext
+);
+
+/*!***************************************************************************
+ * @short  Check if a request is in progress
+ *****************************************************************************/
+int dsk_aio_busy (const dsk_aio_t *req);
+
+/*!***************************************************************************
+ * @short Call the completion function if a request has completed
+ *
+ * This is meant to be called periodically by the submitting device.
+ *****************************************************************************/
+void dsk_aio_check (dsk_aio_t *req);
+
+/*!***************************************************************************
+ * @short Wait for a request and call its completion function
+ *****************************************************************************/
+void dsk_aio_wait (dsk_aio_t *req);
+
+/*!***************************************************************************
+ * @short Wait for a request without calling its completion function
+ *****************************************************************************/
+void dsk_aio_cancel (dsk_aio_t *req);
+
+/*!***************************************************************************
+ * @short Wait until there are no requests in progress for a disk
+ *
+ * This is used by the blocking disk functions, so that a disk is never
+ * accessed from two threads at the same time.
+ *****************************************************************************/
+void dsk_aio_sync (disk_t *dsk);
+
+
+#endif
@@ -0,0 +1,521 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/drivers/block/blkcache.c                                 *
+ * Created:     2026-10-19 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#include "blkcache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+static
+uint32_t cache_find (const disk_cache_t *cache, uint32_t blk)
+{
+	uint32_t idx;
+
+	idx = cache->hash[blk & cache->hash_mask];
+
+	while (idx != DSK_CACHE_NONE) {
+		if (cache->ent[idx].blk == blk) {
+			return (idx);
+		}
+
+		idx = cache->ent[idx].hnext;
+	}
+
+	return (DSK_CACHE_NONE);
+}
+
+static
+void cache_hash_add (disk_cache_t *cache, uint32_t idx)
+{
+	uint32_t h;
+
+	h = cache->ent[idx].blk & cache->hash_mask;
+
+	cache->ent[idx].hnext = cache->hash[h];
+	cache->hash[h] = idx;
+}
+
+static
+void cache_hash_rmv (disk_cache_t *cache, uint32_t idx)
+{
+	uint32_t *p;
+
+	p = &cache->hash[cache->ent[idx].blk & cache->hash_mask];
+
+	while (*p != DSK_CACHE_NONE) {
+		if (*p == idx) {
+			*p = cache->ent[idx].hnext;
+			return;
+		}
+
+		p = &cache->ent[*p].hnext;
+	}
+}
+
+static
+void cache_lru_unlink (disk_cache_t *cache, uint32_t idx)
+{
+	disk_cache_ent_t *ent;
+
+	ent = &cache->ent[idx];
+
+	if (ent->prev != DSK_CACHE_NONE) {
+		cache->ent[ent->prev].next = ent->next;
+	}
+	else {
+		cache->lru_head = ent->next;
+	}
+
+	if (ent->next != DSK_CACHE_NONE) {
+		cache->ent[ent->next].prev = ent->prev;
+	}
+	else {
+		cache->lru_tail = ent->prev;
+	}
+}
+
+static
+void cache_lru_push (disk_cache_t *cache, uint32_t idx)
+{
+	disk_cache_ent_t *ent;
+
+	ent = &cache->ent[idx];
+
+	ent->prev = DSK_CACHE_NONE;
+	ent->next = cache->lru_head;
+
+	if (cache->lru_head != DSK_CACHE_NONE) {
+		cache->ent[cache->lru_head].prev = idx;
+	}
+	else {
+		cache->lru_tail = idx;
+	}
+
+	cache->lru_head = idx;
+}
+
+static
+void cache_touch (disk_cache_t *cache, uint32_t idx)
+{
+	if (cache->lru_head != idx) {
+		cache_lru_unlink (cache, idx);
+		cache_lru_push (cache, idx);
+	}
+}
+
+static
+int cache_is_dirty (const disk_cache_t *cache, uint32_t blk)
+{
+	uint32_t idx;
+
+	idx = cache_find (cache, blk);
+
+	if (idx == DSK_CACHE_NONE) {
+		return (0);
+	}
+
+	return (cache->ent[idx].dirty != 0);
+}
+
+/*
+ * Write the dirty entry idx to the underlying disk, together with all
+ * dirty neighbours, in a single request.
+ */
+static
+int cache_flush_run (disk_cache_t *cache, uint32_t idx)
+{
+	uint32_t i, n, blk;
+
+	blk = cache->ent[idx].blk;
+	n = 1;
+
+	while ((n < DSK_CACHE_RUN) && (blk > 0) && cache_is_dirty (cache, blk - 1)) {
+		blk -= 1;
+		n += 1;
+	}
+
+	n = 0;
+
+	while (n < DSK_CACHE_RUN) {
+		idx = cache_find (cache, blk + n);
+
+		if ((idx == DSK_CACHE_NONE) || (cache->ent[idx].dirty == 0)) {
+			break;
+		}
+
+		memcpy (cache->wbuf + 512 * n, cache->data + 512 * idx, 512);
+
+		n += 1;
+	}
+
+	if (dsk_write_lba (cache->orig, cache->wbuf, blk, n)) {
+		return (1);
+	}
+
+	for (i = 0; i < n; i++) {
+		cache->ent[cache_find (cache, blk + i)].dirty = 0;
+	}
+
+	return (0);
+}
+
+/*
+ * Get a cache entry for block blk, evicting the least recently used
+ * entry if necessary.
+ */
+static
+uint32_t cache_alloc (disk_cache_t *cache, uint32_t blk)
+{
+	uint32_t idx;
+
+	if (cache->used < cache->cnt) {
+		idx = cache->used;
+		cache->used += 1;
+	}
+	else {
+		idx = cache->lru_tail;
+
+		if (cache->ent[idx].dirty) {
+			if (cache_flush_run (cache, idx)) {
+				return (DSK_CACHE_NONE);
+			}
+		}
+
+		cache_hash_rmv (cache, idx);
+		cache_lru_unlink (cache, idx);
+	}
+
+	cache->ent[idx].blk = blk;
+	cache->ent[idx].dirty = 0;
+
+	cache_hash_add (cache, idx);
+	cache_lru_push (cache, idx);
+
+	return (idx);
+}
+
+/*
+ * Add cnt blocks that were read from the underlying disk. Blocks that
+ * are already cached are newer and are not replaced.
+ */
+static
+void cache_fill (disk_cache_t *cache, const unsigned char *buf, uint32_t blk, uint32_t cnt)
+{
+	uint32_t idx;
+
+	while (cnt > 0) {
+		if (cache_find (cache, blk) == DSK_CACHE_NONE) {
+			idx = cache_alloc (cache, blk);
+
+			if (idx == DSK_CACHE_NONE) {
+				return;
+			}
+
+			memcpy (cache->data + 512 * idx, buf, 512);
+		}
+
+		buf += 512;
+		blk += 1;
+		cnt -= 1;
+	}
+}
+
+/*
+ * Read the blocks following blk into the cache, unless that has
+ * already been done.
+ */
+static
+void cache_read_ahead (disk_cache_t *cache, uint32_t blk)
+{
+	uint32_t n, max;
+
+	if ((cache->ra_cnt == 0) || (blk >= cache->dsk.blocks)) {
+		return;
+	}
+
+	if (cache_find (cache, blk) != DSK_CACHE_NONE) {
+		return;
+	}
+
+	max = cache->dsk.blocks - blk;
+
+	if (max > cache->ra_cnt) {
+		max = cache->ra_cnt;
+	}
+
+	n = 1;
+
+	while ((n < max) && (cache_find (cache, blk + n) == DSK_CACHE_NONE)) {
+		n += 1;
+	}
+
+	if (dsk_read_lba (cache->orig, cache->rbuf, blk, n)) {
+		return;
+	}
+
+	cache_fill (cache, cache->rbuf, blk, n);
+}
+
+static
+int dsk_cache_read (disk_t *dsk, void *buf, uint32_t i, uint32_t n)
+{
+	int           seq;
+	uint32_t      idx, cnt;
+	unsigned char *tmp;
+	disk_cache_t  *cache;
+
+	cache = dsk->ext;
+	tmp = buf;
+
+	if ((i >= dsk->blocks) || (n > (dsk->blocks - i))) {
+		return (1);
+	}
+
+	seq = (i == cache->ra_next);
+
+	while (n > 0) {
+		idx = cache_find (cache, i);
+
+		if (idx != DSK_CACHE_NONE) {
+			memcpy (tmp, cache->data + 512 * idx, 512);
+			cache_touch (cache, idx);
+
+			cnt = 1;
+		}
+		else {
+			cnt = 1;
+
+			while ((cnt < n) && (cache_find (cache, i + cnt) == DSK_CACHE_NONE)) {
+				cnt += 1;
+			}
+
+			if (dsk_read_lba (cache->orig, tmp, i, cnt)) {
+				return (1);
+			}
+
+			cache_fill (cache, tmp, i, cnt);
+		}
+
+		i += cnt;
+		n -= cnt;
+		tmp += 512 * cnt;
+	}
+
+	cache->ra_next = i;
+
+	if (seq) {
+		cache_read_ahead (cache, i);
+	}
+
+	return (0);
+}
+
+static
+int dsk_cache_write (disk_t *dsk, const void *buf, uint32_t i, uint32_t n)
+{
+	uint32_t            idx;
+	const unsigned char *tmp;
+	disk_cache_t        *cache;
+
+	if (dsk->readonly) {
+		return (1);
+	}
+
+	cache = dsk->ext;
+	tmp = buf;
+
+	if ((i >= dsk->blocks) || (n > (dsk->blocks - i))) {
+		return (1);
+	}
+
+	if (cache->writeback == 0) {
+		if (dsk_write_lba (cache->orig, buf, i, n)) {
+			return (1);
+		}
+	}
+
+	while (n > 0) {
+		idx = cache_find (cache, i);
+
+		if (idx == DSK_CACHE_NONE) {
+			idx = cache_alloc (cache, i);
+
+			if (idx == DSK_CACHE_NONE) {
+				return (1);
+			}
+		}
+		else {
+			cache_touch (cache, idx);
+		}
+
+		memcpy (cache->data + 512 * idx, tmp, 512);
+
+		if (cache->writeback) {
+			cache->ent[idx].dirty = 1;
+		}
+
+		i += 1;
+		n -= 1;
+		tmp += 512;
+	}
+
+	return (0);
+}
+
+int dsk_cache_flush (disk_t *dsk)
+{
+	int          r;
+	uint32_t     idx;
+	disk_cache_t *cache;
+
+	cache = dsk->ext;
+
+	r = 0;
+
+	for (idx = 0; idx < cache->used; idx++) {
+		if (cache->ent[idx].dirty) {
+			if (cache_flush_run (cache, idx)) {
+				r = 1;
+			}
+		}
+	}
+
+	return (r);
+}
+
+static
+int dsk_cache_get_msg (disk_t *dsk, const char *msg, char *val, unsigned max)
+{
+	disk_cache_t *cache;
+
+	cache = dsk->ext;
+
+	return (dsk_get_msg (cache->orig, msg, val, max));
+}
+
+static
+int dsk_cache_set_msg (disk_t *dsk, const char *msg, const char *val)
+{
+	disk_cache_t *cache;
+
+	cache = dsk->ext;
+
+	if ((strcmp (msg, "commit") == 0) || (strcmp (msg, "sync") == 0)) {
+		if (dsk_cache_flush (dsk)) {
+			return (1);
+		}
+	}
+
+	return (dsk_set_msg (cache->orig, msg, val));
+}
+
+static
+void dsk_cache_del (disk_t *dsk)
+{
+	disk_cache_t *cache;
+
+	cache = dsk->ext;
+
+	dsk_cache_flush (dsk);
+
+	dsk_del (cache->orig);
+
+	free (cache->hash);
+	free (cache->data);
+	free (cache->ent);
+	free (cache);
+}
+
+disk_t *dsk_cache_new (disk_t *dsk, uint32_t size, int writeback)
+{
+	uint32_t     i, hcnt;
+	disk_cache_t *cache;
+
+	if (size == 0) {
+		return (NULL);
+	}
+
+	if (size > dsk->blocks) {
+		size = dsk->blocks;
+	}
+
+	cache = malloc (sizeof (disk_cache_t));
+
+	if (cache == NULL) {
+		return (NULL);
+	}
+
+	cache->dsk = *dsk;
+
+	dsk_set_type (&cache->dsk, PCE_DISK_CACHE);
+
+	cache->dsk.del = dsk_cache_del;
+	cache->dsk.read = dsk_cache_read;
+	cache->dsk.write = dsk_cache_write;
+	cache->dsk.get_ptr = NULL;
+	cache->dsk.get_msg = dsk_cache_get_msg;
+	cache->dsk.set_msg = dsk_cache_set_msg;
+	cache->dsk.fname = NULL;
+	cache->dsk.ext = cache;
+
+	cache->orig = dsk;
+	cache->writeback = (writeback != 0);
+
+	hcnt = 1;
+	while (hcnt < size) {
+		hcnt *= 2;
+	}
+
+	cache->cnt = size;
+	cache->used = 0;
+	cache->lru_head = DSK_CACHE_NONE;
+	cache->lru_tail = DSK_CACHE_NONE;
+	cache->hash_mask = hcnt - 1;
+
+	cache->ra_cnt = size / 4;
+	cache->ra_next = DSK_CACHE_NONE;
+
+	if (cache->ra_cnt > DSK_CACHE_RUN) {
+		cache->ra_cnt = DSK_CACHE_RUN;
+	}
+
+	cache->ent = malloc ((unsigned long) size * sizeof (disk_cache_ent_t));
+	cache->data = malloc (512 * (unsigned long) size);
+	cache->hash = malloc ((unsigned long) hcnt * sizeof (uint32_t));
+
+	if ((cache->ent == NULL) || (cache->data == NULL) || (cache->hash == NULL)) {
+		free (cache->hash);
+		free (cache->data);
+		free (cache->ent);
+		free (cache);
+		return (NULL);
+	}
+
+	for (i = 0; i < hcnt; i++) {
+		cache->hash[i] = DSK_CACHE_NONE;
+	}
+
+	dsk_set_fname (&cache->dsk, dsk->fname);
+
+	return (&cache->dsk);
+}
@@ -0,0 +1,109 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/drivers/block/blkcache.h                                 *
+ * Created:     2026-10-19 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#ifndef PCE_DEVICES_BLOCK_BLKCACHE_H
+#define PCE_DEVICES_BLOCK_BLKCACHE_H 1
+
+
+#include <config.h>
+
+#include <drivers/block/block.h>
+
+#include <stdint.h>
+
+
+/* the maximum number of blocks that are read or written at once */
+#define DSK_CACHE_RUN 64
+
+#define DSK_CACHE_NONE 0xffffffffUL
+
+
+typedef struct {
+	uint32_t      blk;
+	char          dirty;
+
+	/* the LRU list, head is the most recently used entry */
+	uint32_t      prev;
+	uint32_t      next;
+
+	/* the hash chain */
+	uint32_t      hnext;
+} disk_cache_ent_t;
+
+
+/*!***************************************************************************
+ * @short The block cache disk structure
+ *
+ * A block cache sits on top of another disk. In write-back mode, written
+ * blocks are kept in the cache and are written to the underlying disk
+ * when they are evicted, on commit and when the disk is deleted.
+ *****************************************************************************/
+typedef struct {
+	disk_t           dsk;
+
+	disk_t           *orig;
+
+	int              writeback;
+
+	/* the number of cache entries and the number of entries in use */
+	uint32_t         cnt;
+	uint32_t         used;
+
+	disk_cache_ent_t *ent;
+	unsigned char    *data;
+
+	uint32_t         lru_head;
+	uint32_t         lru_tail;
+
+	uint32_t         hash_mask;
+	uint32_t         *hash;
+
+	/* the read-ahead size in blocks */
+	uint32_t         ra_cnt;
+
+	/* the block following the last read */
+	uint32_t         ra_next;
+
+	unsigned char    rbuf[512 * DSK_CACHE_RUN];
+	unsigned char    wbuf[512 * DSK_CACHE_RUN];
+} disk_cache_t;
+
+
+/*!***************************************************************************
+ * @short  Create a block cache on top of a disk
+ * @param  dsk       The disk to be cached
+ * @param  size      The cache size in blocks
+ * @param  writeback If true, use write-back mode, otherwise write-through
+ * @return The new disk or NULL on error
+ *
+ * On success, the new disk owns dsk.
+ *****************************************************************************/
+disk_t *dsk_cache_new (disk_t *dsk, uint32_t size, int writeback);
+
+/*!***************************************************************************
+ * @short  Write all dirty blocks to the underlying disk
+ * @return Zero if successful, nonzero otherwise
+ *****************************************************************************/
+int dsk_cache_flush (disk_t *dsk);
+
+
+#endif
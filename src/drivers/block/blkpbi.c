@@ -61,18 +61,55 @@ int pbi_write_header (disk_pbi_t *pbi)
 	return (0);
 }
 
+/*
+ * Set the file size. The header is written together with the tables.
+ */
 static
-int pbi_write_file_size (disk_pbi_t *pbi, uint64_t size)
+void pbi_set_file_size (disk_pbi_t *pbi, uint64_t size)
 {
 	pbi->file_size = size;
 
 	dsk_set_uint64_be (pbi->header, 32, size);
 
-	if (pbi_write_header (pbi)) {
-		return (1);
+	pbi->header_modified = 1;
+}
+
+/*
+ * Add the 8 bytes at ofs to the modified range [*min, *max) of a table.
+ */
+static
+void pbi_set_modified (unsigned long *min, unsigned long *max, unsigned long ofs)
+{
+	if (*min >= *max) {
+		*min = ofs;
+		*max = ofs + 8;
 	}
+	else if (ofs < *min) {
+		*min = ofs;
+	}
+	else if ((ofs + 8) > *max) {
+		*max = ofs + 8;
+	}
+}
 
-	return (0);
+static
+void pbi_set_t1 (disk_pbi_t *pbi, unsigned long idx, uint64_t val)
+{
+	dsk_set_uint64_be (pbi->t1, idx << 3, val);
+
+	pbi_set_modified (&pbi->t1_mod_min, &pbi->t1_mod_max, idx << 3);
+
+	pbi->tab_pending += 1;
+}
+
+static
+void pbi_set_t2 (disk_pbi_t *pbi, unsigned long idx, uint64_t val)
+{
+	dsk_set_uint64_be (pbi->t2, idx << 3, val);
+
+	pbi_set_modified (&pbi->t2_mod_min, &pbi->t2_mod_max, idx << 3);
+
+	pbi->tab_pending += 1;
 }
 
 static
@@ -85,46 +122,117 @@ int pbi_read_l1 (disk_pbi_t *pbi)
 	return (0);
 }
 
+/*
+ * Write the modified part of the L1 table. The header is written first,
+ * so that the file size covers every block the table refers to.
+ */
 static
 int pbi_write_l1 (disk_pbi_t *pbi)
 {
-	if (dsk_write (pbi->fp, pbi->t1, pbi->l1_table_offset, pbi->l1_table_size)) {
+	unsigned long min, max;
+
+	min = pbi->t1_mod_min;
+	max = pbi->t1_mod_max;
+
+	if (min >= max) {
+		return (0);
+	}
+
+	if (pbi->header_modified) {
+		if (pbi_write_header (pbi)) {
+			return (1);
+		}
+	}
+
+	if (dsk_write (pbi->fp, pbi->t1 + min, pbi->l1_table_offset + min, max - min)) {
 		return (1);
 	}
 
-	fflush (pbi->fp);
+	pbi->t1_mod_min = 0;
+	pbi->t1_mod_max = 0;
 
 	return (0);
 }
 
+/*
+ * Write the modified part of the current L2 table.
+ */
 static
-int pbi_read_l2 (disk_pbi_t *pbi, uint64_t ofs)
+int pbi_write_l2 (disk_pbi_t *pbi)
 {
-	if (pbi->l2_table_offset == ofs) {
+	unsigned long min, max;
+
+	min = pbi->t2_mod_min;
+	max = pbi->t2_mod_max;
+
+	if (min >= max) {
 		return (0);
 	}
 
-	if (dsk_read (pbi->fp, pbi->t2, ofs, pbi->l2_table_size)) {
+	if (pbi->header_modified) {
+		if (pbi_write_header (pbi)) {
+			return (1);
+		}
+	}
+
+	if (dsk_write (pbi->fp, pbi->t2 + min, pbi->l2_table_offset + min, max - min)) {
 		return (1);
 	}
 
-	pbi->l2_table_offset = ofs;
+	pbi->t2_mod_min = 0;
+	pbi->t2_mod_max = 0;
 
 	return (0);
 }
 
+/*
+ * Write all modified tables. The L2 table is written before the L1
+ * table that refers to it.
+ */
 static
-int pbi_write_l2 (disk_pbi_t *pbi)
+int pbi_write_tables (disk_pbi_t *pbi)
 {
-	if (dsk_write (pbi->fp, pbi->t2, pbi->l2_table_offset, pbi->l2_table_size)) {
+	if (pbi->header_modified) {
+		if (pbi_write_header (pbi)) {
+			return (1);
+		}
+	}
+
+	if (pbi_write_l2 (pbi)) {
 		return (1);
 	}
 
+	if (pbi_write_l1 (pbi)) {
+		return (1);
+	}
+
+	pbi->tab_pending = 0;
+
 	fflush (pbi->fp);
 
 	return (0);
 }
 
+static
+int pbi_read_l2 (disk_pbi_t *pbi, uint64_t ofs)
+{
+	if (pbi->l2_table_offset == ofs) {
+		return (0);
+	}
+
+	if (pbi_write_l2 (pbi)) {
+		return (1);
+	}
+
+	if (dsk_read (pbi->fp, pbi->t2, ofs, pbi->l2_table_size)) {
+		return (1);
+	}
+
+	pbi->l2_table_offset = ofs;
+
+	return (0);
+}
+
 static
 int pbi_read_block (disk_pbi_t *pbi, uint64_t ofs)
 {
@@ -208,23 +316,19 @@ int pbi_alloc_l2 (disk_pbi_t *pbi, uint64_t ofs)
 	l1val = dsk_get_uint64_be (pbi->t1, l1idx << 3);
 
 	if (l1val == 0) {
-		pbi->l2_table_offset = pbi->file_size;
-
-		memset (pbi->t2, 0, pbi->l2_table_size);
-
 		if (pbi_write_l2 (pbi)) {
 			return (1);
 		}
 
-		if (pbi_write_file_size (pbi, pbi->file_size + pbi->l2_table_size)) {
-			return (1);
-		}
+		pbi->l2_table_offset = pbi->file_size;
 
-		dsk_set_uint64_be (pbi->t1, l1idx << 3, pbi->l2_table_offset);
+		memset (pbi->t2, 0, pbi->l2_table_size);
 
-		if (pbi_write_l1 (pbi)) {
-			return (1);
-		}
+		pbi->t2_mod_min = 0;
+		pbi->t2_mod_max = pbi->l2_table_size;
+
+		pbi_set_file_size (pbi, pbi->file_size + pbi->l2_table_size);
+		pbi_set_t1 (pbi, l1idx, pbi->l2_table_offset);
 
 		return (0);
 	}
@@ -323,18 +427,11 @@ int pbi_translate_write (disk_pbi_t *pbi, uint64_t *ofs)
 			return (1);
 		}
 
-		dsk_set_uint64_be (pbi->t2, 8 * l2idx, block_offset);
-
-		if (pbi_write_l2 (pbi)) {
-			return (1);
-		}
+		pbi_set_t2 (pbi, l2idx, block_offset);
+		pbi_set_file_size (pbi, pbi->file_size + pbi->block_size);
 
 		*ofs = block_offset + block_index;
 
-		if (pbi_write_file_size (pbi, pbi->file_size + pbi->block_size)) {
-			return (1);
-		}
-
 		return (0);
 	}
 	else if (l2val & 0x1ff) {
@@ -448,8 +545,8 @@ int pbi_write (disk_t *dsk, const void *buf, uint32_t i, uint32_t n)
 		n -= m;
 	}
 
-	if (pbi->header_modified) {
-		if (pbi_write_header (pbi)) {
+	if (pbi->tab_pending >= PBI_TABLE_BATCH) {
+		if (pbi_write_tables (pbi)) {
 			return (1);
 		}
 	}
@@ -465,6 +562,10 @@ int pbi_commit (disk_pbi_t *pbi)
 	uint64_t      ofs;
 
 	if (pbi->next == NULL) {
+		return (pbi_write_tables (pbi));
+	}
+
+	if (pbi->next_shared) {
 		return (1);
 	}
 
@@ -510,14 +611,17 @@ int pbi_commit (disk_pbi_t *pbi)
 			blki += blkn;
 		}
 
-		dsk_set_uint64_be (pbi->t1, 8 * i, 0);
+		pbi_set_t1 (pbi, i, 0);
 	}
 
-	if (pbi_write_l1 (pbi)) {
-		return (1);
-	}
+	/* the L2 tables are gone */
+	pbi->l2_table_offset = 0;
+	pbi->t2_mod_min = 0;
+	pbi->t2_mod_max = 0;
+
+	pbi_set_file_size (pbi, pbi->l1_table_offset + pbi->l1_table_size);
 
-	if (pbi_write_file_size (pbi, pbi->l1_table_offset + pbi->l1_table_size)) {
+	if (pbi_write_tables (pbi)) {
 		return (1);
 	}
 
@@ -535,8 +639,23 @@ int pbi_get_msg (disk_t *dsk, const char *msg, char *val, unsigned max)
 static
 int pbi_set_msg (disk_t *dsk, const char *msg, const char *val)
 {
+	disk_pbi_t *pbi;
+
+	pbi = dsk->ext;
+
 	if (strcmp (msg, "commit") == 0) {
-		return (pbi_commit (dsk->ext));
+		return (pbi_commit (pbi));
+	}
+	else if (strcmp (msg, "sync") == 0) {
+		if (pbi_write_tables (pbi)) {
+			return (1);
+		}
+
+		if (pbi->next != NULL) {
+			return (dsk_set_msg (pbi->next, msg, val));
+		}
+
+		return (0);
 	}
 
 	return (1);
@@ -549,7 +668,11 @@ void pbi_del (disk_t *dsk)
 
 	pbi = dsk->ext;
 
-	if (pbi->next != NULL) {
+	if (pbi->tab_pending > 0) {
+		pbi_write_tables (pbi);
+	}
+
+	if ((pbi->next != NULL) && (pbi->next_shared == 0)) {
 		dsk_del (pbi->next);
 	}
 
@@ -577,11 +700,7 @@ int dsk_pbi_set_uniform (disk_pbi_t *pbi, uint64_t ofs, unsigned long val)
 	l2idx = (ofs >> pbi->blbits) & pbi->l2_mask;
 	l2val = ((uint64_t) val << 32) | PBI_UNIFORM;
 
-	dsk_set_uint64_be (pbi->t2, l2idx << 3, l2val);
-
-	if (pbi_write_l2 (pbi)) {
-		return (1);
-	}
+	pbi_set_t2 (pbi, l2idx, l2val);
 
 	return (0);
 }
@@ -780,6 +899,7 @@ disk_t *dsk_pbi_open_fp (FILE *fp, int ro)
 	}
 
 	pbi->next = NULL;
+	pbi->next_shared = 0;
 
 	pbi->t1 = NULL;
 	pbi->t2 = NULL;
@@ -787,6 +907,12 @@ disk_t *dsk_pbi_open_fp (FILE *fp, int ro)
 
 	pbi->header_modified = 0;
 
+	pbi->t1_mod_min = 0;
+	pbi->t1_mod_max = 0;
+	pbi->t2_mod_min = 0;
+	pbi->t2_mod_max = 0;
+	pbi->tab_pending = 0;
+
 	pbi->fp = fp;
 
 	if (pbi_parse_header (pbi)) {
@@ -801,6 +927,8 @@ disk_t *dsk_pbi_open_fp (FILE *fp, int ro)
 	pbi->dsk.del = pbi_del;
 	pbi->dsk.read = pbi_read;
 	pbi->dsk.write = pbi_write;
+	pbi->dsk.get_msg = pbi_get_msg;
+	pbi->dsk.set_msg = pbi_set_msg;
 
 	if (pbi_alloc_tables (pbi)) {
 		pbi_del (&pbi->dsk);
@@ -862,9 +990,6 @@ disk_t *dsk_pbi_cow_open (disk_t *dsk, const char *fname)
 	pbi = cow->ext;
 	pbi->next = dsk;
 
-	cow->get_msg = pbi_get_msg;
-	cow->set_msg = pbi_set_msg;
-
 	cow->drive = dsk->drive;
 
 	dsk_set_fname (cow, fname);
@@ -887,6 +1012,19 @@ disk_t *dsk_pbi_cow_create (disk_t *dsk, const char *fname, uint32_t n, uint32_t
 	return (cow);
 }
 
+void dsk_pbi_cow_set_shared (disk_t *dsk, int val)
+{
+	disk_pbi_t *pbi;
+
+	if (dsk->type != PCE_DISK_PBI) {
+		return;
+	}
+
+	pbi = dsk->ext;
+
+	pbi->next_shared = (val != 0);
+}
+
 int dsk_pbi_create_flat_fp (FILE *fp, uint32_t n, uint32_t c, uint16_t h, uint16_t s, uint32_t minblk)
 {
 	unsigned long l1idx, l2idx;
@@ -32,6 +32,10 @@
 #include <stdint.h>
 
 
+/* the number of table changes after which the tables are written */
+#define PBI_TABLE_BATCH 64
+
+
 /*!***************************************************************************
  * @short The PBI image file disk structure
  *****************************************************************************/
@@ -40,6 +44,9 @@ typedef struct {
 
 	disk_t        *next;
 
+	/* if true, next is shared and is neither written nor deleted */
+	char          next_shared;
+
 	unsigned long header_size;
 
 	unsigned char l1bits;
@@ -70,6 +77,18 @@ typedef struct {
 
 	uint64_t      l2_table_offset;
 
+	/*
+	 * The byte ranges of the L1 and L2 tables that were modified but
+	 * not yet written. A range is empty if min >= max.
+	 */
+	unsigned long t1_mod_min;
+	unsigned long t1_mod_max;
+	unsigned long t2_mod_min;
+	unsigned long t2_mod_max;
+
+	/* the number of table changes that were not yet written */
+	unsigned      tab_pending;
+
 	unsigned char *t1;
 	unsigned char *t2;
 	unsigned char *bl;
@@ -85,6 +104,7 @@ disk_t *dsk_pbi_open (const char *fname, int ro);
 
 disk_t *dsk_pbi_cow_open (disk_t *dsk, const char *fname);
 disk_t *dsk_pbi_cow_create (disk_t *dsk, const char *fname, uint32_t n, uint32_t c, uint32_t h, uint32_t s, uint32_t minblk);
+void dsk_pbi_cow_set_shared (disk_t *dsk, int val);
 
 int dsk_pbi_create_flat_fp (FILE *fp, uint32_t n, uint32_t c, uint16_t h, uint16_t s, uint32_t minblk);
 int dsk_pbi_create_flat (const char *fname, uint32_t n, uint32_t c, uint16_t h, uint16_t s, uint32_t minblk);
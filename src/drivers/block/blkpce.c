@@ -58,6 +58,11 @@ int dsk_pce_read (disk_t *dsk, void *buf, uint32_t i, uint32_t n)
 	ofs = img->blk_ofs + 512 * (uint64_t) i;
 	cnt = 512 * (uint64_t) n;
 
+	if (img->map != NULL) {
+		memcpy (buf, img->map + ofs, cnt);
+		return (0);
+	}
+
 	if (dsk_read (img->fp, buf, ofs, cnt)) {
 		return (1);
 	}
@@ -84,6 +89,18 @@ int dsk_pce_write (disk_t *dsk, const void *buf, uint32_t i, uint32_t n)
 	ofs = img->blk_ofs + 512 * (uint64_t) i;
 	cnt = 512 * (uint64_t) n;
 
+	if (img->map != NULL) {
+		if (img->map_ro) {
+			/* the disk was made writable after it was mapped */
+			dsk_unmap (img->map, img->map_size);
+			img->map = NULL;
+		}
+		else if ((ofs + cnt) <= img->map_size) {
+			memcpy (img->map + ofs, buf, cnt);
+			return (0);
+		}
+	}
+
 	if (dsk_write (img->fp, buf, ofs, cnt)) {
 		return (1);
 	}
@@ -93,6 +110,46 @@ int dsk_pce_write (disk_t *dsk, const void *buf, uint32_t i, uint32_t n)
 	return (0);
 }
 
+static
+const void *dsk_pce_get_ptr (disk_t *dsk, uint32_t i, uint32_t n)
+{
+	disk_pce_t *img;
+
+	img = dsk->ext;
+
+	if ((img->map == NULL) || ((i + n) > dsk->blocks)) {
+		return (NULL);
+	}
+
+	return (img->map + img->blk_ofs + 512 * (uint64_t) i);
+}
+
+/*
+ * Map the image file, including the header, into memory
+ */
+static
+int dsk_pce_map (disk_pce_t *img)
+{
+	uint64_t size;
+
+	if (img->map != NULL) {
+		return (0);
+	}
+
+	size = img->blk_ofs + 512 * (uint64_t) img->dsk.blocks;
+
+	img->map = dsk_map (img->fp, size, img->dsk.readonly);
+
+	if (img->map == NULL) {
+		return (1);
+	}
+
+	img->map_size = size;
+	img->map_ro = img->dsk.readonly;
+
+	return (0);
+}
+
 
 static
 int dsk_pce_get_msg (disk_t *dsk, const char *msg, char *val, unsigned max)
@@ -103,9 +160,20 @@ int dsk_pce_get_msg (disk_t *dsk, const char *msg, char *val, unsigned max)
 static
 int dsk_pce_set_msg (disk_t *dsk, const char *msg, const char *val)
 {
-	if (strcmp (msg, "commit") == 0) {
+	disk_pce_t *img;
+
+	img = dsk->ext;
+
+	if ((strcmp (msg, "commit") == 0) || (strcmp (msg, "sync") == 0)) {
+		if (img->map != NULL) {
+			return (dsk_map_sync (img->map, img->map_size));
+		}
+
 		return (0);
 	}
+	else if (strcmp (msg, "mmap") == 0) {
+		return (dsk_pce_map (img));
+	}
 
 	return (1);
 }
@@ -118,6 +186,8 @@ void dsk_pce_del (disk_t *dsk)
 
 	img = dsk->ext;
 
+	dsk_unmap (img->map, img->map_size);
+
 	if (img->fp != NULL) {
 		fclose (img->fp);
 	}
@@ -166,9 +236,14 @@ disk_t *dsk_pce_open_fp (FILE *fp, int ro)
 
 	img->fp = fp;
 
+	img->map = NULL;
+	img->map_size = 0;
+	img->map_ro = 0;
+
 	img->dsk.del = dsk_pce_del;
 	img->dsk.read = dsk_pce_read;
 	img->dsk.write = dsk_pce_write;
+	img->dsk.get_ptr = dsk_pce_get_ptr;
 	img->dsk.get_msg = dsk_pce_get_msg;
 	img->dsk.set_msg = dsk_pce_set_msg;
 
@@ -36,12 +36,17 @@
  * @short The pce image file disk structure
  *****************************************************************************/
 typedef struct {
-	disk_t   dsk;
+	disk_t        dsk;
 
-	FILE     *fp;
+	FILE          *fp;
 
-	uint32_t blk_ofs;
-	uint32_t blk_size;
+	uint32_t      blk_ofs;
+	uint32_t      blk_size;
+
+	/* the memory mapped image file or NULL */
+	unsigned char *map;
+	uint64_t      map_size;
+	char          map_ro;
 } disk_pce_t;
 
 
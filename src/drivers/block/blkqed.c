@@ -431,8 +431,21 @@ int dsk_qed_get_msg (disk_t *dsk, const char *msg, char *val, unsigned max)
 static
 int dsk_qed_set_msg (disk_t *dsk, const char *msg, const char *val)
 {
+	disk_qed_t *qed;
+
+	qed = dsk->ext;
+
 	if (strcmp (msg, "commit") == 0) {
-		return (dsk_qed_commit (dsk->ext));
+		return (dsk_qed_commit (qed));
+	}
+	else if (strcmp (msg, "sync") == 0) {
+		fflush (qed->fp);
+
+		if (qed->next != NULL) {
+			return (dsk_set_msg (qed->next, msg, val));
+		}
+
+		return (0);
 	}
 
 	return (1);
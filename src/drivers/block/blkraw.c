@@ -23,6 +23,7 @@
 #include "blkraw.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 
 static
@@ -40,6 +41,11 @@ int dsk_img_read (disk_t *dsk, void *buf, uint32_t i, uint32_t n)
 	ofs = img->start + 512 * (uint64_t) i;
 	cnt = 512 * (uint64_t) n;
 
+	if ((img->map != NULL) && ((ofs + cnt) <= img->map_size)) {
+		memcpy (buf, img->map + ofs, cnt);
+		return (0);
+	}
+
 	if (dsk_read (img->fp, buf, ofs, cnt)) {
 		return (1);
 	}
@@ -66,6 +72,18 @@ int dsk_img_write (disk_t *dsk, const void *buf, uint32_t i, uint32_t n)
 	ofs = img->start + 512 * (uint64_t) i;
 	cnt = 512 * (uint64_t) n;
 
+	if (img->map != NULL) {
+		if (img->map_ro) {
+			/* the disk was made writable after it was mapped */
+			dsk_unmap (img->map, img->map_size);
+			img->map = NULL;
+		}
+		else if ((ofs + cnt) <= img->map_size) {
+			memcpy (img->map + ofs, buf, cnt);
+			return (0);
+		}
+	}
+
 	if (dsk_write (img->fp, buf, ofs, cnt)) {
 		return (1);
 	}
@@ -75,6 +93,89 @@ int dsk_img_write (disk_t *dsk, const void *buf, uint32_t i, uint32_t n)
 	return (0);
 }
 
+static
+const void *dsk_img_get_ptr (disk_t *dsk, uint32_t i, uint32_t n)
+{
+	disk_img_t *img;
+	uint64_t   ofs, cnt;
+
+	img = dsk->ext;
+
+	if ((img->map == NULL) || ((i + n) > dsk->blocks)) {
+		return (NULL);
+	}
+
+	ofs = img->start + 512 * (uint64_t) i;
+	cnt = 512 * (uint64_t) n;
+
+	if ((ofs + cnt) > img->map_size) {
+		return (NULL);
+	}
+
+	return (img->map + ofs);
+}
+
+/*
+ * Map the image file into memory. The file is mapped read-only if
+ * the disk is read-only, writes to a writable mapping go to the file.
+ */
+static
+int dsk_img_map (disk_img_t *img)
+{
+	uint64_t size;
+
+	if (img->map != NULL) {
+		return (0);
+	}
+
+	size = img->start + 512 * (uint64_t) img->dsk.blocks;
+
+	img->map = dsk_map (img->fp, size, img->dsk.readonly);
+
+	if (img->map == NULL) {
+		return (1);
+	}
+
+	img->map_size = size;
+	img->map_ro = img->dsk.readonly;
+
+	return (0);
+}
+
+static
+int dsk_img_get_msg (disk_t *dsk, const char *msg, char *val, unsigned max)
+{
+	return (1);
+}
+
+static
+int dsk_img_set_msg (disk_t *dsk, const char *msg, const char *val)
+{
+	disk_img_t *img;
+
+	img = dsk->ext;
+
+	if (strcmp (msg, "commit") == 0) {
+		if (img->map == NULL) {
+			return (1);
+		}
+
+		return (dsk_map_sync (img->map, img->map_size));
+	}
+	else if (strcmp (msg, "sync") == 0) {
+		if (img->map != NULL) {
+			return (dsk_map_sync (img->map, img->map_size));
+		}
+
+		return (0);
+	}
+	else if (strcmp (msg, "mmap") == 0) {
+		return (dsk_img_map (img));
+	}
+
+	return (1);
+}
+
 static
 void dsk_img_del (disk_t *dsk)
 {
@@ -82,6 +183,8 @@ void dsk_img_del (disk_t *dsk)
 
 	img = dsk->ext;
 
+	dsk_unmap (img->map, img->map_size);
+
 	fclose (img->fp);
 	free (img);
 }
@@ -106,11 +209,18 @@ disk_t *dsk_img_open_size (FILE *fp, uint32_t n, uint64_t ofs, int ro)
 	img->dsk.del = dsk_img_del;
 	img->dsk.read = dsk_img_read;
 	img->dsk.write = dsk_img_write;
+	img->dsk.get_ptr = dsk_img_get_ptr;
+	img->dsk.get_msg = dsk_img_get_msg;
+	img->dsk.set_msg = dsk_img_set_msg;
 
 	img->start = ofs;
 
 	img->fp = fp;
 
+	img->map = NULL;
+	img->map_size = 0;
+	img->map_ro = 0;
+
 	return (&img->dsk);
 }
 
@@ -38,9 +38,14 @@
 typedef struct {
 	disk_t   dsk;
 
-	FILE     *fp;
+	FILE          *fp;
 
-	uint64_t start;
+	uint64_t      start;
+
+	/* the memory mapped image file or NULL */
+	unsigned char *map;
+	uint64_t      map_size;
+	char          map_ro;
 } disk_img_t;
 
 
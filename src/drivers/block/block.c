@@ -22,6 +22,7 @@
 
 #include <drivers/block/block.h>
 
+#include <drivers/block/blkaio.h>
 #include <drivers/block/blkchd.h>
 #include <drivers/block/blkdosem.h>
 #include <drivers/block/blkpbi.h>
@@ -37,6 +38,11 @@
 
 #include <drivers/psi/psi-img.h>
 
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H)
+#define DSK_USE_MMAP 1
+#include <sys/mman.h>
+#endif
+
 
 uint16_t dsk_get_uint16_be (const void *buf, unsigned i)
 {
@@ -228,6 +234,65 @@ int dsk_set_pos (FILE *fp, uint64_t ofs)
 	return (0);
 }
 
+#if defined(HAVE_PREAD) && defined(HAVE_PWRITE)
+
+/*
+ * Use positioned I/O on the underlying file descriptor. This does not
+ * depend on the file offset, which is shared with other processes
+ * after a fork().
+ */
+
+int dsk_read (FILE *fp, void *buf, uint64_t ofs, uint64_t cnt)
+{
+	ssize_t       r;
+	unsigned char *tmp;
+
+	tmp = buf;
+
+	while (cnt > 0) {
+		r = pread (fileno (fp), tmp, cnt, (off_t) ofs);
+
+		if (r < 0) {
+			return (1);
+		}
+
+		if (r == 0) {
+			memset (tmp, 0x00, cnt);
+			break;
+		}
+
+		tmp += r;
+		ofs += r;
+		cnt -= r;
+	}
+
+	return (0);
+}
+
+int dsk_write (FILE *fp, const void *buf, uint64_t ofs, uint64_t cnt)
+{
+	ssize_t             r;
+	const unsigned char *tmp;
+
+	tmp = buf;
+
+	while (cnt > 0) {
+		r = pwrite (fileno (fp), tmp, cnt, (off_t) ofs);
+
+		if (r <= 0) {
+			return (1);
+		}
+
+		tmp += r;
+		ofs += r;
+		cnt -= r;
+	}
+
+	return (0);
+}
+
+#else
+
 int dsk_read (FILE *fp, void *buf, uint64_t ofs, uint64_t cnt)
 {
 	size_t r;
@@ -262,6 +327,8 @@ int dsk_write (FILE *fp, const void *buf, uint64_t ofs, uint64_t cnt)
 	return (0);
 }
 
+#endif
+
 int dsk_get_filesize (FILE *fp, uint64_t *cnt)
 {
 #ifdef HAVE_FSEEKO
@@ -306,6 +373,60 @@ int dsk_set_filesize (FILE *fp, uint64_t cnt)
 	return (1);
 }
 
+void *dsk_map (FILE *fp, uint64_t size, int ro)
+{
+#ifdef DSK_USE_MMAP
+	void     *ptr;
+	uint64_t cnt;
+
+	if ((size == 0) || ((uint64_t) (size_t) size != size)) {
+		return (NULL);
+	}
+
+	/* accessing a mapping past the end of the file is fatal */
+	if (dsk_get_filesize (fp, &cnt) || (cnt < size)) {
+		return (NULL);
+	}
+
+	fflush (fp);
+
+	if (ro) {
+		ptr = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fileno (fp), 0);
+	}
+	else {
+		ptr = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fileno (fp), 0);
+	}
+
+	if (ptr == MAP_FAILED) {
+		return (NULL);
+	}
+
+	return (ptr);
+#else
+	return (NULL);
+#endif
+}
+
+void dsk_unmap (void *ptr, uint64_t size)
+{
+#ifdef DSK_USE_MMAP
+	if (ptr != NULL) {
+		munmap (ptr, size);
+	}
+#endif
+}
+
+int dsk_map_sync (void *ptr, uint64_t size)
+{
+#ifdef DSK_USE_MMAP
+	if (msync (ptr, size, MS_SYNC) == 0) {
+		return (0);
+	}
+#endif
+
+	return (1);
+}
+
 
 int dsk_adjust_chs (uint32_t *n, uint32_t *c, uint32_t *h, uint32_t *s)
 {
@@ -351,6 +472,7 @@ void dsk_init (disk_t *dsk, void *ext, uint32_t n, uint32_t c, uint32_t h, uint3
 	dsk->del = NULL;
 	dsk->read = NULL;
 	dsk->write = NULL;
+	dsk->get_ptr = NULL;
 	dsk->get_msg = NULL;
 	dsk->set_msg = NULL;
 
@@ -369,6 +491,7 @@ void dsk_init (disk_t *dsk, void *ext, uint32_t n, uint32_t c, uint32_t h, uint3
 	dsk->visible_s = s;
 
 	dsk->readonly = 0;
+	dsk->async = 0;
 
 	dsk->fname = NULL;
 
@@ -380,6 +503,8 @@ void dsk_del (disk_t *dsk)
 	char *tmp;
 
 	if (dsk != NULL) {
+		dsk_aio_sync (dsk);
+
 		tmp = dsk->fname;
 
 		if (dsk->del != NULL) {
@@ -416,6 +541,16 @@ void dsk_set_readonly (disk_t *dsk, int v)
 	dsk->readonly = (v != 0);
 }
 
+int dsk_get_async (const disk_t *dsk)
+{
+	return (dsk->async != 0);
+}
+
+void dsk_set_async (disk_t *dsk, int v)
+{
+	dsk->async = (v != 0);
+}
+
 void dsk_set_fname (disk_t *dsk, const char *fname)
 {
 	if (dsk->fname != NULL) {
@@ -812,6 +947,8 @@ int dsk_get_lba (disk_t *dsk, uint32_t c, uint32_t h, uint32_t s, uint32_t *v)
 
 int dsk_read_lba (disk_t *dsk, void *buf, uint32_t i, uint32_t n)
 {
+	dsk_aio_sync (dsk);
+
 	if (dsk->read != NULL) {
 		return (dsk->read (dsk, buf, i, n));
 	}
@@ -834,6 +971,17 @@ int dsk_read_lbaz (disk_t *dsk, void *buf, uint32_t i, uint32_t n)
 	return (0);
 }
 
+const void *dsk_get_ptr (disk_t *dsk, uint32_t i, uint32_t n)
+{
+	if (dsk->get_ptr == NULL) {
+		return (NULL);
+	}
+
+	dsk_aio_sync (dsk);
+
+	return (dsk->get_ptr (dsk, i, n));
+}
+
 int dsk_read_chs (disk_t *dsk, void *buf,
 	uint32_t c, uint32_t h, uint32_t s, uint32_t n)
 {
@@ -848,6 +996,8 @@ int dsk_read_chs (disk_t *dsk, void *buf,
 
 int dsk_write_lba (disk_t *dsk, const void *buf, uint32_t i, uint32_t n)
 {
+	dsk_aio_sync (dsk);
+
 	if (dsk->write != NULL) {
 		return (dsk->write (dsk, buf, i, n));
 	}
@@ -872,6 +1022,11 @@ int dsk_commit (disk_t *dsk)
 	return (dsk_set_msg (dsk, "commit", NULL));
 }
 
+int dsk_sync (disk_t *dsk)
+{
+	return (dsk_set_msg (dsk, "sync", NULL));
+}
+
 disk_t *dsk_create_cow (disk_t *dsk, const char *name, unsigned long minblk)
 {
 	disk_t     *cow;
@@ -904,6 +1059,8 @@ disk_t *dsk_open_cow (disk_t *dsk, const char *name)
 
 int dsk_get_msg (disk_t *dsk, const char *msg, char *val, unsigned max)
 {
+	dsk_aio_sync (dsk);
+
 	if (dsk->get_msg != NULL) {
 		return (dsk->get_msg (dsk, msg, val, max));
 	}
@@ -913,6 +1070,8 @@ int dsk_get_msg (disk_t *dsk, const char *msg, char *val, unsigned max)
 
 int dsk_set_msg (disk_t *dsk, const char *msg, const char *val)
 {
+	dsk_aio_sync (dsk);
+
 	if (dsk->set_msg != NULL) {
 		if (val == NULL) {
 			val = "";
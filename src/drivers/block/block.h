@@ -45,7 +45,8 @@ enum {
 	PCE_DISK_QED,
 	PCE_DISK_PBI,
 	PCE_DISK_CHD,
-	PCE_DISK_PRI
+	PCE_DISK_PRI,
+	PCE_DISK_CACHE
 };
 
 
@@ -56,6 +57,8 @@ typedef int (*dsk_read_f) (struct disk_s *dsk, void *buf, uint32_t i, uint32_t n
 
 typedef int (*dsk_write_f) (struct disk_s *dsk, const void *buf, uint32_t i, uint32_t n);
 
+typedef const void *(*dsk_get_ptr_f) (struct disk_s *dsk, uint32_t i, uint32_t n);
+
 typedef int (*dsk_get_msg_f) (struct disk_s *dsk, const char *msg, char *val, unsigned max);
 typedef int (*dsk_set_msg_f) (struct disk_s *dsk, const char *msg, const char *val);
 
@@ -69,6 +72,7 @@ typedef struct disk_s {
 	void          (*del) (struct disk_s *dsk);
 	dsk_read_f    read;
 	dsk_write_f   write;
+	dsk_get_ptr_f get_ptr;
 	dsk_get_msg_f get_msg;
 	dsk_set_msg_f set_msg;
 
@@ -86,6 +90,9 @@ typedef struct disk_s {
 
 	char          readonly;
 
+	/* if true, requests through blkaio.h are handled by a thread */
+	char          async;
+
 	char          *fname;
 
 	void          *ext;
@@ -124,6 +131,22 @@ int dsk_write (FILE *fp, const void *buf, uint64_t ofs, uint64_t cnt);
 int dsk_get_filesize (FILE *fp, uint64_t *cnt);
 int dsk_set_filesize (FILE *fp, uint64_t cnt);
 
+/*!***************************************************************************
+ * @short  Map the first size bytes of a file into memory
+ * @param  ro If true, the mapping is read-only, otherwise it is shared
+ *            with the file
+ * @return The mapping or NULL if the file can't be mapped
+ *****************************************************************************/
+void *dsk_map (FILE *fp, uint64_t size, int ro);
+
+void dsk_unmap (void *ptr, uint64_t size);
+
+/*!***************************************************************************
+ * @short  Write a shared mapping back to its file
+ * @return Zero if successful
+ *****************************************************************************/
+int dsk_map_sync (void *ptr, uint64_t size);
+
 int dsk_adjust_chs (uint32_t *n, uint32_t *c, uint32_t *h, uint32_t *s);
 
 /*!***************************************************************************
@@ -162,6 +185,16 @@ int dsk_get_readonly (disk_t *dsk);
  *****************************************************************************/
 void dsk_set_readonly (disk_t *dsk, int v);
 
+/*!***************************************************************************
+ * @short Get the asynchronous flag
+ *****************************************************************************/
+int dsk_get_async (const disk_t *dsk);
+
+/*!***************************************************************************
+ * @short Set the asynchronous flag
+ *****************************************************************************/
+void dsk_set_async (disk_t *dsk, int v);
+
 /*!***************************************************************************
  * @short Set the disk file name
  *****************************************************************************/
@@ -230,6 +263,16 @@ int dsk_read_lba (disk_t *dsk, void *buf, uint32_t i, uint32_t n);
  *****************************************************************************/
 int dsk_read_lbaz (disk_t *dsk, void *buf, uint32_t i, uint32_t n);
 
+/*!***************************************************************************
+ * @short  Get a pointer to blocks
+ * @return A pointer to n blocks starting at block i or NULL
+ *
+ * This is only supported by memory mapped images. If NULL is returned,
+ * the blocks must be read using dsk_read_lba(). The pointer is valid
+ * until the disk is written to or deleted.
+ *****************************************************************************/
+const void *dsk_get_ptr (disk_t *dsk, uint32_t i, uint32_t n);
+
 /*!***************************************************************************
  * @short  Read blocks using CHS addressing
  * @return Zero if successful
@@ -254,6 +297,15 @@ int dsk_write_chs (disk_t *dsk, const void *buf,
 
 int dsk_commit (disk_t *dsk);
 
+/*!***************************************************************************
+ * @short  Write all cached changes to the disk image files
+ * @return Zero if successful
+ *
+ * Unlike dsk_commit(), this does not merge copy on write images into
+ * their base images.
+ *****************************************************************************/
+int dsk_sync (disk_t *dsk);
+
 disk_t *dsk_create_cow (disk_t *dsk, const char *name, unsigned long minblk);
 disk_t *dsk_open_cow (disk_t *dsk, const char *name);
 
@@ -0,0 +1,170 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/drivers/sound/blep.c                                     *
+ * Created:     2026-10-19 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#include <config.h>
+
+#include <math.h>
+
+#include <drivers/sound/blep.h>
+
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* the sum of the kernel taps */
+#define SND_BLEP_ONE 32768
+
+/* the cut-off frequency relative to the output sample rate */
+#define SND_BLEP_CUTOFF 0.45
+
+
+static int  blep_tab_ok = 0;
+static long blep_tab[SND_BLEP_PHASES][SND_BLEP_TAPS];
+
+
+/*
+ * Build the kernel table
+ *
+ * Each phase is a Blackman windowed sinc impulse, shifted by the phase
+ * and scaled to a sum of exactly SND_BLEP_ONE. This guarantees that the
+ * output settles at the exact level after a step.
+ */
+static
+void snd_blep_init_tab (void)
+{
+	unsigned i, j, mid;
+	long     sum;
+	double   x, w, v, fc;
+	double   tmp[SND_BLEP_TAPS];
+	double   dsum;
+
+	fc = 2.0 * SND_BLEP_CUTOFF;
+
+	mid = SND_BLEP_TAPS / 2 - 1;
+
+	for (i = 0; i < SND_BLEP_PHASES; i++) {
+		dsum = 0.0;
+
+		for (j = 0; j < SND_BLEP_TAPS; j++) {
+			x = (double) j - mid - (double) i / SND_BLEP_PHASES;
+
+			if (x == 0.0) {
+				v = 1.0;
+			}
+			else {
+				v = sin (M_PI * fc * x) / (M_PI * fc * x);
+			}
+
+			w = 2.0 * M_PI * x / SND_BLEP_TAPS;
+			w = 0.42 + 0.5 * cos (w) + 0.08 * cos (2.0 * w);
+
+			tmp[j] = v * w;
+			dsum += tmp[j];
+		}
+
+		sum = 0;
+
+		for (j = 0; j < SND_BLEP_TAPS; j++) {
+			blep_tab[i][j] = (long) floor (SND_BLEP_ONE * tmp[j] / dsum + 0.5);
+			sum += blep_tab[i][j];
+		}
+
+		blep_tab[i][mid] += SND_BLEP_ONE - sum;
+	}
+
+	blep_tab_ok = 1;
+}
+
+void snd_blep_init (sound_blep_t *blep, long level)
+{
+	unsigned i;
+
+	if (blep_tab_ok == 0) {
+		snd_blep_init_tab ();
+	}
+
+	blep->level = level;
+	blep->acc = SND_BLEP_ONE * level;
+
+	blep->pos = 0;
+
+	for (i = 0; i < SND_BLEP_BUF; i++) {
+		blep->buf[i] = 0;
+	}
+}
+
+void snd_blep_set_level (sound_blep_t *blep, long level, unsigned frac)
+{
+	unsigned   i, pos;
+	long       delta;
+	const long *tab;
+
+	delta = level - blep->level;
+
+	if (delta == 0) {
+		return;
+	}
+
+	blep->level = level;
+
+	frac = (frac * SND_BLEP_PHASES) >> 16;
+
+	if (frac >= SND_BLEP_PHASES) {
+		frac = SND_BLEP_PHASES - 1;
+	}
+
+	tab = blep_tab[frac];
+
+	pos = blep->pos;
+
+	for (i = 0; i < SND_BLEP_TAPS; i++) {
+		blep->buf[pos] += delta * tab[i];
+		pos = (pos + 1) & (SND_BLEP_BUF - 1);
+	}
+}
+
+long snd_blep_get_sample (sound_blep_t *blep)
+{
+	long val;
+
+	blep->acc += blep->buf[blep->pos];
+	blep->buf[blep->pos] = 0;
+
+	blep->pos = (blep->pos + 1) & (SND_BLEP_BUF - 1);
+
+	if (blep->acc < 0) {
+		val = -((SND_BLEP_ONE / 2 - blep->acc) / SND_BLEP_ONE);
+	}
+	else {
+		val = (blep->acc + SND_BLEP_ONE / 2) / SND_BLEP_ONE;
+	}
+
+	if (val < -32768) {
+		val = -32768;
+	}
+	else if (val > 32767) {
+		val = 32767;
+	}
+
+	return (val);
+}
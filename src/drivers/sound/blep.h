@@ -0,0 +1,74 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/drivers/sound/blep.h                                     *
+ * Created:     2026-10-19 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#ifndef PCE_DRIVERS_SOUND_BLEP_H
+#define PCE_DRIVERS_SOUND_BLEP_H 1
+
+
+/* the length of the step kernel in output samples */
+#define SND_BLEP_TAPS   16
+
+/* the number of sub-sample positions */
+#define SND_BLEP_PHASES 64
+
+/* the size of the delta buffer, a power of 2 >= SND_BLEP_TAPS */
+#define SND_BLEP_BUF    32
+
+
+/*!***************************************************************************
+ * @short A band-limited step synthesizer
+ *
+ * Level changes are added to a delta buffer as band-limited impulses at
+ * their exact sub-sample position. The output is the running sum of the
+ * delta buffer. The output is delayed by SND_BLEP_TAPS / 2 samples.
+ *****************************************************************************/
+typedef struct {
+	long     level;
+	long     acc;
+
+	unsigned pos;
+	long     buf[SND_BLEP_BUF];
+} sound_blep_t;
+
+
+/*!***************************************************************************
+ * @short Initialize a BLEP synthesizer
+ * @param level The initial output level
+ *****************************************************************************/
+void snd_blep_init (sound_blep_t *blep, long level);
+
+/*!***************************************************************************
+ * @short Change the output level
+ * @param level The new output level, in the range -32768 .. 32767
+ * @param frac  The position of the level change between the previous
+ *              output sample (0) and the next output sample (65536)
+ *****************************************************************************/
+void snd_blep_set_level (sound_blep_t *blep, long level, unsigned frac);
+
+/*!***************************************************************************
+ * @short  Get the next output sample
+ * @return The output sample, in the same range as the level
+ *****************************************************************************/
+long snd_blep_get_sample (sound_blep_t *blep);
+
+
+#endif
@@ -0,0 +1,626 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/drivers/sound/edge.c                                     *
+ * Created:     2026-10-19 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#include <config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <drivers/sound/edge.h>
+
+
+#if defined (__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 7)))
+#define snd_edge_load(p) __atomic_load_n ((p), __ATOMIC_ACQUIRE)
+#define snd_edge_store(p, v) __atomic_store_n ((p), (v), __ATOMIC_RELEASE)
+#else
+#define snd_edge_load(p) (*(volatile unsigned long *) (p))
+#define snd_edge_store(p, v) (*(volatile unsigned long *) (p) = (v))
+#endif
+
+#ifndef DEBUG_SND_EDGE
+#define DEBUG_SND_EDGE 0
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+
+#ifdef PCE_ENABLE_PTHREAD
+static pthread_mutex_t snd_edge_list_mutex = PTHREAD_MUTEX_INITIALIZER;
+static sound_edge_t    *snd_edge_list = NULL;
+static int             snd_edge_atfork = 0;
+#endif
+
+
+static
+void snd_edge_play (sound_edge_t *edg)
+{
+	if (edg->buf_cnt == 0) {
+		return;
+	}
+
+	if (edg->lowpass_freq > 0) {
+		snd_iir2_filter (&edg->iir, edg->buf, edg->buf, edg->buf_cnt, 1, 1);
+	}
+
+	snd_write (edg->drv, edg->buf, edg->buf_cnt);
+
+	edg->buf_cnt = 0;
+}
+
+static
+void snd_edge_put_sample (sound_edge_t *edg, long val)
+{
+	if (edg->smooth_freq > 0) {
+		edg->smooth_val += ((long long) (val - edg->smooth_val) * edg->smooth_mul) / 65536;
+		val = edg->smooth_val;
+	}
+
+	edg->buf[edg->buf_cnt++] = val & 0xffff;
+
+	if (edg->buf_cnt >= SND_EDGE_BUF) {
+		snd_edge_play (edg);
+	}
+}
+
+/*
+ * Render samples up to input clock clk
+ */
+static
+void snd_edge_advance (sound_edge_t *edg, unsigned long clk)
+{
+	unsigned long      cnt;
+	unsigned long long tmp;
+
+	cnt = clk - edg->clk;
+	edg->clk = clk;
+
+	tmp = edg->rem + (unsigned long long) edg->srate * cnt;
+
+	edg->rem = tmp % edg->clock;
+	cnt = tmp / edg->clock;
+
+	while (cnt > 0) {
+		snd_edge_put_sample (edg, snd_blep_get_sample (&edg->blep));
+		cnt -= 1;
+	}
+}
+
+static
+void snd_edge_render_start (sound_edge_t *edg, unsigned long clk)
+{
+	unsigned long i;
+
+	edg->clk = clk;
+	edg->rem = 0;
+
+	snd_blep_init (&edg->blep, 0);
+
+	edg->smooth_val = 0;
+
+	/* Fill the sound buffer a bit so we don't underrun immediately */
+	for (i = edg->srate / 8; i > 0; i--) {
+		snd_edge_put_sample (edg, 0);
+	}
+}
+
+static
+void snd_edge_render_stop (sound_edge_t *edg, unsigned long clk)
+{
+	snd_edge_advance (edg, clk);
+	snd_edge_play (edg);
+	snd_iir2_reset (&edg->iir);
+}
+
+/*
+ * Render all queued events
+ */
+static
+void snd_edge_render (sound_edge_t *edg)
+{
+	unsigned long          rd, wr;
+	unsigned               frac;
+	const sound_edge_evt_t *evt;
+
+	rd = edg->rd;
+	wr = snd_edge_load (&edg->wr);
+
+	while (rd != wr) {
+		evt = &edg->evt[rd & (SND_EDGE_QUEUE - 1)];
+
+		switch (evt->type) {
+		case SND_EDGE_LEVEL:
+			snd_edge_advance (edg, evt->clk);
+			frac = ((unsigned long long) edg->rem << 16) / edg->clock;
+			snd_blep_set_level (&edg->blep, evt->level, frac);
+			break;
+
+		case SND_EDGE_SYNC:
+			snd_edge_advance (edg, evt->clk);
+			break;
+
+		case SND_EDGE_START:
+			snd_edge_render_start (edg, evt->clk);
+			break;
+
+		case SND_EDGE_STOP:
+			snd_edge_render_stop (edg, evt->clk);
+			break;
+		}
+
+		rd += 1;
+
+		snd_edge_store (&edg->rd, rd);
+
+		if (rd == wr) {
+			wr = snd_edge_load (&edg->wr);
+		}
+	}
+}
+
+#ifdef PCE_ENABLE_PTHREAD
+
+static
+void *snd_edge_thread (void *ext)
+{
+	sound_edge_t *edg;
+
+	edg = ext;
+
+	pthread_mutex_lock (&edg->mutex);
+
+	while (1) {
+		while ((edg->stop == 0) && (snd_edge_load (&edg->wr) == edg->rd)) {
+			pthread_cond_wait (&edg->cond, &edg->mutex);
+		}
+
+		pthread_mutex_unlock (&edg->mutex);
+
+		snd_edge_render (edg);
+
+		pthread_mutex_lock (&edg->mutex);
+
+		if (edg->stop && (snd_edge_load (&edg->wr) == edg->rd)) {
+			break;
+		}
+	}
+
+	pthread_mutex_unlock (&edg->mutex);
+
+	return (NULL);
+}
+
+#endif
+
+/*
+ * Make the renderer process the queue
+ */
+static
+void snd_edge_wake (sound_edge_t *edg)
+{
+#ifdef PCE_ENABLE_PTHREAD
+	if (edg->thread_ok) {
+		pthread_mutex_lock (&edg->mutex);
+		pthread_cond_broadcast (&edg->cond);
+		pthread_mutex_unlock (&edg->mutex);
+		return;
+	}
+#endif
+
+	snd_edge_render (edg);
+}
+
+static
+void snd_edge_put (sound_edge_t *edg, unsigned type, unsigned long clk, long level)
+{
+	unsigned long    wr;
+	sound_edge_evt_t *evt;
+
+	wr = edg->wr;
+
+	evt = &edg->evt[wr & (SND_EDGE_QUEUE - 1)];
+
+	evt->type = type;
+	evt->clk = clk;
+	evt->level = level;
+
+	snd_edge_store (&edg->wr, wr + 1);
+}
+
+/*
+ * Check if there is room for an event. Level and sync events leave
+ * some room for start and stop events and for the level event that
+ * is inserted after an overrun.
+ */
+static
+int snd_edge_full (sound_edge_t *edg, unsigned type)
+{
+	unsigned long cnt, max;
+
+	cnt = edg->wr - snd_edge_load (&edg->rd);
+
+	if ((type == SND_EDGE_START) || (type == SND_EDGE_STOP)) {
+		max = SND_EDGE_QUEUE - 1;
+	}
+	else {
+		max = SND_EDGE_QUEUE - SND_EDGE_RESERVE;
+	}
+
+	return (cnt >= max);
+}
+
+static
+void snd_edge_push (sound_edge_t *edg, unsigned type, unsigned long clk, long level)
+{
+	unsigned long cnt;
+
+	if (snd_edge_full (edg, type)) {
+		/* the queue is full, let the renderer catch up */
+		snd_edge_wake (edg);
+
+		if (snd_edge_full (edg, type)) {
+			/*
+			 * The renderer thread is too slow. Drop the event,
+			 * the current level is restored with the next event
+			 * that fits.
+			 */
+#if DEBUG_SND_EDGE >= 1
+			if (edg->overrun == 0) {
+				fprintf (stderr, "snd-edge: buffer overrun\n");
+			}
+#endif
+
+			edg->overrun = 1;
+
+			return;
+		}
+	}
+
+	if (edg->overrun) {
+		if ((type != SND_EDGE_LEVEL) && (type != SND_EDGE_START)) {
+			snd_edge_put (edg, SND_EDGE_LEVEL, clk, edg->level);
+		}
+
+		edg->overrun = 0;
+	}
+
+	snd_edge_put (edg, type, clk, level);
+
+	edg->sync_clk = clk;
+
+	cnt = edg->wr - snd_edge_load (&edg->rd);
+
+	if (type == SND_EDGE_LEVEL) {
+		if (cnt < (SND_EDGE_QUEUE / 2)) {
+			return;
+		}
+	}
+	else if (type == SND_EDGE_SYNC) {
+		/* wake up the renderer about every 10 ms */
+		if ((cnt < (SND_EDGE_QUEUE / 2)) && ((clk - edg->wake_clk) < (edg->clock / 100))) {
+			return;
+		}
+	}
+
+	edg->wake_clk = clk;
+
+	snd_edge_wake (edg);
+}
+
+#ifdef PCE_ENABLE_PTHREAD
+/*
+ * Keep the renderers out of their critical sections while the process
+ * forks. The renderer threads don't exist in the child, and the sound
+ * drivers belong to the parent.
+ */
+static
+void snd_edge_fork_prepare (void)
+{
+	sound_edge_t *edg;
+
+	pthread_mutex_lock (&snd_edge_list_mutex);
+
+	edg = snd_edge_list;
+
+	while (edg != NULL) {
+		pthread_mutex_lock (&edg->mutex);
+		edg = edg->next;
+	}
+}
+
+static
+void snd_edge_fork_parent (void)
+{
+	sound_edge_t *edg;
+
+	edg = snd_edge_list;
+
+	while (edg != NULL) {
+		pthread_mutex_unlock (&edg->mutex);
+		edg = edg->next;
+	}
+
+	pthread_mutex_unlock (&snd_edge_list_mutex);
+}
+
+static
+void snd_edge_fork_child (void)
+{
+	sound_edge_t *edg;
+
+	edg = snd_edge_list;
+
+	while (edg != NULL) {
+		edg->drv = NULL;
+		edg->thread_ok = 0;
+		edg->forked = 1;
+
+		pthread_mutex_unlock (&edg->mutex);
+
+		edg = edg->next;
+	}
+
+	snd_edge_list = NULL;
+
+	pthread_mutex_unlock (&snd_edge_list_mutex);
+}
+
+static
+void snd_edge_list_add (sound_edge_t *edg)
+{
+	pthread_mutex_lock (&snd_edge_list_mutex);
+
+	if (snd_edge_atfork == 0) {
+		pthread_atfork (snd_edge_fork_prepare, snd_edge_fork_parent,
+			snd_edge_fork_child
+		);
+
+		snd_edge_atfork = 1;
+	}
+
+	edg->next = snd_edge_list;
+	snd_edge_list = edg;
+
+	pthread_mutex_unlock (&snd_edge_list_mutex);
+}
+
+static
+void snd_edge_list_rmv (sound_edge_t *edg)
+{
+	sound_edge_t **tmp;
+
+	pthread_mutex_lock (&snd_edge_list_mutex);
+
+	tmp = &snd_edge_list;
+
+	while (*tmp != NULL) {
+		if (*tmp == edg) {
+			*tmp = edg->next;
+			break;
+		}
+
+		tmp = &(*tmp)->next;
+	}
+
+	edg->next = NULL;
+
+	pthread_mutex_unlock (&snd_edge_list_mutex);
+}
+
+static
+void snd_edge_stop_thread (sound_edge_t *edg)
+{
+	if (edg->thread_ok == 0) {
+		return;
+	}
+
+	pthread_mutex_lock (&edg->mutex);
+	edg->stop = 1;
+	pthread_cond_broadcast (&edg->cond);
+	pthread_mutex_unlock (&edg->mutex);
+
+	pthread_join (edg->thread, NULL);
+
+	edg->thread_ok = 0;
+	edg->stop = 0;
+}
+#endif
+
+void snd_edge_init (sound_edge_t *edg, unsigned long clock)
+{
+	edg->drv = NULL;
+
+	edg->clock = clock;
+	edg->srate = 44100;
+
+	edg->level = 0;
+	edg->sync_clk = 0;
+	edg->wake_clk = 0;
+
+	edg->wr = 0;
+	edg->rd = 0;
+	edg->overrun = 0;
+
+	edg->clk = 0;
+	edg->rem = 0;
+
+	snd_blep_init (&edg->blep, 0);
+
+	edg->smooth_freq = 0;
+	edg->smooth_mul = 65536;
+	edg->smooth_val = 0;
+
+	edg->lowpass_freq = 0;
+	snd_iir2_init (&edg->iir);
+
+	edg->buf_cnt = 0;
+
+#ifdef PCE_ENABLE_PTHREAD
+	edg->thread_ok = 0;
+	edg->stop = 0;
+	pthread_mutex_init (&edg->mutex, NULL);
+	pthread_cond_init (&edg->cond, NULL);
+	edg->forked = 0;
+	edg->next = NULL;
+#endif
+}
+
+void snd_edge_free (sound_edge_t *edg)
+{
+	snd_edge_set_driver (edg, NULL, edg->srate);
+
+#ifdef PCE_ENABLE_PTHREAD
+	if (edg->forked == 0) {
+		pthread_cond_destroy (&edg->cond);
+		pthread_mutex_destroy (&edg->mutex);
+	}
+#endif
+}
+
+int snd_edge_set_driver (sound_edge_t *edg, sound_drv_t *drv, unsigned long srate)
+{
+	if (edg->drv != NULL) {
+#ifdef PCE_ENABLE_PTHREAD
+		snd_edge_list_rmv (edg);
+		snd_edge_stop_thread (edg);
+#endif
+		snd_edge_render (edg);
+		snd_edge_play (edg);
+	}
+
+	edg->drv = drv;
+	edg->srate = srate;
+
+	edg->wr = 0;
+	edg->rd = 0;
+	edg->overrun = 0;
+
+	snd_edge_set_smoothing (edg, edg->smooth_freq);
+	snd_edge_set_lowpass (edg, edg->lowpass_freq);
+
+	if (drv == NULL) {
+		return (0);
+	}
+
+#ifdef PCE_ENABLE_PTHREAD
+	if (edg->forked) {
+		return (0);
+	}
+
+	if (pthread_create (&edg->thread, NULL, snd_edge_thread, edg) == 0) {
+		edg->thread_ok = 1;
+	}
+
+	snd_edge_list_add (edg);
+#endif
+
+	return (0);
+}
+
+void snd_edge_set_smoothing (sound_edge_t *edg, unsigned long freq)
+{
+	edg->smooth_freq = freq;
+
+	if ((freq == 0) || (edg->srate == 0)) {
+		edg->smooth_mul = 65536;
+		return;
+	}
+
+	edg->smooth_mul = (long) (65536.0 * (1.0 - exp (-2.0 * M_PI * freq / edg->srate)));
+
+	if (edg->smooth_mul < 1) {
+		edg->smooth_mul = 1;
+	}
+}
+
+void snd_edge_set_lowpass (sound_edge_t *edg, unsigned long freq)
+{
+	edg->lowpass_freq = freq;
+
+	snd_iir2_set_lowpass (&edg->iir, freq, edg->srate);
+}
+
+void snd_edge_start (sound_edge_t *edg, unsigned long clk)
+{
+	if (edg->drv == NULL) {
+		return;
+	}
+
+	edg->level = 0;
+
+	snd_edge_push (edg, SND_EDGE_START, clk, 0);
+}
+
+void snd_edge_stop (sound_edge_t *edg, unsigned long clk)
+{
+	if (edg->drv == NULL) {
+		return;
+	}
+
+	snd_edge_push (edg, SND_EDGE_STOP, clk, 0);
+}
+
+void snd_edge_set_level (sound_edge_t *edg, unsigned long clk, long level)
+{
+	if ((edg->drv == NULL) || (edg->level == level)) {
+		return;
+	}
+
+	edg->level = level;
+
+	snd_edge_push (edg, SND_EDGE_LEVEL, clk, level);
+}
+
+void snd_edge_sync (sound_edge_t *edg, unsigned long clk)
+{
+	if (edg->drv == NULL) {
+		return;
+	}
+
+	snd_edge_push (edg, SND_EDGE_SYNC, clk, 0);
+}
+
+int snd_edge_get_delay (sound_edge_t *edg, long *us)
+{
+	unsigned long      rd, clk, pend;
+	unsigned long long tmp;
+
+	if (edg->drv == NULL) {
+		return (1);
+	}
+
+	/* the events that have not been rendered, approximately */
+	rd = snd_edge_load (&edg->rd);
+
+	if (rd == edg->wr) {
+		pend = 0;
+	}
+	else {
+		clk = edg->evt[rd & (SND_EDGE_QUEUE - 1)].clk;
+		tmp = (unsigned long long) (edg->sync_clk - clk) * edg->srate;
+		pend = tmp / edg->clock;
+	}
+
+	return (snd_get_delay (edg->drv, pend, us));
+}
@@ -0,0 +1,218 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/drivers/sound/edge.h                                     *
+ * Created:     2026-10-19 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#ifndef PCE_DRIVERS_SOUND_EDGE_H
+#define PCE_DRIVERS_SOUND_EDGE_H 1
+
+
+#include <config.h>
+
+#include <stdint.h>
+
+#include <drivers/sound/blep.h>
+#include <drivers/sound/filter.h>
+#include <drivers/sound/sound.h>
+
+#ifdef PCE_ENABLE_PTHREAD
+#include <pthread.h>
+#endif
+
+
+/* the number of events in the queue, a power of 2 */
+#define SND_EDGE_QUEUE 4096
+
+/* the number of queue entries that are reserved for start and stop */
+#define SND_EDGE_RESERVE 8
+
+/* the number of output samples that are written at once */
+#define SND_EDGE_BUF   1024
+
+#define SND_EDGE_LEVEL 0
+#define SND_EDGE_SYNC  1
+#define SND_EDGE_START 2
+#define SND_EDGE_STOP  3
+
+
+typedef struct {
+	unsigned      type;
+	unsigned long clk;
+	long          level;
+} sound_edge_evt_t;
+
+
+/*!***************************************************************************
+ * @short A DAC event renderer
+ *
+ * A sound device pushes timestamped level changes into a queue. The
+ * renderer turns them into band-limited samples and writes them to the
+ * sound driver. If threads are available this is done by a separate
+ * thread, so the emulator never waits for the sound output.
+ *
+ * In a child process after fork(), the renderer has no sound driver.
+ *****************************************************************************/
+typedef struct sound_edge_t {
+	sound_drv_t      *drv;
+
+	/* the input clock frequency */
+	unsigned long    clock;
+
+	/* the output sample rate */
+	unsigned long    srate;
+
+	/* the producer state */
+	long             level;
+	unsigned long    sync_clk;
+	unsigned long    wake_clk;
+
+	/*
+	 * The event queue. wr is only written by the producer and rd
+	 * only by the renderer. Both count events and wrap around at
+	 * ULONG_MAX.
+	 */
+	unsigned long    wr;
+	unsigned long    rd;
+	sound_edge_evt_t evt[SND_EDGE_QUEUE];
+
+	/* events were dropped because the queue was full */
+	int              overrun;
+
+	/* the renderer state */
+	unsigned long    clk;
+	unsigned long    rem;
+
+	sound_blep_t     blep;
+
+	unsigned long    smooth_freq;
+	long             smooth_mul;
+	long             smooth_val;
+
+	unsigned long    lowpass_freq;
+	sound_iir2_t     iir;
+
+	unsigned         buf_cnt;
+	uint16_t         buf[SND_EDGE_BUF];
+
+#ifdef PCE_ENABLE_PTHREAD
+	int              thread_ok;
+	int              stop;
+	pthread_t        thread;
+	pthread_mutex_t  mutex;
+	pthread_cond_t   cond;
+
+	/*
+	 * Set in a child process after fork(). The mutex and the condition
+	 * variable may still count the parent's renderer thread as a
+	 * waiter, so they are neither used nor destroyed.
+	 */
+	int              forked;
+
+	/* the list of renderers with a sound driver */
+	struct sound_edge_t *next;
+#endif
+} sound_edge_t;
+
+
+/*!***************************************************************************
+ * @short Initialize an event renderer
+ * @param clock The input clock frequency. All event times are in clocks
+ *              of this frequency.
+ *****************************************************************************/
+void snd_edge_init (sound_edge_t *edg, unsigned long clock);
+
+/*!***************************************************************************
+ * @short Free an event renderer
+ *
+ * All pending events are rendered. The sound driver is not closed.
+ *****************************************************************************/
+void snd_edge_free (sound_edge_t *edg);
+
+/*!***************************************************************************
+ * @short  Set the sound driver
+ * @param  drv   The sound driver or NULL. The driver must have been set
+ *               up for signed mono samples at the sample rate srate.
+ * @param  srate The output sample rate
+ * @return Zero if successful, nonzero otherwise
+ *
+ * If a driver was set before, all pending events are rendered to it
+ * first. The sound driver is not owned by the renderer and must not
+ * be closed before it is replaced.
+ *****************************************************************************/
+int snd_edge_set_driver (sound_edge_t *edg, sound_drv_t *drv, unsigned long srate);
+
+/*!***************************************************************************
+ * @short Set the cut-off frequency of a first order lowpass filter
+ *
+ * This filter is applied to the band-limited output before the IIR
+ * lowpass filter. Zero disables the filter.
+ *****************************************************************************/
+void snd_edge_set_smoothing (sound_edge_t *edg, unsigned long freq);
+
+/*!***************************************************************************
+ * @short Set the cut-off frequency of the IIR lowpass filter
+ *
+ * Zero disables the filter.
+ *****************************************************************************/
+void snd_edge_set_lowpass (sound_edge_t *edg, unsigned long freq);
+
+/*!***************************************************************************
+ * @short Start the sound output
+ * @param clk The current input clock
+ *
+ * The output level is reset to zero and some silence is written to
+ * the sound driver, so that it does not underrun immediately.
+ *****************************************************************************/
+void snd_edge_start (sound_edge_t *edg, unsigned long clk);
+
+/*!***************************************************************************
+ * @short Stop the sound output
+ * @param clk The current input clock
+ *
+ * All samples up to clk are written to the sound driver.
+ *****************************************************************************/
+void snd_edge_stop (sound_edge_t *edg, unsigned long clk);
+
+/*!***************************************************************************
+ * @short Change the output level
+ * @param clk   The input clock at which the level changes
+ * @param level The new level, in the range -32768 .. 32767
+ *****************************************************************************/
+void snd_edge_set_level (sound_edge_t *edg, unsigned long clk, long level);
+
+/*!***************************************************************************
+ * @short Let the renderer advance to the current time
+ * @param clk The current input clock
+ *
+ * This should be called regularly while the sound output is running.
+ *****************************************************************************/
+void snd_edge_sync (sound_edge_t *edg, unsigned long clk);
+
+/*!***************************************************************************
+ * @short  Get the time by which the sound output is ahead of its target
+ * @return Zero if successful, nonzero otherwise
+ *
+ * This includes the events that have not been rendered yet.
+ * See snd_get_delay().
+ *****************************************************************************/
+int snd_edge_get_delay (sound_edge_t *edg, long *us);
+
+
+#endif
@@ -86,29 +86,36 @@ void snd_iir2_filter (sound_iir2_t *iir, uint16_t *dst, const uint16_t *src,
 	unsigned cnt, unsigned ofs, int sign)
 {
 	long     v;
+	long     x0, x1, x2, y0, y1, y2;
+	long     a0, a1, a2, b1, b2;
 	uint16_t sig;
 
 	sig = sign ? 0x8000 : 0;
 
-	while (cnt > 0) {
-		v = *src ^ sig;
-		v -= 32768;
+	/* keep the filter state in registers for the whole block */
+	a0 = iir->a[0];
+	a1 = iir->a[1];
+	a2 = iir->a[2];
+	b1 = iir->b[1];
+	b2 = iir->b[2];
 
-		iir->x[2] = iir->x[1];
-		iir->x[1] = iir->x[0];
-		iir->x[0] = v;
+	x1 = iir->x[0];
+	x2 = iir->x[1];
+	y1 = iir->y[0];
+	y2 = iir->y[1];
 
-		iir->y[2] = iir->y[1];
-		iir->y[1] = iir->y[0];
+	while (cnt > 0) {
+		x0 = (long) (*src ^ sig) - 32768;
 
-		iir->y[0] = iir->a[0] * iir->x[0];
-		iir->y[0] += iir->a[1] * iir->x[1] + iir->a[2] * iir->x[2];
-		iir->y[0] -= iir->b[1] * iir->y[1] + iir->b[2] * iir->y[2];
+		y0 = a0 * x0 + a1 * x1 + a2 * x2 - b2 * y2 - b1 * y1;
+		y0 /= SND_IIR_MUL;
 
-		iir->y[0] = iir->y[0] / SND_IIR_MUL;
+		x2 = x1;
+		x1 = x0;
+		y2 = y1;
+		y1 = y0;
 
-		v = iir->y[0];
-		v += 32768;
+		v = y0 + 32768;
 
 		if (v < 0) {
 			v = 0;
@@ -116,9 +123,6 @@ void snd_iir2_filter (sound_iir2_t *iir, uint16_t *dst, const uint16_t *src,
 		else if (v > 65535) {
 			v = 0xffff;
 		}
-		else {
-			v &= 0xffff;
-		}
 
 		*dst = ((uint16_t) v) ^ sig;
 
@@ -126,4 +130,10 @@ void snd_iir2_filter (sound_iir2_t *iir, uint16_t *dst, const uint16_t *src,
 		dst += ofs;
 		cnt -= 1;
 	}
+
+	iir->x[0] = x1;
+	iir->x[1] = x2;
+
+	iir->y[0] = y1;
+	iir->y[1] = y2;
 }
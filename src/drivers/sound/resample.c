@@ -0,0 +1,375 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/drivers/sound/resample.c                                 *
+ * Created:     2026-10-19 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#include <config.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <drivers/sound/resample.h>
+
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* the cut-off frequency relative to the lower sample rate */
+#define SND_RSMP_CUTOFF 0.45
+
+
+/*
+ * Build the filter table
+ *
+ * Phase i is the impulse response for an output sample that lies
+ * i / SND_RSMP_PHASES input samples after the center tap. Each phase
+ * is scaled to a sum of exactly 1.
+ */
+static
+void snd_rsmp_init_tab (sound_rsmp_t *rs)
+{
+	unsigned i, j;
+	double   fc, x, v, w, sum;
+	float    *tab;
+
+	fc = 2.0 * SND_RSMP_CUTOFF;
+
+	if (rs->srate_out < rs->srate_in) {
+		fc = (fc * rs->srate_out) / rs->srate_in;
+	}
+
+	for (i = 0; i <= SND_RSMP_PHASES; i++) {
+		tab = rs->tab + i * rs->taps;
+
+		sum = 0.0;
+
+		for (j = 0; j < rs->taps; j++) {
+			x = (double) j - (rs->taps / 2 - 1) - (double) i / SND_RSMP_PHASES;
+
+			if (x == 0.0) {
+				v = 1.0;
+			}
+			else {
+				v = sin (M_PI * fc * x) / (M_PI * fc * x);
+			}
+
+			w = 2.0 * M_PI * x / rs->taps;
+			w = 0.42 + 0.5 * cos (w) + 0.08 * cos (2.0 * w);
+
+			if (w < 0.0) {
+				w = 0.0;
+			}
+
+			tab[j] = (float) (v * w);
+			sum += tab[j];
+		}
+
+		for (j = 0; j < rs->taps; j++) {
+			tab[j] = (float) (tab[j] / sum);
+		}
+	}
+}
+
+/*
+ * Make room for cnt input samples per channel
+ */
+static
+int snd_rsmp_grow_inp (sound_rsmp_t *rs, unsigned long cnt)
+{
+	unsigned      i;
+	unsigned long max;
+	float         *tmp;
+
+	if ((rs->inp_cnt + cnt) <= rs->inp_max) {
+		return (0);
+	}
+
+	max = rs->inp_cnt + cnt + 256;
+
+	tmp = malloc ((unsigned long) rs->chn * max * sizeof (float));
+
+	if (tmp == NULL) {
+		return (1);
+	}
+
+	for (i = 0; i < rs->chn; i++) {
+		if (rs->inp != NULL) {
+			memcpy (tmp + i * max, rs->inp + i * rs->inp_max,
+				rs->inp_cnt * sizeof (float)
+			);
+		}
+		else {
+			memset (tmp + i * max, 0, rs->inp_cnt * sizeof (float));
+		}
+	}
+
+	free (rs->inp);
+
+	rs->inp = tmp;
+	rs->inp_max = max;
+
+	return (0);
+}
+
+static
+int snd_rsmp_grow_out (sound_rsmp_t *rs, unsigned long cnt)
+{
+	uint16_t *tmp;
+
+	cnt *= rs->chn;
+
+	if (cnt <= rs->out_max) {
+		return (0);
+	}
+
+	tmp = realloc (rs->out, cnt * sizeof (uint16_t));
+
+	if (tmp == NULL) {
+		return (1);
+	}
+
+	rs->out = tmp;
+	rs->out_max = cnt;
+
+	return (0);
+}
+
+/*
+ * Convert the input samples of channel c to float
+ */
+static
+void snd_rsmp_load (sound_rsmp_t *rs, unsigned c, const uint16_t *buf,
+	unsigned long cnt, int sign)
+{
+	unsigned long i;
+	float         *dst;
+
+	dst = rs->inp + c * rs->inp_max + rs->inp_cnt;
+	buf += c;
+
+	if (sign) {
+		for (i = 0; i < cnt; i++) {
+			dst[i] = (float) (int16_t) buf[i * rs->chn];
+		}
+	}
+	else {
+		for (i = 0; i < cnt; i++) {
+			dst[i] = (float) ((long) buf[i * rs->chn] - 32768);
+		}
+	}
+}
+
+/*
+ * Compute one output sample from taps input samples
+ */
+static inline
+float snd_rsmp_dot (const float *x, const float *h, unsigned taps)
+{
+	unsigned j;
+	float    s0, s1, s2, s3;
+
+	s0 = s1 = s2 = s3 = 0.0F;
+
+	for (j = 0; j < taps; j += 4) {
+		s0 += x[j + 0] * h[j + 0];
+		s1 += x[j + 1] * h[j + 1];
+		s2 += x[j + 2] * h[j + 2];
+		s3 += x[j + 3] * h[j + 3];
+	}
+
+	return ((s0 + s1) + (s2 + s3));
+}
+
+static inline
+uint16_t snd_rsmp_get_smp (float v, int sign)
+{
+	long val;
+
+	val = (long) floor (v + 0.5F);
+
+	if (val < -32768) {
+		val = -32768;
+	}
+	else if (val > 32767) {
+		val = 32767;
+	}
+
+	if (sign) {
+		return (val & 0xffff);
+	}
+
+	return ((val + 32768) & 0xffff);
+}
+
+void snd_rsmp_init (sound_rsmp_t *rs)
+{
+	rs->chn = 0;
+	rs->srate_in = 0;
+	rs->srate_out = 0;
+
+	rs->taps = 0;
+	rs->tab = NULL;
+
+	rs->acc = 0;
+
+	rs->inp_cnt = 0;
+	rs->inp_max = 0;
+	rs->inp = NULL;
+
+	rs->out_max = 0;
+	rs->out = NULL;
+}
+
+void snd_rsmp_free (sound_rsmp_t *rs)
+{
+	free (rs->tab);
+	free (rs->inp);
+	free (rs->out);
+
+	snd_rsmp_init (rs);
+}
+
+int snd_rsmp_set_rates (sound_rsmp_t *rs, unsigned chn,
+	unsigned long srate_in, unsigned long srate_out)
+{
+	unsigned long taps;
+
+	snd_rsmp_free (rs);
+
+	if ((chn == 0) || (srate_in == 0) || (srate_out == 0)) {
+		return (1);
+	}
+
+	if ((srate_in / 8) > srate_out) {
+		return (1);
+	}
+
+	taps = SND_RSMP_TAPS;
+
+	if (srate_in > srate_out) {
+		taps = (SND_RSMP_TAPS * srate_in + srate_out - 1) / srate_out;
+		taps = (taps + 3) & ~3UL;
+
+		if (taps > SND_RSMP_TAPS_MAX) {
+			taps = SND_RSMP_TAPS_MAX;
+		}
+	}
+
+	rs->chn = chn;
+	rs->srate_in = srate_in;
+	rs->srate_out = srate_out;
+	rs->taps = taps;
+
+	rs->tab = malloc ((SND_RSMP_PHASES + 1) * taps * sizeof (float));
+
+	if (rs->tab == NULL) {
+		return (1);
+	}
+
+	snd_rsmp_init_tab (rs);
+
+	/* start with silence in the filter history */
+	rs->inp_cnt = taps - 1;
+
+	if (snd_rsmp_grow_inp (rs, 0)) {
+		return (1);
+	}
+
+	return (0);
+}
+
+const uint16_t *snd_rsmp_run (sound_rsmp_t *rs,
+	const uint16_t *buf, unsigned cnt, int sign, unsigned *ocnt)
+{
+	unsigned           c;
+	unsigned long      k, n, ph;
+	unsigned long long tmp;
+	float              f, y0, y1;
+	const float        *h0, *h1, *x;
+	float              *inp;
+	uint16_t           *dst;
+
+	*ocnt = 0;
+
+	if (rs->tab == NULL) {
+		return (NULL);
+	}
+
+	if (snd_rsmp_grow_inp (rs, cnt)) {
+		return (NULL);
+	}
+
+	tmp = (unsigned long long) (rs->inp_cnt + cnt) * rs->srate_out;
+
+	if (snd_rsmp_grow_out (rs, tmp / rs->srate_in + 2)) {
+		return (NULL);
+	}
+
+	for (c = 0; c < rs->chn; c++) {
+		snd_rsmp_load (rs, c, buf, cnt, sign);
+	}
+
+	rs->inp_cnt += cnt;
+
+	k = 0;
+	n = 0;
+	dst = rs->out;
+
+	while ((k + rs->taps) <= rs->inp_cnt) {
+		tmp = (unsigned long long) rs->acc * SND_RSMP_PHASES;
+		ph = tmp / rs->srate_out;
+		f = (float) (tmp % rs->srate_out) / rs->srate_out;
+
+		h0 = rs->tab + ph * rs->taps;
+		h1 = h0 + rs->taps;
+
+		for (c = 0; c < rs->chn; c++) {
+			x = rs->inp + c * rs->inp_max + k;
+
+			y0 = snd_rsmp_dot (x, h0, rs->taps);
+			y1 = snd_rsmp_dot (x, h1, rs->taps);
+
+			*(dst++) = snd_rsmp_get_smp (y0 + f * (y1 - y0), sign);
+		}
+
+		n += 1;
+
+		rs->acc += rs->srate_in;
+
+		while (rs->acc >= rs->srate_out) {
+			rs->acc -= rs->srate_out;
+			k += 1;
+		}
+	}
+
+	/* keep the unused samples as filter history */
+	for (c = 0; c < rs->chn; c++) {
+		inp = rs->inp + c * rs->inp_max;
+		memmove (inp, inp + k, (rs->inp_cnt - k) * sizeof (float));
+	}
+
+	rs->inp_cnt -= k;
+
+	*ocnt = n;
+
+	return (rs->out);
+}
@@ -0,0 +1,111 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/drivers/sound/resample.h                                 *
+ * Created:     2026-10-19 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#ifndef PCE_DRIVERS_SOUND_RESAMPLE_H
+#define PCE_DRIVERS_SOUND_RESAMPLE_H 1
+
+
+#include <stdint.h>
+
+
+/* the number of filter phases between two input samples */
+#define SND_RSMP_PHASES 128
+
+/* the filter length in input samples when not downsampling */
+#define SND_RSMP_TAPS   32
+
+/* the maximum filter length in input samples, for 8:1 downsampling */
+#define SND_RSMP_TAPS_MAX 256
+
+
+/*!***************************************************************************
+ * @short A polyphase sample rate converter
+ *
+ * The input is filtered with a windowed sinc filter. The coefficients
+ * between two neighbouring filter phases are interpolated linearly.
+ * Each channel is kept as a contiguous array of float samples, so the
+ * inner loops can be vectorized by the compiler.
+ *****************************************************************************/
+typedef struct {
+	unsigned      chn;
+	unsigned long srate_in;
+	unsigned long srate_out;
+
+	/* the filter length in input samples */
+	unsigned      taps;
+
+	/* (SND_RSMP_PHASES + 1) phases of taps coefficients each */
+	float         *tab;
+
+	/* the output position between two input samples, 0 .. srate_out - 1 */
+	unsigned long acc;
+
+	/* the number of input samples per channel in inp */
+	unsigned long inp_cnt;
+	unsigned long inp_max;
+	float         *inp;
+
+	unsigned long out_max;
+	uint16_t      *out;
+} sound_rsmp_t;
+
+
+/*!***************************************************************************
+ * @short Initialize a sample rate converter
+ *****************************************************************************/
+void snd_rsmp_init (sound_rsmp_t *rs);
+
+/*!***************************************************************************
+ * @short Free a sample rate converter
+ *****************************************************************************/
+void snd_rsmp_free (sound_rsmp_t *rs);
+
+/*!***************************************************************************
+ * @short  Set the conversion parameters
+ * @param  chn       The number of interleaved channels
+ * @param  srate_in  The input sample rate
+ * @param  srate_out The output sample rate
+ * @return Zero if successful, nonzero otherwise
+ *
+ * This also resets the converter.
+ *****************************************************************************/
+int snd_rsmp_set_rates (sound_rsmp_t *rs, unsigned chn,
+	unsigned long srate_in, unsigned long srate_out
+);
+
+/*!***************************************************************************
+ * @short  Convert samples
+ * @param  buf  The interleaved input samples
+ * @param  cnt  The number of input samples per channel
+ * @param  sign If true, samples are signed otherwise unsigned
+ * @retval ocnt The number of output samples per channel
+ * @return The interleaved output samples or NULL on error
+ *
+ * The buffer returned is owned by the converter and is valid until the
+ * next call.
+ *****************************************************************************/
+const uint16_t *snd_rsmp_run (sound_rsmp_t *rs,
+	const uint16_t *buf, unsigned cnt, int sign, unsigned *ocnt
+);
+
+
+#endif
@@ -0,0 +1,577 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/drivers/sound/sound-mix.c                                *
+ * Created:     2026-10-19 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#include <config.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <drivers/options.h>
+#include <drivers/sound/sound.h>
+#include <drivers/sound/sound-mix.h>
+
+
+#ifndef DEBUG_SND_MIX
+#define DEBUG_SND_MIX 0
+#endif
+
+
+#ifdef PCE_ENABLE_PTHREAD
+#define snd_mix_lock(mix) pthread_mutex_lock (&(mix)->mutex)
+#define snd_mix_unlock(mix) pthread_mutex_unlock (&(mix)->mutex)
+#else
+#define snd_mix_lock(mix)
+#define snd_mix_unlock(mix)
+#endif
+
+
+static sound_mix_t *snd_mix = NULL;
+
+#ifdef PCE_ENABLE_PTHREAD
+static int         snd_mix_atfork = 0;
+#endif
+
+
+/*
+ * Check if a block can be mixed. Called with the lock held.
+ *
+ * A block is mixed when all active sources have a full block queued.
+ * A source that runs dry while another source is far ahead is made
+ * inactive, so that a stopped device does not stall the others.
+ */
+static
+int snd_mix_ready (sound_mix_t *mix)
+{
+	unsigned        i;
+	unsigned long   avail, max;
+	sound_mix_src_t *src;
+
+	max = 0;
+
+	for (i = 0; i < SND_MIX_SRC_MAX; i++) {
+		src = &mix->src[i];
+
+		if (src->used) {
+			avail = src->wr - src->rd;
+
+			if (avail > max) {
+				max = avail;
+			}
+		}
+	}
+
+	if (max < SND_MIX_BLOCK) {
+		return (0);
+	}
+
+	for (i = 0; i < SND_MIX_SRC_MAX; i++) {
+		src = &mix->src[i];
+
+		if ((src->used == 0) || (src->active == 0)) {
+			continue;
+		}
+
+		if ((src->wr - src->rd) < SND_MIX_BLOCK) {
+			if (max <= SND_MIX_LAG) {
+				return (0);
+			}
+
+			src->active = 0;
+		}
+	}
+
+	return (1);
+}
+
+/*
+ * Mix one block into mix->buf. Called with the lock held.
+ */
+static
+void snd_mix_block (sound_mix_t *mix)
+{
+	unsigned        i, j;
+	unsigned long   n, rd;
+	long            val;
+	long            acc[SND_MIX_BLOCK];
+	sound_mix_src_t *src;
+
+	for (j = 0; j < SND_MIX_BLOCK; j++) {
+		acc[j] = 0;
+	}
+
+	for (i = 0; i < SND_MIX_SRC_MAX; i++) {
+		src = &mix->src[i];
+
+		if (src->used == 0) {
+			continue;
+		}
+
+		n = src->wr - src->rd;
+
+		if (n > SND_MIX_BLOCK) {
+			n = SND_MIX_BLOCK;
+		}
+
+		rd = src->rd;
+
+		for (j = 0; j < n; j++) {
+			acc[j] += src->queue[(rd + j) & (SND_MIX_QUEUE - 1)];
+		}
+
+		src->rd = rd + n;
+	}
+
+	for (j = 0; j < SND_MIX_BLOCK; j++) {
+		val = acc[j];
+
+		if (val < -32768) {
+			val = -32768;
+		}
+		else if (val > 32767) {
+			val = 32767;
+		}
+
+		mix->buf[j] = val & 0xffff;
+	}
+}
+
+#ifdef PCE_ENABLE_PTHREAD
+
+static
+void *snd_mix_thread (void *ext)
+{
+	sound_mix_t *mix;
+
+	mix = ext;
+
+	snd_mix_lock (mix);
+
+	while (1) {
+		while ((mix->stop == 0) && (snd_mix_ready (mix) == 0)) {
+			pthread_cond_wait (&mix->cond, &mix->mutex);
+		}
+
+		if (mix->stop) {
+			break;
+		}
+
+		snd_mix_block (mix);
+
+		snd_mix_unlock (mix);
+
+		snd_write (mix->out, mix->buf, SND_MIX_BLOCK);
+
+		snd_mix_lock (mix);
+	}
+
+	snd_mix_unlock (mix);
+
+	return (NULL);
+}
+
+/*
+ * Keep the mixer thread out of its critical section while the process
+ * forks. In the child, the mixer thread doesn't exist and the output
+ * driver belongs to the parent, so the mixer is abandoned.
+ */
+static
+void snd_mix_fork_prepare (void)
+{
+	if (snd_mix != NULL) {
+		snd_mix_lock (snd_mix);
+	}
+}
+
+static
+void snd_mix_fork_parent (void)
+{
+	if (snd_mix != NULL) {
+		snd_mix_unlock (snd_mix);
+	}
+}
+
+static
+void snd_mix_fork_child (void)
+{
+	if (snd_mix != NULL) {
+		snd_mix->thread_ok = 0;
+		snd_mix_unlock (snd_mix);
+		snd_mix = NULL;
+	}
+}
+
+#endif
+
+/*
+ * Mix all complete blocks synchronously
+ */
+static
+void snd_mix_run (sound_mix_t *mix)
+{
+	while (snd_mix_ready (mix)) {
+		snd_mix_block (mix);
+		snd_write (mix->out, mix->buf, SND_MIX_BLOCK);
+	}
+}
+
+static
+void snd_mix_del (sound_mix_t *mix)
+{
+#ifdef PCE_ENABLE_PTHREAD
+	if (mix->thread_ok) {
+		snd_mix_lock (mix);
+		mix->stop = 1;
+		pthread_cond_broadcast (&mix->cond);
+		snd_mix_unlock (mix);
+
+		pthread_join (mix->thread, NULL);
+	}
+
+	pthread_cond_destroy (&mix->cond);
+	pthread_mutex_destroy (&mix->mutex);
+#endif
+
+	snd_close (mix->out);
+
+	free (mix);
+}
+
+static
+sound_mix_t *snd_mix_new (const char *name)
+{
+	unsigned    i;
+	char        *driver;
+	sound_mix_t *mix;
+
+	if ((mix = malloc (sizeof (sound_mix_t))) == NULL) {
+		return (NULL);
+	}
+
+	mix->srate = drv_get_option_uint (name, "rate", 44100);
+	mix->refcnt = 0;
+
+	for (i = 0; i < SND_MIX_SRC_MAX; i++) {
+		mix->src[i].used = 0;
+		mix->src[i].active = 0;
+		mix->src[i].wr = 0;
+		mix->src[i].rd = 0;
+	}
+
+	driver = drv_get_option (name, "driver");
+
+	if ((driver != NULL) && (strncmp (driver, "mix", 3) == 0)) {
+		fprintf (stderr, "snd-mix: bad output driver (%s)\n", driver);
+		free (driver);
+		free (mix);
+		return (NULL);
+	}
+
+	mix->out = snd_open ((driver != NULL) ? driver : "null");
+
+	if (mix->out == NULL) {
+		fprintf (stderr, "snd-mix: can't open output driver (%s)\n",
+			(driver != NULL) ? driver : "null"
+		);
+		free (driver);
+		free (mix);
+		return (NULL);
+	}
+
+	free (driver);
+
+	if (snd_set_params (mix->out, 1, mix->srate, 1)) {
+		snd_close (mix->out);
+		free (mix);
+		return (NULL);
+	}
+
+#ifdef PCE_ENABLE_PTHREAD
+	mix->thread_ok = 0;
+	mix->stop = 0;
+
+	pthread_mutex_init (&mix->mutex, NULL);
+	pthread_cond_init (&mix->cond, NULL);
+
+	if (pthread_create (&mix->thread, NULL, snd_mix_thread, mix) == 0) {
+		mix->thread_ok = 1;
+	}
+
+	if (snd_mix_atfork == 0) {
+		pthread_atfork (snd_mix_fork_prepare, snd_mix_fork_parent,
+			snd_mix_fork_child
+		);
+
+		snd_mix_atfork = 1;
+	}
+#endif
+
+	return (mix);
+}
+
+static
+void snd_mix_close (sound_drv_t *sdrv)
+{
+	sound_mix_drv_t *drv;
+	sound_mix_t     *mix;
+
+	drv = sdrv->ext;
+	mix = drv->mix;
+
+	snd_mix_lock (mix);
+	drv->src->used = 0;
+	drv->src->active = 0;
+	snd_mix_unlock (mix);
+
+	mix->refcnt -= 1;
+
+	if (mix->refcnt == 0) {
+		snd_mix_del (mix);
+
+		if (snd_mix == mix) {
+			snd_mix = NULL;
+		}
+	}
+
+	snd_free (sdrv);
+
+	free (drv);
+}
+
+/*
+ * Get a mono sample from a frame
+ */
+static inline
+long snd_mix_get_smp (const uint16_t *buf, unsigned chn, int sign)
+{
+	unsigned i;
+	long     val;
+
+	val = 0;
+
+	for (i = 0; i < chn; i++) {
+		if (sign) {
+			val += (int16_t) buf[i];
+		}
+		else {
+			val += (long) buf[i] - 32768;
+		}
+	}
+
+	return (val / (long) chn);
+}
+
+static
+int snd_mix_write (sound_drv_t *sdrv, const uint16_t *buf, unsigned cnt)
+{
+	unsigned long   wr;
+	sound_mix_drv_t *drv;
+	sound_mix_t     *mix;
+	sound_mix_src_t *src;
+
+	drv = sdrv->ext;
+	mix = drv->mix;
+	src = drv->src;
+
+	if (src->chn == 0) {
+		return (1);
+	}
+
+	snd_mix_lock (mix);
+
+	src->active = 1;
+
+	wr = src->wr;
+
+	while (cnt > 0) {
+		if ((wr - src->rd) >= SND_MIX_QUEUE) {
+			src->wr = wr;
+
+#ifdef PCE_ENABLE_PTHREAD
+			if (mix->thread_ok) {
+				/* the mixer thread is too slow, drop the rest */
+				break;
+			}
+#endif
+
+			snd_mix_run (mix);
+
+			continue;
+		}
+
+		src->queue[wr & (SND_MIX_QUEUE - 1)] = snd_mix_get_smp (buf, src->chn, src->sign);
+
+		wr += 1;
+		buf += src->chn;
+		cnt -= 1;
+	}
+
+	src->wr = wr;
+
+#ifdef PCE_ENABLE_PTHREAD
+	if (mix->thread_ok) {
+		if ((wr - src->rd) >= SND_MIX_BLOCK) {
+			pthread_cond_broadcast (&mix->cond);
+		}
+
+		snd_mix_unlock (mix);
+
+		if (cnt > 0) {
+#if DEBUG_SND_MIX >= 1
+			fprintf (stderr, "snd-mix: buffer overrun\n");
+#endif
+			return (1);
+		}
+
+		return (0);
+	}
+#endif
+
+	snd_mix_run (mix);
+
+	snd_mix_unlock (mix);
+
+	return (0);
+}
+
+static
+int snd_mix_set_params (sound_drv_t *sdrv, unsigned chn, unsigned long srate, int sign)
+{
+	sound_mix_drv_t *drv;
+
+	drv = sdrv->ext;
+
+	if (srate != drv->mix->srate) {
+		fprintf (stderr, "snd-mix: bad sample rate (%lu)\n", srate);
+		return (1);
+	}
+
+	snd_mix_lock (drv->mix);
+
+	drv->src->chn = chn;
+	drv->src->sign = sign;
+
+	snd_mix_unlock (drv->mix);
+
+	return (0);
+}
+
+static
+int snd_mix_get_queue (sound_drv_t *sdrv, unsigned long *cnt, unsigned long *target)
+{
+	sound_mix_drv_t *drv;
+
+	drv = sdrv->ext;
+
+	if (snd_get_queue (drv->mix->out, cnt, target)) {
+		return (1);
+	}
+
+	snd_mix_lock (drv->mix);
+
+	*cnt += drv->src->wr - drv->src->rd;
+
+	snd_mix_unlock (drv->mix);
+
+	return (0);
+}
+
+static
+int snd_mix_init (sound_mix_drv_t *drv, const char *name)
+{
+	unsigned        i;
+	sound_mix_src_t *src;
+
+	if (snd_mix == NULL) {
+		if ((snd_mix = snd_mix_new (name)) == NULL) {
+			return (1);
+		}
+	}
+
+	src = NULL;
+
+	snd_mix_lock (snd_mix);
+
+	for (i = 0; i < SND_MIX_SRC_MAX; i++) {
+		if (snd_mix->src[i].used == 0) {
+			src = &snd_mix->src[i];
+			break;
+		}
+	}
+
+	if (src != NULL) {
+		src->used = 1;
+		src->active = 0;
+		src->chn = 0;
+		src->sign = 1;
+		src->wr = 0;
+		src->rd = 0;
+	}
+
+	snd_mix_unlock (snd_mix);
+
+	if (src == NULL) {
+		fprintf (stderr, "snd-mix: too many sources\n");
+
+		if (snd_mix->refcnt == 0) {
+			snd_mix_del (snd_mix);
+			snd_mix = NULL;
+		}
+
+		return (1);
+	}
+
+	snd_mix->refcnt += 1;
+
+	snd_init (&drv->sdrv, drv);
+
+	drv->sdrv.close = snd_mix_close;
+	drv->sdrv.write = snd_mix_write;
+	drv->sdrv.set_params = snd_mix_set_params;
+	drv->sdrv.get_queue = snd_mix_get_queue;
+
+	/* all sources are converted to the mixer sample rate */
+	drv->sdrv.resample_rate = snd_mix->srate;
+
+	drv->mix = snd_mix;
+	drv->src = src;
+
+	return (0);
+}
+
+sound_drv_t *snd_mix_open (const char *name)
+{
+	sound_mix_drv_t *drv;
+
+	drv = malloc (sizeof (sound_mix_drv_t));
+
+	if (drv == NULL) {
+		return (NULL);
+	}
+
+	if (snd_mix_init (drv, name)) {
+		free (drv);
+		return (NULL);
+	}
+
+	return (&drv->sdrv);
+}
@@ -0,0 +1,101 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/drivers/sound/sound-mix.h                                *
+ * Created:     2026-10-19 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#ifndef PCE_DRIVERS_SOUND_MIX_H
+#define PCE_DRIVERS_SOUND_MIX_H 1
+
+
+#include <config.h>
+
+#include <stdint.h>
+
+#include <drivers/sound/sound.h>
+
+#ifdef PCE_ENABLE_PTHREAD
+#include <pthread.h>
+#endif
+
+
+/* the maximum number of sources */
+#define SND_MIX_SRC_MAX 8
+
+/* the number of samples that are mixed at once */
+#define SND_MIX_BLOCK   256
+
+/* the size of a source queue in samples, a power of 2 */
+#define SND_MIX_QUEUE   16384
+
+/*
+ * A source that has run out of samples is skipped once another source
+ * has this many samples queued.
+ */
+#define SND_MIX_LAG     4096
+
+
+typedef struct {
+	char          used;
+	char          active;
+
+	unsigned      chn;
+	int           sign;
+
+	unsigned long wr;
+	unsigned long rd;
+	int16_t       queue[SND_MIX_QUEUE];
+} sound_mix_src_t;
+
+
+/*!***************************************************************************
+ * @short The mixer
+ *
+ * There is one mixer per process. It mixes all sources to a single mono
+ * output stream at a fixed sample rate.
+ *****************************************************************************/
+typedef struct {
+	sound_drv_t     *out;
+	unsigned long   srate;
+
+	unsigned        refcnt;
+
+	sound_mix_src_t src[SND_MIX_SRC_MAX];
+
+	uint16_t        buf[SND_MIX_BLOCK];
+
+#ifdef PCE_ENABLE_PTHREAD
+	int             thread_ok;
+	int             stop;
+	pthread_t       thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t  cond;
+#endif
+} sound_mix_t;
+
+
+typedef struct sound_mix_drv_t {
+	sound_drv_t     sdrv;
+
+	sound_mix_t     *mix;
+	sound_mix_src_t *src;
+} sound_mix_drv_t;
+
+
+#endif
@@ -36,71 +36,14 @@
 #endif
 
 
-static
-sound_sdl_buf_t *snd_sdl_buf_new (sound_sdl_t *drv, unsigned size)
-{
-	unsigned char   *tmp;
-	sound_sdl_buf_t *buf;
-
-	if (drv->free != NULL) {
-		buf = drv->free;
-		drv->free = drv->free->next;
-	}
-	else {
-		if (drv->buf_cnt > 32) {
-			return (NULL);
-		}
-
-		buf = malloc (sizeof (sound_sdl_buf_t));
-
-		if (buf == NULL) {
-			return (NULL);
-		}
-
-		buf->max = 0;
-		buf->data = NULL;
-
-		drv->buf_cnt += 1;
-	}
-
-	buf->next = NULL;
-
-	buf->idx = 0;
-	buf->cnt = 0;
-
-	if (buf->max < size) {
-		tmp = realloc (buf->data, size);
-
-		if (tmp == NULL) {
-			free (buf->data);
-			free (buf);
-
-			drv->buf_cnt -= 1;
-
-			return (NULL);
-		}
-
-		buf->max = size;
-		buf->data = tmp;
-	}
-
-	return (buf);
-}
-
-static
-void snd_sdl_buf_free_list (sound_sdl_buf_t *buf)
-{
-	sound_sdl_buf_t *tmp;
-
-	while (buf != NULL) {
-		tmp = buf;
-		buf = buf->next;
-
-		free (tmp->data);
-		free (tmp);
-	}
+#if defined (__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 7)))
+#define snd_sdl_load(p) __atomic_load_n ((p), __ATOMIC_ACQUIRE)
+#define snd_sdl_store(p, v) __atomic_store_n ((p), (v), __ATOMIC_RELEASE)
+#else
+#define snd_sdl_load(p) (*(volatile unsigned long *) (p))
+#define snd_sdl_store(p, v) (*(volatile unsigned long *) (p) = (v))
+#endif
 
-}
 
 static
 void snd_sdl_close (sound_drv_t *sdrv)
@@ -113,8 +56,13 @@ void snd_sdl_close (sound_drv_t *sdrv)
 		SDL_CloseAudio();
 	}
 
-	snd_sdl_buf_free_list (drv->head);
-	snd_sdl_buf_free_list (drv->free);
+#if DEBUG_SND_SDL >= 1
+	fprintf (stderr, "snd-sdl: underruns=%lu overruns=%lu\n",
+		drv->underruns, drv->overruns
+	);
+#endif
+
+	free (drv->ring);
 
 	snd_free (sdrv);
 
@@ -124,48 +72,49 @@ void snd_sdl_close (sound_drv_t *sdrv)
 static
 int snd_sdl_write (sound_drv_t *sdrv, const uint16_t *buf, unsigned cnt)
 {
-	int             sign;
-	unsigned long   bcnt, scnt;
-	sound_sdl_buf_t *bbuf;
-	sound_sdl_t     *drv;
+	int           sign;
+	unsigned long scnt, n, wr, ofs;
+	sound_sdl_t   *drv;
 
 	drv = sdrv->ext;
 
+	if (drv->ring == NULL) {
+		return (1);
+	}
+
 	scnt = (unsigned long) sdrv->channels * (unsigned long) cnt;
-	bcnt = 2 * scnt;
 
-	SDL_LockAudio();
-	bbuf = snd_sdl_buf_new (drv, bcnt);
-	SDL_UnlockAudio();
+	wr = drv->wr;
 
-	if (bbuf == NULL) {
+	if ((2 * scnt) > (drv->size - (wr - snd_sdl_load (&drv->rd)))) {
 #if DEBUG_SND_SDL >= 1
 		fprintf (stderr, "snd-sdl: buffer overrun\n");
 #endif
+		drv->overruns += 1;
 		return (1);
 	}
 
 	sign = (sdrv->sample_sign != drv->sign);
 
-	snd_set_buf (bbuf->data, buf, scnt, sign, drv->big_endian);
+	while (scnt > 0) {
+		ofs = wr & (drv->size - 1);
+		n = (drv->size - ofs) / 2;
 
-	bbuf->idx = 0;
-	bbuf->cnt = bcnt;
+		if (n > scnt) {
+			n = scnt;
+		}
 
-	SDL_LockAudio();
+		snd_set_buf (drv->ring + ofs, buf, n, sign, drv->big_endian);
 
-	if (drv->tail == NULL) {
-		drv->head = bbuf;
+		buf += n;
+		scnt -= n;
+		wr += 2 * n;
 	}
-	else {
-		drv->tail->next = bbuf;
-	}
-
-	drv->tail = bbuf;
 
-	SDL_UnlockAudio();
+	snd_sdl_store (&drv->wr, wr);
 
 	if (drv->is_paused) {
+		/* the audio callback waits until the ring is filled */
 		SDL_PauseAudio (0);
 		drv->is_paused = 0;
 	}
@@ -173,55 +122,114 @@ int snd_sdl_write (sound_drv_t *sdrv, const uint16_t *buf, unsigned cnt)
 	return (0);
 }
 
+static
+int snd_sdl_get_queue (sound_drv_t *sdrv, unsigned long *cnt, unsigned long *target)
+{
+	sound_sdl_t *drv;
+
+	drv = sdrv->ext;
+
+	if ((drv->ring == NULL) || (drv->frame == 0)) {
+		return (1);
+	}
+
+	*cnt = (drv->wr - snd_sdl_load (&drv->rd)) / drv->frame;
+	*target = drv->target / drv->frame;
+
+	return (0);
+}
+
+/*
+ * The audio callback
+ *
+ * After an underrun, silence is played until the ring is filled to the
+ * target level again. The device itself keeps running.
+ */
 static
 void snd_sdl_callback (void *user, Uint8 *buf, int cnt)
 {
-	int             n;
-	sound_sdl_t     *drv;
-	sound_sdl_buf_t *src;
+	unsigned long n, k, rd, avail, ofs;
+	sound_sdl_t   *drv;
 
 	drv = user;
 
-	if (drv->head == NULL) {
-		SDL_PauseAudio (1);
-		drv->is_paused = 1;
-		return;
-	}
+	rd = drv->rd;
+	avail = snd_sdl_load (&drv->wr) - rd;
 
-	while (cnt > 0) {
-		if (drv->head == NULL) {
-#if DEBUG_SND_SDL >= 1
-			fprintf (stderr, "snd-sdl: buffer underrun\n");
-#endif
+	if (drv->refill) {
+		if (avail < drv->target) {
 			memset (buf, 0, cnt);
 			return;
 		}
 
-		src = drv->head;
+		drv->refill = 0;
+	}
 
-		n = src->cnt - src->idx;
+	n = ((unsigned long) cnt < avail) ? (unsigned long) cnt : avail;
 
-		if (n <= cnt) {
-			memcpy (buf, src->data + src->idx, n);
+	while (n > 0) {
+		ofs = rd & (drv->size - 1);
+		k = drv->size - ofs;
 
-			buf += n;
-			cnt -= n;
+		if (k > n) {
+			k = n;
+		}
 
-			drv->head = src->next;
+		memcpy (buf, drv->ring + ofs, k);
 
-			if (drv->head == NULL) {
-				drv->tail = NULL;
-			}
+		buf += k;
+		cnt -= k;
+		rd += k;
+		n -= k;
+	}
 
-			src->next = drv->free;
-			drv->free = src;
-		}
-		else {
-			memcpy (buf, src->data + src->idx, cnt);
-			src->idx += cnt;
-			cnt = 0;
+	snd_sdl_store (&drv->rd, rd);
+
+	if (cnt > 0) {
+#if DEBUG_SND_SDL >= 1
+		fprintf (stderr, "snd-sdl: buffer underrun\n");
+#endif
+		memset (buf, 0, cnt);
+
+		drv->underruns += 1;
+		drv->refill = 1;
+	}
+}
+
+/*
+ * Allocate the ring buffer for the current parameters
+ */
+static
+int snd_sdl_set_ring (sound_sdl_t *drv, unsigned chn, unsigned long srate)
+{
+	unsigned long size;
+
+	drv->frame = 2 * chn;
+	drv->target = drv->frame * ((srate * drv->latency + 999) / 1000);
+
+	/* leave room for the emulator to run ahead of the target */
+	size = 4096;
+
+	while (size < (2 * drv->target)) {
+		size *= 2;
+	}
+
+	if (size != drv->size) {
+		free (drv->ring);
+
+		if ((drv->ring = malloc (size)) == NULL) {
+			drv->size = 0;
+			return (1);
 		}
+
+		drv->size = size;
 	}
+
+	drv->wr = 0;
+	drv->rd = 0;
+	drv->refill = 1;
+
+	return (0);
 }
 
 static
@@ -247,10 +255,19 @@ int snd_sdl_set_params (sound_drv_t *sdrv, unsigned chn, unsigned long srate, in
 		drv->is_open = 0;
 	}
 
+	if (snd_sdl_set_ring (drv, chn, srate)) {
+		return (1);
+	}
+
 	req.freq = srate;
 	req.format = AUDIO_S16LSB;
 	req.channels = chn;
 	req.samples = 1024;
+
+	/* the device buffer should be small compared to the ring */
+	while ((req.samples > 128) && ((4UL * req.samples * drv->frame) > drv->target)) {
+		req.samples /= 2;
+	}
 	req.callback = snd_sdl_callback;
 	req.userdata = drv;
 
@@ -280,15 +297,29 @@ int snd_sdl_init (sound_sdl_t *drv, const char *name)
 	drv->sdrv.close = snd_sdl_close;
 	drv->sdrv.write = snd_sdl_write;
 	drv->sdrv.set_params = snd_sdl_set_params;
+	drv->sdrv.get_queue = snd_sdl_get_queue;
 
 	drv->is_open = 0;
 	drv->is_paused = 1;
 
-	drv->buf_cnt = 0;
+	drv->latency = drv_get_option_uint (name, "latency", 100);
+
+	if (drv->latency < 10) {
+		drv->latency = 10;
+	}
+
+	drv->frame = 0;
+	drv->target = 0;
+
+	drv->size = 0;
+	drv->ring = NULL;
+	drv->wr = 0;
+	drv->rd = 0;
+
+	drv->refill = 1;
 
-	drv->head = NULL;
-	drv->tail = NULL;
-	drv->free = NULL;
+	drv->underruns = 0;
+	drv->overruns = 0;
 
 	return (0);
 }
@@ -27,28 +27,39 @@
 #include <drivers/sound/sound.h>
 
 
-typedef struct sound_sdl_buf_t {
-	struct sound_sdl_buf_t *next;
-	unsigned               idx;
-	unsigned               cnt;
-	unsigned               max;
-	unsigned char          *data;
-} sound_sdl_buf_t;
-
 typedef struct sound_sdl_t {
-	sound_drv_t sdrv;
+	sound_drv_t   sdrv;
+
+	char          is_open;
+	char          is_paused;
+
+	int           sign;
+	int           big_endian;
+
+	/* the requested latency in milliseconds */
+	unsigned long latency;
+
+	/* the bytes per sample frame */
+	unsigned      frame;
 
-	char        is_open;
-	char        is_paused;
+	/* the target fill level in bytes */
+	unsigned long target;
 
-	int         sign;
-	int         big_endian;
+	/*
+	 * The ring buffer. wr is only written by snd_sdl_write() and rd
+	 * only by the audio callback. Both count bytes and wrap around
+	 * at ULONG_MAX, size is a power of 2.
+	 */
+	unsigned long size;
+	unsigned char *ring;
+	unsigned long wr;
+	unsigned long rd;
 
-	unsigned        buf_cnt;
+	/* set by the audio callback while it waits for the ring to fill */
+	int           refill;
 
-	sound_sdl_buf_t *head;
-	sound_sdl_buf_t *tail;
-	sound_sdl_buf_t *free;
+	unsigned long underruns;
+	unsigned long overruns;
 } sound_sdl_t;
 
 
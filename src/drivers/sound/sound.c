@@ -39,6 +39,7 @@ static
 struct snd_drv_list drvtab[] = {
 	{ "null", snd_null_open },
 	{ "wav", snd_null_open },
+	{ "mix", snd_mix_open },
 
 #ifdef PCE_ENABLE_SOUND_OSS
 	{ "oss", snd_oss_open },
@@ -71,6 +72,19 @@ void snd_fix_lowpass (sound_drv_t *sdrv)
 	}
 }
 
+/*
+ * Check if the host is big endian
+ */
+static inline
+int snd_host_be (void)
+{
+	uint16_t val;
+
+	val = 0x0102;
+
+	return (*(unsigned char *) &val == 0x01);
+}
+
 unsigned char *snd_get_bbuf (sound_drv_t *sdrv, unsigned long cnt)
 {
 	unsigned char *tmp;
@@ -116,10 +130,26 @@ void snd_set_buf (unsigned char *dst, const uint16_t *src, unsigned long cnt,
 {
 	unsigned long i;
 	uint16_t      val, sig;
+	uint64_t      v4, sig4;
 
 	sig = sign ? 0x8000 : 0x0000;
 
-	if (be) {
+	if ((be != 0) == (snd_host_be () != 0)) {
+		/* native byte order, convert four samples at a time */
+		sig4 = sign ? 0x8000800080008000ULL : 0;
+
+		for (i = 0; (i + 4) <= cnt; i += 4) {
+			memcpy (&v4, src + i, 8);
+			v4 ^= sig4;
+			memcpy (dst + 2 * i, &v4, 8);
+		}
+
+		for (; i < cnt; i++) {
+			val = src[i] ^ sig;
+			memcpy (dst + 2 * i, &val, 2);
+		}
+	}
+	else if (be) {
 		for (i = 0; i < cnt; i++) {
 			val = *src ^ sig;
 
@@ -151,6 +181,11 @@ void snd_init (sound_drv_t *sdrv, void *ext)
 	sdrv->sample_rate = 0;
 	sdrv->sample_sign = 0;
 
+	sdrv->input_rate = 0;
+
+	sdrv->resample_rate = 0;
+	snd_rsmp_init (&sdrv->resample);
+
 	sdrv->lowpass_freq = 0;
 
 	sdrv->bbuf_max = 0;
@@ -168,10 +203,16 @@ void snd_init (sound_drv_t *sdrv, void *ext)
 	sdrv->write = NULL;
 
 	sdrv->set_params = NULL;
+
+	sdrv->set_opts = NULL;
+
+	sdrv->get_queue = NULL;
 }
 
 void snd_free (sound_drv_t *sdrv)
 {
+	snd_rsmp_free (&sdrv->resample);
+
 	if (sdrv->sbuf != NULL) {
 		free (sdrv->sbuf);
 		sdrv->sbuf = NULL;
@@ -236,8 +277,24 @@ int snd_write (sound_drv_t *sdrv, const uint16_t *buf, unsigned cnt)
 		return (1);
 	}
 
+	if (sdrv->sample_rate != sdrv->input_rate) {
+		buf = snd_rsmp_run (&sdrv->resample, buf, cnt, sdrv->sample_sign, &cnt);
+
+		if (buf == NULL) {
+			return (1);
+		}
+
+		if (cnt == 0) {
+			return (0);
+		}
+	}
+
 	sbuf = snd_filter (sdrv, buf, cnt);
 
+	if (sbuf == NULL) {
+		return (1);
+	}
+
 	r = sdrv->write (sdrv, sbuf, cnt);
 
 	snd_wav_write (sdrv, sdrv->wav_filter ? sbuf : buf, cnt);
@@ -256,7 +313,7 @@ int snd_check_params (sound_drv_t *sdrv, unsigned chn, unsigned long srate, int
 		return (0);
 	}
 
-	if (sdrv->sample_rate != srate) {
+	if (sdrv->input_rate != srate) {
 		return (0);
 	}
 
@@ -269,6 +326,8 @@ int snd_check_params (sound_drv_t *sdrv, unsigned chn, unsigned long srate, int
 
 int snd_set_params (sound_drv_t *sdrv, unsigned chn, unsigned long srate, int sign)
 {
+	unsigned long orate;
+
 	if (sdrv == NULL) {
 		return (1);
 	}
@@ -286,15 +345,28 @@ int snd_set_params (sound_drv_t *sdrv, unsigned chn, unsigned long srate, int si
 		return (0);
 	}
 
-	if (sdrv->set_params (sdrv, chn, srate, sign)) {
+	orate = (sdrv->resample_rate > 0) ? sdrv->resample_rate : srate;
+
+	if (sdrv->set_params (sdrv, chn, orate, sign)) {
 		return (1);
 	}
 
 	sdrv->channels = chn;
-	sdrv->sample_rate = srate;
+	sdrv->sample_rate = orate;
 	sdrv->sample_sign = sign;
+	sdrv->input_rate = srate;
 
-	if (snd_wav_set_params (sdrv, chn, srate, sign)) {
+	if (orate != srate) {
+		if (snd_rsmp_set_rates (&sdrv->resample, chn, srate, orate)) {
+			sdrv->input_rate = 0;
+			return (1);
+		}
+	}
+	else {
+		snd_rsmp_free (&sdrv->resample);
+	}
+
+	if (snd_wav_set_params (sdrv, chn, orate, sign)) {
 		return (1);
 	}
 
@@ -320,6 +392,40 @@ int snd_set_opts (sound_drv_t *sdrv, unsigned opts, int val)
 	return (0);
 }
 
+int snd_get_queue (sound_drv_t *sdrv, unsigned long *cnt, unsigned long *target)
+{
+	if ((sdrv == NULL) || (sdrv->get_queue == NULL)) {
+		return (1);
+	}
+
+	return (sdrv->get_queue (sdrv, cnt, target));
+}
+
+int snd_get_delay (sound_drv_t *sdrv, unsigned long pending, long *us)
+{
+	unsigned long cnt, target;
+	long long     tmp;
+
+	if (snd_get_queue (sdrv, &cnt, &target)) {
+		return (1);
+	}
+
+	if ((sdrv->sample_rate == 0) || (sdrv->input_rate == 0)) {
+		return (1);
+	}
+
+	if (sdrv->sample_rate != sdrv->input_rate) {
+		tmp = (long long) pending * sdrv->sample_rate;
+		pending = tmp / sdrv->input_rate;
+	}
+
+	tmp = (long long) (cnt + pending) - (long long) target;
+
+	*us = (long) ((1000000 * tmp) / (long long) sdrv->sample_rate);
+
+	return (0);
+}
+
 static
 sound_drv_t *snd_open_sdrv (sound_drv_t *sdrv, const char *name)
 {
@@ -336,6 +442,8 @@ sound_drv_t *snd_open_sdrv (sound_drv_t *sdrv, const char *name)
 
 	sdrv->lowpass_freq = drv_get_option_uint (name, "lowpass", 0);
 
+	sdrv->resample_rate = drv_get_option_uint (name, "srate", sdrv->resample_rate);
+
 	snd_fix_lowpass (sdrv);
 
 	return (sdrv);
@@ -28,6 +28,7 @@
 #include <stdint.h>
 
 #include <drivers/sound/filter.h>
+#include <drivers/sound/resample.h>
 
 
 #define SND_CHN_MAX 16
@@ -45,6 +46,13 @@ typedef struct sound_drv_t {
 	unsigned long sample_rate;
 	int           sample_sign;
 
+	/* the sample rate of the samples passed to snd_write() */
+	unsigned long input_rate;
+
+	/* the output sample rate if resampling, or 0 */
+	unsigned long resample_rate;
+	sound_rsmp_t  resample;
+
 	unsigned long lowpass_freq;
 	sound_iir2_t  lowpass_iir2[SND_CHN_MAX];
 
@@ -67,6 +75,10 @@ typedef struct sound_drv_t {
 	);
 
 	int (*set_opts) (struct sound_drv_t *sdrv, unsigned opts, int val);
+
+	int (*get_queue) (struct sound_drv_t *sdrv,
+		unsigned long *cnt, unsigned long *target
+	);
 } sound_drv_t;
 
 
@@ -122,7 +134,9 @@ const uint16_t *snd_filter (sound_drv_t *sdrv, const uint16_t *buf, unsigned cnt
  * @param buf  The sample buffer
  * @param cnt  The sample count per channel
  *
- * The total number of samples in buf is (channels * cnt).
+ * The total number of samples in buf is (channels * cnt). If the driver
+ * was opened with the srate option, the samples are converted from
+ * the input sample rate to that rate before they are filtered.
  *****************************************************************************/
 int snd_write (sound_drv_t *sdrv, const uint16_t *buf, unsigned cnt);
 
@@ -133,17 +147,45 @@ int snd_write (sound_drv_t *sdrv, const uint16_t *buf, unsigned cnt);
  * @param sign   If true, samples are signed otherwise unsigned
  *
  * This function must be called after snd_open() and before the first call
- * to snd_write().
+ * to snd_write(). The sample rate is the rate of the samples passed to
+ * snd_write(). The driver itself runs at sdrv->sample_rate.
  *****************************************************************************/
 int snd_set_params (sound_drv_t *sdrv, unsigned chn, unsigned long srate, int sign);
 
 int snd_set_opts (sound_drv_t *sdrv, unsigned opts, int val);
 
+/*!***************************************************************************
+ * @short  Get the sound output queue depth
+ * @retval cnt    The number of samples per channel that have been written
+ *                but not yet played
+ * @retval target The queue depth the driver tries to keep, in samples per
+ *                channel
+ * @return Zero if successful, nonzero if the driver does not know its
+ *         queue depth
+ *****************************************************************************/
+int snd_get_queue (sound_drv_t *sdrv, unsigned long *cnt, unsigned long *target);
+
+/*!***************************************************************************
+ * @short  Get the time by which the sound output is ahead of its target
+ * @param  pending The number of samples per channel that the caller has
+ *                 buffered but not yet written, at the input sample rate
+ * @retval us      The queue depth minus the target queue depth, in
+ *                 microseconds. This is negative if the queue runs low.
+ * @return Zero if successful, nonzero if the driver does not know its
+ *         queue depth
+ *
+ * This can be used to pace the emulation by the sound output instead of
+ * by the host's wall clock.
+ *****************************************************************************/
+int snd_get_delay (sound_drv_t *sdrv, unsigned long pending, long *us);
+
 
 sound_drv_t *snd_open (const char *name);
 
 sound_drv_t *snd_null_open (const char *name);
 
+sound_drv_t *snd_mix_open (const char *name);
+
 sound_drv_t *snd_oss_open (const char *name);
 
 sound_drv_t *snd_sdl_open (const char *name);
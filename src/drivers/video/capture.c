@@ -0,0 +1,609 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/drivers/video/capture.c                                  *
+ * Created:     2026-10-19 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#include <config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <drivers/video/capture.h>
+
+
+#ifdef PCE_ENABLE_PTHREAD
+#define cap_lock(cap) pthread_mutex_lock (&(cap)->mutex)
+#define cap_unlock(cap) pthread_mutex_unlock (&(cap)->mutex)
+#else
+#define cap_lock(cap)
+#define cap_unlock(cap)
+#endif
+
+
+#ifdef PCE_ENABLE_PTHREAD
+static pthread_mutex_t cap_list_mutex = PTHREAD_MUTEX_INITIALIZER;
+static capture_t       *cap_list = NULL;
+static int             cap_atfork = 0;
+#endif
+
+
+/*
+ * Convert a frame to the output format
+ */
+static
+void cap_convert (capture_t *cap, const cap_slot_t *sl)
+{
+	unsigned            x, y, r, g, b;
+	unsigned long       n;
+	uint32_t            val;
+	const unsigned char *src;
+	unsigned char       *dst, *dy, *du, *dv;
+
+	n = (unsigned long) cap->w * cap->h;
+
+	memset (cap->out, 0, 3 * n);
+
+	if (cap->format == CAP_FORMAT_Y4M) {
+		memset (cap->out, 16, n);
+		memset (cap->out + n, 128, 2 * n);
+	}
+
+	for (y = 0; y < sl->h; y++) {
+		src = sl->buf + (unsigned long) sl->bpp * sl->w * y;
+
+		dst = cap->out + 3UL * cap->w * y;
+
+		dy = cap->out + (unsigned long) cap->w * y;
+		du = dy + n;
+		dv = du + n;
+
+		for (x = 0; x < sl->w; x++) {
+			if (sl->bpp == 4) {
+				val = ((const uint32_t *) src)[x];
+
+				r = (val >> 16) & 0xff;
+				g = (val >> 8) & 0xff;
+				b = val & 0xff;
+			}
+			else {
+				r = src[3 * x + 0];
+				g = src[3 * x + 1];
+				b = src[3 * x + 2];
+			}
+
+			if (cap->format == CAP_FORMAT_Y4M) {
+				/* ITU-R BT.601, limited range */
+				dy[x] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+				du[x] = (32896 + 112 * b - 38 * r - 74 * g) >> 8;
+				dv[x] = (32896 + 112 * r - 94 * g - 18 * b) >> 8;
+			}
+			else {
+				dst[3 * x + 0] = r;
+				dst[3 * x + 1] = g;
+				dst[3 * x + 2] = b;
+			}
+		}
+	}
+}
+
+/*
+ * Write the last output frame cnt times
+ */
+static
+int cap_write (capture_t *cap, unsigned cnt)
+{
+	unsigned long n;
+
+	n = 3UL * cap->w * cap->h;
+
+	while (cnt > 0) {
+		if (cap->format == CAP_FORMAT_Y4M) {
+			if (fputs ("FRAME\n", cap->fp) == EOF) {
+				return (1);
+			}
+		}
+
+		if (fwrite (cap->out, 1, n, cap->fp) != n) {
+			return (1);
+		}
+
+		cnt -= 1;
+	}
+
+	return (0);
+}
+
+/*
+ * Write the oldest slot in the ring buffer
+ *
+ * This is called without the lock held. The slot is owned by the
+ * writer while busy is set.
+ */
+static
+void cap_write_slot (capture_t *cap, const cap_slot_t *sl, unsigned cnt)
+{
+	if (cap->error) {
+		return;
+	}
+
+	if (sl->data) {
+		cap_convert (cap, sl);
+	}
+
+	if (cap_write (cap, cnt)) {
+		fprintf (stderr, "capture: write error\n");
+		cap->error = 1;
+	}
+}
+
+#ifdef PCE_ENABLE_PTHREAD
+
+static
+void *cap_thread (void *ext)
+{
+	unsigned   cnt;
+	cap_slot_t *sl;
+	capture_t  *cap;
+
+	cap = ext;
+
+	cap_lock (cap);
+
+	while (1) {
+		while ((cap->cnt == 0) && (cap->stop == 0)) {
+			pthread_cond_wait (&cap->cond, &cap->mutex);
+		}
+
+		if (cap->cnt == 0) {
+			break;
+		}
+
+		sl = &cap->slot[cap->rd];
+		cnt = sl->cnt;
+		cap->busy = 1;
+
+		cap_unlock (cap);
+
+		cap_write_slot (cap, sl, cnt);
+
+		cap_lock (cap);
+
+		cap->busy = 0;
+		cap->rd = (cap->rd + 1) % CAP_SLOT_CNT;
+		cap->cnt -= 1;
+
+		pthread_cond_broadcast (&cap->cond);
+	}
+
+	cap_unlock (cap);
+
+	fflush (cap->fp);
+
+	return (NULL);
+}
+
+/*
+ * Wait until the writers are between frames and flush their output
+ * before the process forks. Otherwise the child could write buffered
+ * data to the output file a second time when it exits.
+ */
+static
+void cap_fork_prepare (void)
+{
+	capture_t *cap;
+
+	pthread_mutex_lock (&cap_list_mutex);
+
+	cap = cap_list;
+
+	while (cap != NULL) {
+		cap_lock (cap);
+
+		while (cap->busy) {
+			pthread_cond_wait (&cap->cond, &cap->mutex);
+		}
+
+		fflush (cap->fp);
+
+		cap = cap->next;
+	}
+}
+
+static
+void cap_fork_parent (void)
+{
+	capture_t *cap;
+
+	cap = cap_list;
+
+	while (cap != NULL) {
+		cap_unlock (cap);
+		cap = cap->next;
+	}
+
+	pthread_mutex_unlock (&cap_list_mutex);
+}
+
+static
+void cap_fork_child (void)
+{
+	capture_t *cap;
+
+	cap = cap_list;
+
+	while (cap != NULL) {
+		cap->thread_ok = 0;
+		cap->forked = 1;
+		cap->cnt = 0;
+		cap->error = 1;
+
+		cap_unlock (cap);
+
+		cap = cap->next;
+	}
+
+	cap_list = NULL;
+
+	pthread_mutex_unlock (&cap_list_mutex);
+}
+
+static
+void cap_list_add (capture_t *cap)
+{
+	pthread_mutex_lock (&cap_list_mutex);
+
+	if (cap_atfork == 0) {
+		pthread_atfork (cap_fork_prepare, cap_fork_parent, cap_fork_child);
+		cap_atfork = 1;
+	}
+
+	cap->next = cap_list;
+	cap_list = cap;
+
+	pthread_mutex_unlock (&cap_list_mutex);
+}
+
+static
+void cap_list_rmv (capture_t *cap)
+{
+	capture_t **tmp;
+
+	pthread_mutex_lock (&cap_list_mutex);
+
+	tmp = &cap_list;
+
+	while (*tmp != NULL) {
+		if (*tmp == cap) {
+			*tmp = cap->next;
+			break;
+		}
+
+		tmp = &(*tmp)->next;
+	}
+
+	cap->next = NULL;
+
+	pthread_mutex_unlock (&cap_list_mutex);
+}
+
+#else
+
+/*
+ * Write all pending frames synchronously
+ */
+static
+void cap_flush (capture_t *cap)
+{
+	cap_slot_t *sl;
+
+	while (cap->cnt > 0) {
+		sl = &cap->slot[cap->rd];
+
+		cap_write_slot (cap, sl, sl->cnt);
+
+		cap->rd = (cap->rd + 1) % CAP_SLOT_CNT;
+		cap->cnt -= 1;
+	}
+}
+
+#endif
+
+/*
+ * Set the stream size and allocate the buffers
+ */
+static
+int cap_start (capture_t *cap, unsigned w, unsigned h)
+{
+	unsigned      i;
+	unsigned long n;
+
+	n = (unsigned long) w * h;
+
+	for (i = 0; i < CAP_SLOT_CNT; i++) {
+		if ((cap->slot[i].buf = malloc (4 * n)) == NULL) {
+			return (1);
+		}
+	}
+
+	if ((cap->out = malloc (3 * n)) == NULL) {
+		return (1);
+	}
+
+	cap->w = w;
+	cap->h = h;
+
+	if (cap->format == CAP_FORMAT_Y4M) {
+		fprintf (cap->fp, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C444\n",
+			w, h, cap->fps
+		);
+	}
+
+#ifdef PCE_ENABLE_PTHREAD
+	if (pthread_create (&cap->thread, NULL, cap_thread, cap)) {
+		return (1);
+	}
+
+	cap->thread_ok = 1;
+
+	cap_list_add (cap);
+#endif
+
+	return (0);
+}
+
+/*
+ * Check if a frame is identical to the frame in a slot
+ */
+static
+int cap_is_repeat (const cap_slot_t *sl, const unsigned char *buf,
+	unsigned w, unsigned cw, unsigned ch, unsigned bpp)
+{
+	unsigned      y;
+	unsigned long n;
+
+	if ((sl->w != cw) || (sl->h != ch) || (sl->bpp != bpp)) {
+		return (0);
+	}
+
+	n = (unsigned long) bpp * cw;
+
+	if (w == cw) {
+		return (memcmp (sl->buf, buf, n * ch) == 0);
+	}
+
+	for (y = 0; y < ch; y++) {
+		if (memcmp (sl->buf + n * y, buf + (unsigned long) bpp * w * y, n) != 0) {
+			return (0);
+		}
+	}
+
+	return (1);
+}
+
+void cap_frame (capture_t *cap, const unsigned char *buf,
+	unsigned w, unsigned h, unsigned bpp, int changed)
+{
+	unsigned      y, idx, cw, ch;
+	unsigned long n;
+	int           repeat, full;
+	cap_slot_t    *sl;
+
+	cap->step_cnt += 1;
+
+	if (cap->step_cnt < cap->step) {
+		return;
+	}
+
+	cap->step_cnt = 0;
+
+	if ((cap->error) || (w == 0) || (h == 0)) {
+		return;
+	}
+
+	if (cap->w == 0) {
+		if (cap_start (cap, w, h)) {
+			fprintf (stderr, "capture: can't start\n");
+			cap->error = 1;
+			return;
+		}
+	}
+
+	cap->frames += 1;
+
+	cw = (w < cap->w) ? w : cap->w;
+	ch = (h < cap->h) ? h : cap->h;
+
+	repeat = 0;
+
+	if (cap->last_ok) {
+		sl = &cap->slot[cap->last];
+
+		if ((changed == 0) && (sl->w == cw) && (sl->h == ch) && (sl->bpp == bpp)) {
+			repeat = 1;
+		}
+		else if (cap_is_repeat (sl, buf, w, cw, ch, bpp)) {
+			repeat = 1;
+		}
+	}
+
+	cap_lock (cap);
+
+	full = (cap->cnt >= CAP_SLOT_CNT);
+	idx = (cap->rd + cap->cnt) % CAP_SLOT_CNT;
+
+	if (repeat && (cap->cnt > 0) && ((cap->cnt > 1) || (cap->busy == 0))) {
+		/* the newest queued frame has not been taken yet */
+		cap->slot[(idx + CAP_SLOT_CNT - 1) % CAP_SLOT_CNT].cnt += 1;
+		cap->repeated += 1;
+		cap_unlock (cap);
+		return;
+	}
+
+	cap_unlock (cap);
+
+	if (full) {
+		cap->dropped += 1;
+		return;
+	}
+
+	/* slot idx is not owned by the writer, it can be filled unlocked */
+	sl = &cap->slot[idx];
+
+	sl->cnt = 1;
+	sl->data = (repeat == 0);
+
+	if (repeat) {
+		cap->repeated += 1;
+	}
+	else {
+		sl->w = cw;
+		sl->h = ch;
+		sl->bpp = bpp;
+
+		n = (unsigned long) bpp * cw;
+
+		for (y = 0; y < ch; y++) {
+			memcpy (sl->buf + n * y, buf + (unsigned long) bpp * w * y, n);
+		}
+
+		cap->last = idx;
+		cap->last_ok = 1;
+	}
+
+	cap_lock (cap);
+
+	cap->cnt += 1;
+
+#ifdef PCE_ENABLE_PTHREAD
+	pthread_cond_broadcast (&cap->cond);
+#endif
+
+	cap_unlock (cap);
+
+#ifndef PCE_ENABLE_PTHREAD
+	cap_flush (cap);
+#endif
+}
+
+void cap_print_info (capture_t *cap, FILE *fp)
+{
+	fprintf (fp, "CAPTURE: %s %ux%u FRAMES=%lu REPEATED=%lu DROPPED=%lu%s\n",
+		(cap->format == CAP_FORMAT_Y4M) ? "Y4M" : "RAW",
+		cap->w, cap->h,
+		cap->frames, cap->repeated, cap->dropped,
+		cap->error ? " ERROR" : ""
+	);
+}
+
+capture_t *cap_new (const char *fname, unsigned format, unsigned step, unsigned fps)
+{
+	unsigned  i;
+	capture_t *cap;
+
+	if ((cap = malloc (sizeof (capture_t))) == NULL) {
+		return (NULL);
+	}
+
+	if ((cap->fp = fopen (fname, "wb")) == NULL) {
+		free (cap);
+		return (NULL);
+	}
+
+	cap->format = format;
+	cap->step = (step > 0) ? step : 1;
+	cap->step_cnt = cap->step - 1;
+	cap->fps = (fps > 0) ? fps : 60;
+
+	cap->w = 0;
+	cap->h = 0;
+
+	cap->rd = 0;
+	cap->cnt = 0;
+
+	for (i = 0; i < CAP_SLOT_CNT; i++) {
+		cap->slot[i].cnt = 0;
+		cap->slot[i].data = 0;
+		cap->slot[i].w = 0;
+		cap->slot[i].h = 0;
+		cap->slot[i].bpp = 0;
+		cap->slot[i].buf = NULL;
+	}
+
+	cap->last = 0;
+	cap->last_ok = 0;
+	cap->busy = 0;
+
+	cap->out = NULL;
+
+	cap->stop = 0;
+	cap->error = 0;
+
+	cap->frames = 0;
+	cap->repeated = 0;
+	cap->dropped = 0;
+
+#ifdef PCE_ENABLE_PTHREAD
+	cap->thread_ok = 0;
+	pthread_mutex_init (&cap->mutex, NULL);
+	pthread_cond_init (&cap->cond, NULL);
+	cap->forked = 0;
+	cap->next = NULL;
+#endif
+
+	return (cap);
+}
+
+void cap_del (capture_t *cap)
+{
+	unsigned i;
+
+	if (cap == NULL) {
+		return;
+	}
+
+#ifdef PCE_ENABLE_PTHREAD
+	if (cap->thread_ok) {
+		cap_list_rmv (cap);
+
+		cap_lock (cap);
+		cap->stop = 1;
+		pthread_cond_broadcast (&cap->cond);
+		cap_unlock (cap);
+
+		pthread_join (cap->thread, NULL);
+	}
+
+	if (cap->forked == 0) {
+		pthread_cond_destroy (&cap->cond);
+		pthread_mutex_destroy (&cap->mutex);
+	}
+#endif
+
+	fclose (cap->fp);
+
+	for (i = 0; i < CAP_SLOT_CNT; i++) {
+		free (cap->slot[i].buf);
+	}
+
+	free (cap->out);
+	free (cap);
+}
@@ -0,0 +1,157 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/drivers/video/capture.h                                  *
+ * Created:     2026-10-19 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#ifndef PCE_VIDEO_CAPTURE_H
+#define PCE_VIDEO_CAPTURE_H 1
+
+
+#include <config.h>
+
+#include <stdio.h>
+
+#ifdef PCE_ENABLE_PTHREAD
+#include <pthread.h>
+#endif
+
+
+#define CAP_FORMAT_RAW 0
+#define CAP_FORMAT_Y4M 1
+
+/* the number of frames in the ring buffer */
+#define CAP_SLOT_CNT 16
+
+
+typedef struct {
+	/* the number of times this frame is written */
+	unsigned      cnt;
+
+	/* if 0, the frame is a repeat of the previous frame */
+	int           data;
+
+	/* the frame size, clipped to the stream size */
+	unsigned      w;
+	unsigned      h;
+	unsigned      bpp;
+
+	unsigned char *buf;
+} cap_slot_t;
+
+
+typedef struct capture_t {
+	FILE          *fp;
+
+	unsigned      format;
+
+	/* write every step'th frame */
+	unsigned      step;
+	unsigned      step_cnt;
+
+	unsigned      fps;
+
+	/* the stream size, set from the first frame */
+	unsigned      w;
+	unsigned      h;
+
+	/* the ring buffer, owned by the writer from rd to rd + cnt */
+	unsigned      rd;
+	unsigned      cnt;
+	cap_slot_t    slot[CAP_SLOT_CNT];
+
+	/* the slot that contains the previous frame */
+	unsigned      last;
+	int           last_ok;
+
+	/* set if the writer has taken slot rd */
+	int           busy;
+
+	/* the last output frame */
+	unsigned long out_cnt;
+	unsigned char *out;
+
+	int           stop;
+	int           error;
+
+	/* statistics */
+	unsigned long frames;
+	unsigned long repeated;
+	unsigned long dropped;
+
+#ifdef PCE_ENABLE_PTHREAD
+	int             thread_ok;
+	pthread_t       thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t  cond;
+
+	/* set in a child process after fork() */
+	int             forked;
+
+	/* the list of captures with a writer thread */
+	struct capture_t *next;
+#endif
+} capture_t;
+
+
+/*!***************************************************************************
+ * @short  Start a video capture
+ * @param  fname  The output file name. This can also be a named pipe.
+ * @param  format The output format, CAP_FORMAT_RAW or CAP_FORMAT_Y4M
+ * @param  step   Only every step'th frame is written
+ * @param  fps    The frame rate written to the Y4M header
+ * @return The capture or NULL on error
+ *
+ * Raw output consists of the frames as 8 bit RGB triples, without any
+ * header. Y4M output uses the C444 color space.
+ *
+ * If threads are available, frames are written by a separate thread and
+ * the emulator never waits for the output. Frames are dropped if the
+ * ring buffer is full.
+ *
+ * A capture is stopped in a child process after fork(). Only the parent
+ * writes to the output file.
+ *****************************************************************************/
+capture_t *cap_new (const char *fname, unsigned format, unsigned step, unsigned fps);
+
+/*!***************************************************************************
+ * @short Stop a video capture
+ *
+ * All pending frames are written before the output file is closed.
+ *****************************************************************************/
+void cap_del (capture_t *cap);
+
+/*!***************************************************************************
+ * @short Add a frame
+ * @param buf     The frame, in the terminal buffer format
+ * @param bpp     The bytes per pixel, 3 or 4 (see trm_set_bpp())
+ * @param changed If 0, the frame is known to be identical to the
+ *                previous one.
+ *
+ * The stream size is set by the first frame. Later frames are clipped
+ * or padded with black to that size.
+ *****************************************************************************/
+void cap_frame (capture_t *cap, const unsigned char *buf,
+	unsigned w, unsigned h, unsigned bpp, int changed
+);
+
+void cap_print_info (capture_t *cap, FILE *fp);
+
+
+#endif
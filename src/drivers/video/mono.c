@@ -0,0 +1,78 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/drivers/video/mono.c                                     *
+ * Created:     2026-10-18 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#include <string.h>
+
+#include <drivers/video/mono.h>
+#include <drivers/video/terminal.h>
+
+
+static
+void mono_tab_build (mono_tab_t *tab)
+{
+	unsigned i, j;
+	uint32_t c0, c1;
+	uint32_t *dst;
+
+	c0 = TRM_XRGB (tab->col0[0], tab->col0[1], tab->col0[2]);
+	c1 = TRM_XRGB (tab->col1[0], tab->col1[1], tab->col1[2]);
+
+	dst = tab->tab;
+
+	for (i = 0; i < 256; i++) {
+		for (j = 0; j < 8; j++) {
+			*(dst++) = (i & (0x80 >> j)) ? c1 : c0;
+		}
+	}
+}
+
+void mono_tab_init (mono_tab_t *tab, const unsigned char *col0,
+	const unsigned char *col1)
+{
+	memcpy (tab->col0, col0, 3);
+	memcpy (tab->col1, col1, 3);
+
+	mono_tab_build (tab);
+}
+
+void mono_tab_set_color (mono_tab_t *tab, const unsigned char *col0,
+	const unsigned char *col1)
+{
+	if ((memcmp (tab->col0, col0, 3) == 0) && (memcmp (tab->col1, col1, 3) == 0)) {
+		return;
+	}
+
+	mono_tab_init (tab, col0, col1);
+}
+
+void mono_tab_expand (const mono_tab_t *tab, unsigned char *dst,
+	const unsigned char *src, unsigned long cnt)
+{
+	while (cnt > 0) {
+		/* a fixed size copy that the compiler turns into vector moves */
+		memcpy (dst, tab->tab + 8 * *src, 32);
+
+		dst += 32;
+		src += 1;
+		cnt -= 1;
+	}
+}
@@ -0,0 +1,68 @@
+/*****************************************************************************
+ * pce                                                                       *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * File name:   src/drivers/video/mono.h                                     *
+ * Created:     2026-10-18 by Hampa Hug <hampa@hampa.ch>                     *
+ * Copyright:   (C) 2026 Hampa Hug <hampa@hampa.ch>                          *
+ *****************************************************************************/
+
+/*****************************************************************************
+ * This program is free software. You can redistribute it and / or modify it *
+ * under the terms of the GNU General Public License version 2 as  published *
+ * by the Free Software Foundation.                                          *
+ *                                                                           *
+ * This program is distributed in the hope  that  it  will  be  useful,  but *
+ * WITHOUT  ANY   WARRANTY,   without   even   the   implied   warranty   of *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU  General *
+ * Public License for more details.                                          *
+ *****************************************************************************/
+
+
+#ifndef PCE_VIDEO_MONO_H
+#define PCE_VIDEO_MONO_H 1
+
+
+#include <stdint.h>
+
+
+/*!***************************************************************************
+ * @short A table that expands one byte of a 1 bpp bitmap to 8 pixels
+ *
+ * The pixels are 32 bit words as created by TRM_XRGB(). Bit 7 is the
+ * leftmost pixel.
+ *****************************************************************************/
+typedef struct {
+	unsigned char col0[3];
+	unsigned char col1[3];
+
+	uint32_t      tab[256 * 8];
+} mono_tab_t;
+
+
+/*!***************************************************************************
+ * @short Initialize an expansion table
+ * @param col0 The RGB color for 0 bits
+ * @param col1 The RGB color for 1 bits
+ *****************************************************************************/
+void mono_tab_init (mono_tab_t *tab, const unsigned char *col0,
+	const unsigned char *col1);
+
+/*!***************************************************************************
+ * @short Set the colors
+ *
+ * The table is only rebuilt if the colors actually change, so this
+ * can be called before every use.
+ *****************************************************************************/
+void mono_tab_set_color (mono_tab_t *tab, const unsigned char *col0,
+	const unsigned char *col1);
+
+/*!***************************************************************************
+ * @short Expand cnt bytes from src to 8 * cnt pixels (32 * cnt bytes) in dst
+ *****************************************************************************/
+void mono_tab_expand (const mono_tab_t *tab, unsigned char *dst,
+	const unsigned char *src, unsigned long cnt);
+
+
+#endif
@@ -373,17 +373,28 @@ void sdl_update (sdl_t *sdl)
 		return;
 	}
 
+	if (trm->bpp == 4) {
+		rmask = 0x00ff0000;
+		gmask = 0x0000ff00;
+		bmask = 0x000000ff;
+	}
+	else {
 #if SDL_BYTEORDER == SDL_BIG_ENDIAN
-	rmask = 0x00ff0000;
-	gmask = 0x0000ff00;
-	bmask = 0x000000ff;
+		rmask = 0x00ff0000;
+		gmask = 0x0000ff00;
+		bmask = 0x000000ff;
 #else
-	rmask = 0x000000ff;
-	gmask = 0x0000ff00;
-	bmask = 0x00ff0000;
+		rmask = 0x000000ff;
+		gmask = 0x0000ff00;
+		bmask = 0x00ff0000;
 #endif
+	}
 
-	buf = trm_scale (trm, trm->buf, trm->w, trm->h, fx, fy);
+	buf = trm_scale_update (trm, fx, fy);
+
+	if (buf == NULL) {
+		return;
+	}
 
 	ux = fx * trm->update_x;
 	uy = fy * trm->update_y;
@@ -391,7 +402,7 @@ void sdl_update (sdl_t *sdl)
 	uh = fy * trm->update_h;
 
 	s = SDL_CreateRGBSurfaceFrom (
-		(char *) buf + 3 * (dw * uy + ux), uw, uh, 24, 3 * dw,
+		(char *) buf + trm->bpp * (dw * uy + ux), uw, uh, 8 * trm->bpp, trm->bpp * dw,
 		rmask, gmask, bmask, 0
 	);
 
@@ -301,6 +301,7 @@ static
 int sdl2_set_frame_size (sdl2_t *sdl)
 {
 	unsigned tw, th;
+	Uint32   *tmp;
 
 	tw = sdl->trm.w;
 	th = sdl->trm.h;
@@ -318,8 +319,16 @@ int sdl2_set_frame_size (sdl2_t *sdl)
 		sdl->texture = NULL;
 	}
 
+	tmp = realloc (sdl->pix, 4UL * tw * th);
+
+	if (tmp == NULL) {
+		return (1);
+	}
+
+	sdl->pix = tmp;
+
 	sdl->texture = SDL_CreateTexture (sdl->render,
-		SDL_PIXELFORMAT_RGB24, SDL_TEXTUREACCESS_STREAMING, tw, th
+		SDL_PIXELFORMAT_RGB888, SDL_TEXTUREACCESS_STREAMING, tw, th
 	);
 
 	if (sdl->texture == NULL) {
@@ -330,6 +339,8 @@ int sdl2_set_frame_size (sdl2_t *sdl)
 	sdl->txt_w = tw;
 	sdl->txt_h = th;
 
+	sdl->upload_all = 1;
+
 	return (0);
 }
 
@@ -347,12 +358,57 @@ unsigned sdl2_map_key (sdl2_t *sdl, SDL_Scancode key)
 	return (PCE_KEY_NONE);
 }
 
+/*
+ * Upload a rectangle of the terminal buffer to the texture, converting
+ * it to 32 bits per pixel if necessary.
+ */
+static
+void sdl2_upload (sdl2_t *sdl, unsigned x, unsigned y, unsigned w, unsigned h)
+{
+	unsigned            i, j;
+	unsigned long       ofs;
+	const unsigned char *src;
+	Uint32              *dst;
+	SDL_Rect            rect;
+
+	rect.x = x;
+	rect.y = y;
+	rect.w = w;
+	rect.h = h;
+
+	ofs = (unsigned long) sdl->trm.w * y + x;
+
+	if (sdl->trm.bpp == 4) {
+		/* the terminal buffer is already in the texture format */
+		SDL_UpdateTexture (sdl->texture, &rect,
+			sdl->trm.buf + 4 * ofs, 4 * sdl->trm.w
+		);
+
+		return;
+	}
+
+	for (j = 0; j < h; j++) {
+		ofs = (unsigned long) sdl->trm.w * (y + j) + x;
+
+		src = sdl->trm.buf + 3 * ofs;
+		dst = sdl->pix + ofs;
+
+		for (i = 0; i < w; i++) {
+			dst[i] = ((Uint32) src[0] << 16) | ((Uint32) src[1] << 8) | src[2];
+			src += 3;
+		}
+	}
+
+	ofs = (unsigned long) sdl->trm.w * y + x;
+
+	SDL_UpdateTexture (sdl->texture, &rect, sdl->pix + ofs, 4 * sdl->trm.w);
+}
+
 static
 void sdl2_update (sdl2_t *sdl)
 {
 	terminal_t *trm;
-	void       *pixels;
-	int        pitch;
+	unsigned   x, y, w, h;
 
 	trm = &sdl->trm;
 
@@ -370,9 +426,39 @@ void sdl2_update (sdl2_t *sdl)
 		return;
 	}
 
-	SDL_LockTexture (sdl->texture, NULL, &pixels, &pitch);
-	memcpy (pixels, trm->buf, 3UL * trm->w * trm->h);
-	SDL_UnlockTexture (sdl->texture);
+	if (sdl->upload_all) {
+		x = 0;
+		y = 0;
+		w = trm->w;
+		h = trm->h;
+
+		sdl->upload_all = 0;
+	}
+	else {
+		/* only upload the part of the image that has changed */
+		x = trm->update_x;
+		y = trm->update_y;
+		w = trm->update_w;
+		h = trm->update_h;
+
+		if ((x >= trm->w) || (y >= trm->h)) {
+			w = 0;
+			h = 0;
+		}
+		else {
+			if ((x + w) > trm->w) {
+				w = trm->w - x;
+			}
+
+			if ((y + h) > trm->h) {
+				h = trm->h - y;
+			}
+		}
+	}
+
+	if ((w > 0) && (h > 0)) {
+		sdl2_upload (sdl, x, y, w, h);
+	}
 
 	SDL_RenderCopy (sdl->render, sdl->texture, NULL, NULL);
 	SDL_RenderPresent (sdl->render);
@@ -616,6 +702,12 @@ void sdl2_check (sdl2_t *sdl)
 		case SDL_AUDIODEVICEADDED:
 			break;
 
+		case SDL_RENDER_TARGETS_RESET:
+		case SDL_RENDER_DEVICE_RESET:
+			sdl->upload_all = 1;
+			sdl->update = 1;
+			break;
+
 		default:
 			fprintf (stderr, "sdl2: event %u\n", evt.type);
 			break;
@@ -677,6 +769,7 @@ int sdl2_set_msg_trm (sdl2_t *sdl, const char *msg, const char *val)
 static
 void sdl2_del (sdl2_t *sdl)
 {
+	free (sdl->pix);
 	free (sdl);
 }
 
@@ -685,7 +778,7 @@ int sdl2_open (sdl2_t *sdl, unsigned w, unsigned h)
 {
 	unsigned x, y;
 	unsigned fx, fy;
-	unsigned flags;
+	unsigned flags, rflags;
 
 	trm_get_scale (&sdl->trm, w, h, &fx, &fy);
 
@@ -734,7 +827,13 @@ int sdl2_open (sdl2_t *sdl, unsigned w, unsigned h)
 	sdl->wdw_w = w;
 	sdl->wdw_h = h;
 
-	sdl->render = SDL_CreateRenderer (sdl->window, -1, 0);
+	rflags = 0;
+
+	if (sdl->vsync) {
+		rflags |= SDL_RENDERER_PRESENTVSYNC;
+	}
+
+	sdl->render = SDL_CreateRenderer (sdl->window, -1, rflags);
 
 	if (sdl->render == NULL) {
 		fprintf (stderr, "sdl2: renderer\n");
@@ -754,6 +853,9 @@ int sdl2_close (sdl2_t *sdl)
 		sdl->texture = NULL;
 	}
 
+	sdl->txt_w = 0;
+	sdl->txt_h = 0;
+
 	if (sdl->render != NULL) {
 		SDL_DestroyRenderer (sdl->render);
 		sdl->render = NULL;
@@ -770,7 +872,7 @@ int sdl2_close (sdl2_t *sdl)
 static
 void sdl2_init (sdl2_t *sdl, ini_sct_t *sct)
 {
-	int fs, rep;
+	int fs, rep, vsync;
 
 	trm_init (&sdl->trm, sdl);
 
@@ -788,6 +890,9 @@ void sdl2_init (sdl2_t *sdl, ini_sct_t *sct)
 	sdl->txt_w = 0;
 	sdl->txt_h = 0;
 
+	sdl->pix = NULL;
+	sdl->upload_all = 1;
+
 	sdl->wdw_w = 0;
 	sdl->wdw_h = 0;
 
@@ -803,6 +908,9 @@ void sdl2_init (sdl2_t *sdl, ini_sct_t *sct)
 	ini_get_bool (sct, "report_keys", &rep, 0);
 	sdl->report_keys = (rep != 0);
 
+	ini_get_bool (sct, "vsync", &vsync, 0);
+	sdl->vsync = (vsync != 0);
+
 	sdl->autosize = 1;
 
 	sdl->grave_down = 0;
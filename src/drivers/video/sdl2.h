@@ -52,12 +52,17 @@ typedef struct {
 	unsigned      txt_w;
 	unsigned      txt_h;
 
+	/* the texture contents in 32 bit XRGB format */
+	Uint32        *pix;
+
 	unsigned      wdw_w;
 	unsigned      wdw_h;
 
 	unsigned      button;
 
 	char          update;
+	char          upload_all;
+	char          vsync;
 	char          fullscreen;
 	char          grab;
 	char          report_keys;
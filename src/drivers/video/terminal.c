@@ -28,6 +28,8 @@
 
 #include <drivers/video/terminal.h>
 
+#include <lib/sysdep.h>
+
 
 #define TRM_ESC_ESC  1
 #define TRM_ESC_OK   2
@@ -61,6 +63,7 @@ void trm_init (terminal_t *trm, void *ext)
 
 	trm->w = 0;
 	trm->h = 0;
+	trm->bpp = 3;
 
 	trm->buf_cnt = 0;
 	trm->buf = NULL;
@@ -83,11 +86,30 @@ void trm_init (terminal_t *trm, void *ext)
 	trm->scale_buf_cnt = 0;
 	trm->scale_buf = NULL;
 
+	trm->scale_fx = 0;
+	trm->scale_fy = 0;
+	trm->scale_w = 0;
+	trm->scale_h = 0;
+	trm->scale_bpp = 0;
+
 	trm->update_x = 0;
 	trm->update_y = 0;
 	trm->update_w = 0;
 	trm->update_h = 0;
 
+	trm->frame_skip_max = 0;
+	trm->frame_skip = 0;
+	trm->frame_clk = 0;
+	trm->frame_lag = 0;
+	trm->frame_cost = 0;
+	trm->frame_render = 0;
+	trm->frame_cnt = 0;
+	trm->frame_skipped = 0;
+
+	trm->capture = NULL;
+	trm->capture_step = 1;
+	trm->capture_fps = 60;
+
 	trm->pict_index = 0;
 }
 
@@ -95,6 +117,9 @@ void trm_free (terminal_t *trm)
 {
 	trm_close (trm);
 
+	cap_del (trm->capture);
+	trm->capture = NULL;
+
 	free (trm->buf);
 	free (trm->scale_buf);
 }
@@ -170,7 +195,9 @@ int trm_screenshot (terminal_t *trm, const char *fname)
 {
 	FILE          *fp;
 	char          str[256];
-	unsigned long cnt;
+	unsigned long i, cnt;
+	unsigned char rgb[3];
+	uint32_t      val;
 
 	if ((fname == NULL) || (fname[0] == 0)) {
 		sprintf (str, "pce%04u.ppm", trm->pict_index);
@@ -188,7 +215,23 @@ int trm_screenshot (terminal_t *trm, const char *fname)
 
 	fprintf (fp, "P6\n%u %u\n%u\x0a", trm->w, trm->h, 255);
 
-	if (fwrite (trm->buf, 1, cnt, fp) != cnt) {
+	if (trm->bpp == 4) {
+		cnt = (unsigned long) trm->w * (unsigned long) trm->h;
+
+		for (i = 0; i < cnt; i++) {
+			val = ((const uint32_t *) trm->buf)[i];
+
+			rgb[0] = (val >> 16) & 0xff;
+			rgb[1] = (val >> 8) & 0xff;
+			rgb[2] = val & 0xff;
+
+			if (fwrite (rgb, 1, 3, fp) != 3) {
+				fclose (fp);
+				return (1);
+			}
+		}
+	}
+	else if (fwrite (trm->buf, 1, cnt, fp) != cnt) {
 		fclose (fp);
 		return (1);
 	}
@@ -198,6 +241,38 @@ int trm_screenshot (terminal_t *trm, const char *fname)
 	return (0);
 }
 
+int trm_set_capture (terminal_t *trm, const char *fname, unsigned step, unsigned fps)
+{
+	unsigned n, format;
+
+	cap_del (trm->capture);
+	trm->capture = NULL;
+
+	trm->capture_step = step;
+	trm->capture_fps = fps;
+
+	if ((fname == NULL) || (fname[0] == 0)) {
+		return (0);
+	}
+
+	n = strlen (fname);
+
+	if ((n >= 4) && (strcmp (fname + n - 4, ".y4m") == 0)) {
+		format = CAP_FORMAT_Y4M;
+	}
+	else {
+		format = CAP_FORMAT_RAW;
+	}
+
+	trm->capture = cap_new (fname, format, step, fps);
+
+	if (trm->capture == NULL) {
+		return (1);
+	}
+
+	return (0);
+}
+
 int trm_set_msg_trm (terminal_t *trm, const char *msg, const char *val)
 {
 	if (strcmp (msg, "term.escape") == 0) {
@@ -210,6 +285,19 @@ int trm_set_msg_trm (terminal_t *trm, const char *msg, const char *val)
 		return (0);
 	}
 
+	if (strcmp (msg, "term.capture") == 0) {
+		if (trm_set_capture (trm, val, trm->capture_step, trm->capture_fps)) {
+			return (1);
+		}
+
+		return (0);
+	}
+
+	if (strcmp (msg, "term.frame_skip") == 0) {
+		trm_set_frame_skip (trm, strtoul (val, NULL, 0));
+		return (0);
+	}
+
 	if (trm->set_msg_trm != NULL) {
 		return (trm->set_msg_trm (trm->ext, msg, val));
 	}
@@ -248,7 +336,7 @@ void trm_set_size (terminal_t *trm, unsigned w, unsigned h)
 		return;
 	}
 
-	cnt = 3 * (unsigned long) w * (unsigned long) h;
+	cnt = trm->bpp * (unsigned long) w * (unsigned long) h;
 
 	if (trm->buf_cnt != cnt) {
 		unsigned char *tmp;
@@ -271,6 +359,25 @@ void trm_set_size (terminal_t *trm, unsigned w, unsigned h)
 	trm->update_h = h;
 }
 
+void trm_set_bpp (terminal_t *trm, unsigned bpp)
+{
+	unsigned w, h;
+
+	bpp = (bpp == 4) ? 4 : 3;
+
+	if (trm->bpp == bpp) {
+		return;
+	}
+
+	w = trm->w;
+	h = trm->h;
+
+	trm->bpp = bpp;
+
+	trm_set_size (trm, 0, 0);
+	trm_set_size (trm, w, h);
+}
+
 void trm_set_min_size (terminal_t *trm, unsigned w, unsigned h)
 {
 	trm->min_w = w;
@@ -297,11 +404,17 @@ void trm_set_pixel (terminal_t *trm, unsigned x, unsigned y, const unsigned char
 {
 	unsigned char *buf;
 
-	buf = trm->buf + 3 * (trm->w * y + x);
+	if (trm->bpp == 4) {
+		buf = trm->buf + 4 * (trm->w * y + x);
+		*(uint32_t *) buf = TRM_XRGB (col[0], col[1], col[2]);
+	}
+	else {
+		buf = trm->buf + 3 * (trm->w * y + x);
 
-	buf[0] = col[0];
-	buf[1] = col[1];
-	buf[2] = col[2];
+		buf[0] = col[0];
+		buf[1] = col[1];
+		buf[2] = col[2];
+	}
 
 	if (trm->update_w == 0) {
 		trm->update_x = x;
@@ -340,7 +453,7 @@ void trm_set_lines (terminal_t *trm, const void *buf, unsigned y, unsigned cnt)
 	const unsigned char *src;
 	unsigned char       *dst;
 
-	w3 = 3UL * trm->w;
+	w3 = (unsigned long) trm->bpp * trm->w;
 
 	src = buf;
 	dst = trm->buf + w3 * y;
@@ -393,9 +506,36 @@ void trm_set_lines (terminal_t *trm, const void *buf, unsigned y, unsigned cnt)
 	}
 }
 
+/*
+ * Update the average frame rendering cost
+ */
+static
+void trm_end_frame (terminal_t *trm)
+{
+	unsigned long clk, dt;
+
+	if (trm->frame_render == 0) {
+		return;
+	}
+
+	trm->frame_render = 0;
+
+	clk = trm->frame_clk;
+	dt = pce_get_interval_us (&clk);
+
+	trm->frame_cost = (3 * trm->frame_cost + dt) / 4;
+}
+
 void trm_update (terminal_t *trm)
 {
+	if (trm->capture != NULL) {
+		cap_frame (trm->capture, trm->buf, trm->w, trm->h, trm->bpp,
+			(trm->update_w > 0) && (trm->update_h > 0)
+		);
+	}
+
 	if ((trm->update_w == 0) || (trm->update_h == 0)) {
+		trm_end_frame (trm);
 		return;
 	}
 
@@ -407,6 +547,70 @@ void trm_update (terminal_t *trm)
 	trm->update_y = 0;
 	trm->update_w = 0;
 	trm->update_h = 0;
+
+	trm_end_frame (trm);
+}
+
+void trm_set_frame_skip (terminal_t *trm, unsigned max)
+{
+	trm->frame_skip_max = max;
+	trm->frame_skip = 0;
+	trm->frame_lag = 0;
+}
+
+int trm_skip_frame (terminal_t *trm, unsigned long us)
+{
+	unsigned long dt;
+
+	trm->frame_cnt += 1;
+	trm->frame_render = 0;
+
+	if (trm->frame_skip_max == 0) {
+		return (0);
+	}
+
+	dt = pce_get_interval_us (&trm->frame_clk);
+
+	if (dt > us) {
+		trm->frame_lag += dt - us;
+	}
+	else if (trm->frame_lag > (us - dt)) {
+		trm->frame_lag -= us - dt;
+	}
+	else {
+		trm->frame_lag = 0;
+	}
+
+	/* don't try to catch up after the emulator was stopped */
+	if (trm->frame_lag > (8 * us)) {
+		trm->frame_lag = 8 * us;
+	}
+
+	if ((us > 0) && (trm->frame_skip < trm->frame_skip_max)) {
+		if ((trm->frame_lag > us) && (trm->frame_lag > trm->frame_cost)) {
+			trm->frame_skip += 1;
+			trm->frame_skipped += 1;
+			return (1);
+		}
+	}
+
+	trm->frame_skip = 0;
+	trm->frame_render = 1;
+
+	return (0);
+}
+
+void trm_print_info (terminal_t *trm, FILE *fp)
+{
+	fprintf (fp, "TRM: FRAMES=%lu SKIPPED=%lu SKIP=%u/%u COST=%lu us LAG=%lu us\n",
+		trm->frame_cnt, trm->frame_skipped,
+		trm->frame_skip, trm->frame_skip_max,
+		trm->frame_cost, trm->frame_lag
+	);
+
+	if (trm->capture != NULL) {
+		cap_print_info (trm->capture, fp);
+	}
 }
 
 void trm_check (terminal_t *trm)
@@ -692,7 +896,7 @@ unsigned char *trm_scale_get_buf (terminal_t *trm, unsigned w, unsigned h)
 	unsigned long cnt;
 	unsigned char *tmp;
 
-	cnt = 3 * (unsigned long) w * (unsigned long) h;
+	cnt = trm->bpp * (unsigned long) w * (unsigned long) h;
 
 	if (cnt > trm->scale_buf_cnt) {
 		tmp = realloc (trm->scale_buf, cnt);
@@ -707,34 +911,74 @@ unsigned char *trm_scale_get_buf (terminal_t *trm, unsigned w, unsigned h)
 	return (trm->scale_buf);
 }
 
+/*
+ * Scale one row by fx in x direction
+ */
 static
-void trm_scale_w1 (unsigned char *dst, const unsigned char *src, unsigned w, unsigned h, unsigned fy)
+void trm_scale_row (unsigned char *dst, const unsigned char *src, unsigned w, unsigned fx, unsigned bpp)
 {
-	unsigned i, n, y;
+	unsigned       i, x;
+	uint32_t       val;
+	const uint32_t *s32;
+	uint32_t       *d32;
 
-	n = 3 * w;
+	if (fx == 1) {
+		memcpy (dst, src, (unsigned long) bpp * w);
+		return;
+	}
 
-	for (y = 0; y < h; y++) {
-		memcpy (dst, src, n);
+	if (bpp == 4) {
+		s32 = (const uint32_t *) src;
+		d32 = (uint32_t *) dst;
+
+		switch (fx) {
+		case 2:
+			for (x = 0; x < w; x++) {
+				val = s32[x];
+				d32[0] = val;
+				d32[1] = val;
+				d32 += 2;
+			}
+			break;
 
-		dst += n;
-		src += n;
+		case 3:
+			for (x = 0; x < w; x++) {
+				val = s32[x];
+				d32[0] = val;
+				d32[1] = val;
+				d32[2] = val;
+				d32 += 3;
+			}
+			break;
 
-		for (i = 1; i < fy; i++) {
-			memcpy (dst, dst - n, n);
-			dst += n;
-		}
-	}
-}
+		case 4:
+			for (x = 0; x < w; x++) {
+				val = s32[x];
+				d32[0] = val;
+				d32[1] = val;
+				d32[2] = val;
+				d32[3] = val;
+				d32 += 4;
+			}
+			break;
 
-static
-void trm_scale_w2 (unsigned char *dst, const unsigned char *src, unsigned w, unsigned h, unsigned fy)
-{
-	unsigned i, n, x, y;
+		default:
+			for (x = 0; x < w; x++) {
+				val = s32[x];
 
-	n = 6 * w;
+				for (i = 0; i < fx; i++) {
+					d32[i] = val;
+				}
+
+				d32 += fx;
+			}
+			break;
+		}
 
-	for (y = 0; y < h; y++) {
+		return;
+	}
+
+	if (fx == 2) {
 		for (x = 0; x < w; x++) {
 			dst[0] = src[0];
 			dst[1] = src[1];
@@ -747,37 +991,47 @@ void trm_scale_w2 (unsigned char *dst, const unsigned char *src, unsigned w, uns
 			src += 3;
 		}
 
-		for (i = 1; i < fy; i++) {
-			memcpy (dst, dst - n, n);
-			dst += n;
+		return;
+	}
+
+	for (x = 0; x < w; x++) {
+		for (i = 0; i < fx; i++) {
+			dst[0] = src[0];
+			dst[1] = src[1];
+			dst[2] = src[2];
+
+			dst += 3;
 		}
+
+		src += 3;
 	}
 }
 
+/*
+ * Scale the source rows y to y + h - 1 into the destination buffer
+ */
 static
-void trm_scale_wx (unsigned char *dst, const unsigned char *src, unsigned w, unsigned h, unsigned fx, unsigned fy)
+void trm_scale_rows (unsigned char *dst, const unsigned char *src,
+	unsigned w, unsigned y, unsigned h, unsigned fx, unsigned fy, unsigned bpp)
 {
-	unsigned i, j, n, x, y;
+	unsigned      i, j;
+	unsigned long sn, dn;
 
-	n = 3 * fx * w;
+	sn = (unsigned long) bpp * w;
+	dn = fx * sn;
 
-	for (y = 0; y < h; y++) {
-		for (x = 0; x < w; x++) {
-			for (i = 0; i < fx; i++) {
-				dst[0] = src[0];
-				dst[1] = src[1];
-				dst[2] = src[2];
+	src += sn * y;
+	dst += dn * fy * y;
 
-				dst += 3;
-			}
+	for (j = 0; j < h; j++) {
+		trm_scale_row (dst, src, w, fx, bpp);
 
-			src += 3;
+		for (i = 1; i < fy; i++) {
+			memcpy (dst + i * dn, dst, dn);
 		}
 
-		for (j = 1; j < fy; j++) {
-			memcpy (dst, dst - n, n);
-			dst += n;
-		}
+		src += sn;
+		dst += fy * dn;
 	}
 }
 
@@ -801,15 +1055,59 @@ const unsigned char *trm_scale (terminal_t *trm,
 		return (NULL);
 	}
 
-	if (fx == 1) {
-		trm_scale_w1 (dst, src, w, h, fy);
+	/* the scale buffer no longer holds the scaled terminal buffer */
+	trm->scale_fx = 0;
+	trm->scale_fy = 0;
+
+	trm_scale_rows (dst, src, w, 0, h, fx, fy, trm->bpp);
+
+	return (dst);
+}
+
+const unsigned char *trm_scale_update (terminal_t *trm, unsigned fx, unsigned fy)
+{
+	unsigned      y, h;
+	unsigned char *dst;
+
+	if ((fx == 1) && (fy == 1)) {
+		trm->scale_fx = 0;
+		trm->scale_fy = 0;
+		return (trm->buf);
 	}
-	else if (fx == 2) {
-		trm_scale_w2 (dst, src, w, h, fy);
+
+	dst = trm_scale_get_buf (trm, fx * trm->w, fy * trm->h);
+
+	if (dst == NULL) {
+		return (NULL);
+	}
+
+	if ((trm->scale_fx == fx) && (trm->scale_fy == fy) &&
+		(trm->scale_w == trm->w) && (trm->scale_h == trm->h) &&
+		(trm->scale_bpp == trm->bpp))
+	{
+		/* only rescale the rows that have changed */
+		y = trm->update_y;
+		h = trm->update_h;
+
+		if (y >= trm->h) {
+			h = 0;
+		}
+		else if ((y + h) > trm->h) {
+			h = trm->h - y;
+		}
 	}
 	else {
-		trm_scale_wx (dst, src, w, h, fx, fy);
+		y = 0;
+		h = trm->h;
 	}
 
+	trm_scale_rows (dst, trm->buf, trm->w, y, h, fx, fy, trm->bpp);
+
+	trm->scale_fx = fx;
+	trm->scale_fy = fy;
+	trm->scale_w = trm->w;
+	trm->scale_h = trm->h;
+	trm->scale_bpp = trm->bpp;
+
 	return (dst);
 }
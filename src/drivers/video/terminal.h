@@ -25,12 +25,24 @@
 
 
 #include <stdio.h>
+#include <stdint.h>
 
+#include <drivers/video/capture.h>
 #include <drivers/video/keys.h>
 
 #include <libini/libini.h>
 
 
+/*!***************************************************************************
+ * @short Make a pixel in the 32 bit terminal buffer format
+ *
+ * Pixels are 32 bit words in host byte order with the red component in
+ * bits 16-23, green in bits 8-15 and blue in bits 0-7.
+ *****************************************************************************/
+#define TRM_XRGB(r, g, b) \
+	(((uint32_t) (r) << 16) | ((uint32_t) (g) << 8) | (uint32_t) (b))
+
+
 /*!***************************************************************************
  * @short The terminal structure
  *****************************************************************************/
@@ -67,6 +79,9 @@ typedef struct {
 	unsigned      w;
 	unsigned      h;
 
+	/* bytes per pixel, 3 (RGB) or 4 (XRGB) */
+	unsigned      bpp;
+
 	unsigned long buf_cnt;
 	unsigned char *buf;
 
@@ -85,12 +100,42 @@ typedef struct {
 	unsigned long scale_buf_cnt;
 	unsigned char *scale_buf;
 
+	/* the parameters of the scaled terminal buffer in scale_buf */
+	unsigned      scale_fx;
+	unsigned      scale_fy;
+	unsigned      scale_w;
+	unsigned      scale_h;
+	unsigned      scale_bpp;
+
 	/* update rectangle */
 	unsigned      update_x;
 	unsigned      update_y;
 	unsigned      update_w;
 	unsigned      update_h;
 
+	/* the maximum number of consecutive frames to skip */
+	unsigned      frame_skip_max;
+	unsigned      frame_skip;
+
+	/* the time at which the current frame started, in microseconds */
+	unsigned long frame_clk;
+
+	/* the time by which the host is behind, in microseconds */
+	unsigned long frame_lag;
+
+	/* the average host time needed to render a frame */
+	unsigned long frame_cost;
+	int           frame_render;
+
+	/* frame statistics */
+	unsigned long frame_cnt;
+	unsigned long frame_skipped;
+
+	/* video capture */
+	capture_t     *capture;
+	unsigned      capture_step;
+	unsigned      capture_fps;
+
 	/* picture index for screenshots */
 	unsigned      pict_index;
 } terminal_t;
@@ -162,6 +207,18 @@ void trm_set_mouse_fct (terminal_t *trm, void *ext, void *fct);
  *****************************************************************************/
 int trm_screenshot (terminal_t *trm, const char *fname);
 
+/*!***************************************************************************
+ * @short Start or stop a video capture
+ * @param fname The output file name or NULL to stop capturing
+ * @param step  Only every step'th frame is written
+ * @param fps   The frame rate written to the file header
+ *
+ * Every frame sent to the terminal with trm_update() is written. If the
+ * file name ends in ".y4m", the frames are written in YUV4MPEG2 format,
+ * otherwise they are written as raw RGB data.
+ *****************************************************************************/
+int trm_set_capture (terminal_t *trm, const char *fname, unsigned step, unsigned fps);
+
 /*!***************************************************************************
  * @short Send a message to the terminal
  *****************************************************************************/
@@ -180,6 +237,17 @@ void trm_set_mouse_scale (terminal_t *trm, int mul_x, int div_x, int mul_y, int
  *****************************************************************************/
 void trm_set_size (terminal_t *trm, unsigned w, unsigned h);
 
+/*!***************************************************************************
+ * @short Set the terminal buffer pixel format
+ * @param bpp The number of bytes per pixel
+ *
+ * With bpp = 3 (the default), every pixel is stored as 3 bytes R, G, B.
+ * With bpp = 4, every pixel is a 32 bit word as created by TRM_XRGB().
+ * All buffers passed to trm_set_lines() must use the same format. The
+ * terminal buffer contents are undefined after the format changes.
+ *****************************************************************************/
+void trm_set_bpp (terminal_t *trm, unsigned bpp);
+
 /*!***************************************************************************
  * @short Set the minimum terminal window size
  *****************************************************************************/
@@ -203,7 +271,7 @@ void trm_set_pixel (terminal_t *trm, unsigned x, unsigned y, const unsigned char
 
 /*!***************************************************************************
  * @short Set lines in the terminal buffer
- * @param buf The RGB source buffer, 3 bytes per pixel
+ * @param buf The source buffer, in the format set by trm_set_bpp()
  * @param y   The first line in the terminal buffer
  * @param cnt The number of lines
  *
@@ -216,6 +284,38 @@ void trm_set_lines (terminal_t *trm, const void *buf, unsigned y, unsigned cnt);
  *****************************************************************************/
 void trm_update (terminal_t *trm);
 
+/*!***************************************************************************
+ * @short Set the maximum number of consecutive frames to skip
+ *
+ * Setting this to 0 disables frame skipping.
+ *****************************************************************************/
+void trm_set_frame_skip (terminal_t *trm, unsigned max);
+
+/*!***************************************************************************
+ * @short  Start a new frame
+ * @param  us The emulated frame duration in microseconds
+ * @return Nonzero if the frame should not be presented
+ *
+ * Video devices call this function once per emulated frame, before the
+ * frame is sent to the terminal. The terminal compares the host time
+ * spent per frame with the emulated frame duration. While the host is
+ * behind by more than one frame and by more than the cost of rendering
+ * a frame, up to frame_skip_max consecutive frames are skipped.
+ *
+ * A skipped frame must not be sent to the terminal and trm_update() must
+ * not be called for it. The device should keep its dirty state so that
+ * the next presented frame is complete. Emulated timing (retrace status
+ * and interrupts) is not affected.
+ *
+ * If us is 0, the frame is always presented.
+ *****************************************************************************/
+int trm_skip_frame (terminal_t *trm, unsigned long us);
+
+/*!***************************************************************************
+ * @short Print frame and capture statistics
+ *****************************************************************************/
+void trm_print_info (terminal_t *trm, FILE *fp);
+
 /*!***************************************************************************
  * @short Check for terminal events
  *
@@ -270,5 +370,17 @@ const unsigned char *trm_scale (terminal_t *trm,
 	unsigned fx, unsigned fy
 );
 
+/*!***************************************************************************
+ * @short Scale the terminal buffer incrementally
+ * @param fx The scale factor in x direction
+ * @param fy The scale factor in y direction
+ *
+ * This is like trm_scale() for the terminal buffer, but the scaled image
+ * is kept between calls and only the rows in the current update rectangle
+ * are rescaled. It must be called before the update rectangle is reset,
+ * i.e. from the terminal update function.
+ *****************************************************************************/
+const unsigned char *trm_scale_update (terminal_t *trm, unsigned fx, unsigned fy);
+
 
 #endif
@@ -20,8 +20,16 @@
  *****************************************************************************/
 
 
+#include <config.h>
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#ifdef PCE_ENABLE_XSHM
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#endif
 
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
@@ -29,6 +37,10 @@
 #include <X11/Xatom.h>
 #include <X11/keysym.h>
 
+#ifdef PCE_ENABLE_XSHM
+#include <X11/extensions/XShm.h>
+#endif
+
 #include <drivers/video/terminal.h>
 #include <drivers/video/x11.h>
 
@@ -312,6 +324,76 @@ void xt_set_window_title (xterm_t *xt, const char *str)
 	XFlush (xt->display);
 }
 
+#ifdef PCE_ENABLE_XSHM
+static int xt_shm_error = 0;
+
+static
+int xt_shm_error_handler (Display *dpy, XErrorEvent *evt)
+{
+	xt_shm_error = 1;
+
+	return (0);
+}
+
+/*
+ * Allocate the backing image in shared memory
+ */
+static
+int xt_image_alloc_shm (xterm_t *xt, Visual *vis, unsigned depth, unsigned w, unsigned h)
+{
+	int (*handler) (Display *, XErrorEvent *);
+
+	xt->img = XShmCreateImage (xt->display, vis, depth, ZPixmap, NULL, &xt->shm, w, h);
+
+	if (xt->img == NULL) {
+		return (1);
+	}
+
+	xt->shm.shmid = shmget (IPC_PRIVATE, xt->img->bytes_per_line * h, IPC_CREAT | 0600);
+
+	if (xt->shm.shmid < 0) {
+		XDestroyImage (xt->img);
+		xt->img = NULL;
+		return (1);
+	}
+
+	xt->shm.shmaddr = shmat (xt->shm.shmid, NULL, 0);
+
+	if (xt->shm.shmaddr == (char *) -1) {
+		shmctl (xt->shm.shmid, IPC_RMID, NULL);
+		XDestroyImage (xt->img);
+		xt->img = NULL;
+		return (1);
+	}
+
+	xt->shm.readOnly = False;
+	xt->img->data = xt->shm.shmaddr;
+
+	/* attaching fails if the server is not on the local machine */
+	xt_shm_error = 0;
+	handler = XSetErrorHandler (xt_shm_error_handler);
+
+	XShmAttach (xt->display, &xt->shm);
+	XSync (xt->display, False);
+
+	XSetErrorHandler (handler);
+
+	shmctl (xt->shm.shmid, IPC_RMID, NULL);
+
+	if (xt_shm_error) {
+		XDestroyImage (xt->img);
+		shmdt (xt->shm.shmaddr);
+		xt->img = NULL;
+		return (1);
+	}
+
+	xt->img_buf = (unsigned char *) xt->img->data;
+	xt->shm_used = 1;
+
+	return (0);
+}
+#endif
+
 /*
  * Allocate the backing image
  */
@@ -328,6 +410,18 @@ int xt_image_alloc (xterm_t *xt, unsigned w, unsigned h)
 
 	depth = attrib.depth;
 
+	xt->shm_used = 0;
+
+#ifdef PCE_ENABLE_XSHM
+	if (xt->shm_ok) {
+		if (xt_image_alloc_shm (xt, vis, depth, w, h) == 0) {
+			return (0);
+		}
+
+		xt->shm_ok = 0;
+	}
+#endif
+
 	xt->img = XCreateImage (xt->display, vis, depth, ZPixmap, 0, NULL, w, h, 8, 0);
 	xt->img_buf = malloc (xt->img->bytes_per_line * h);
 	xt->img->data = (char *) xt->img_buf;
@@ -341,12 +435,53 @@ int xt_image_alloc (xterm_t *xt, unsigned w, unsigned h)
 static
 void xt_image_free (xterm_t *xt)
 {
+	if (xt->img == NULL) {
+		return;
+	}
+
+#ifdef PCE_ENABLE_XSHM
+	if (xt->shm_used) {
+		XShmDetach (xt->display, &xt->shm);
+		XDestroyImage (xt->img);
+		shmdt (xt->shm.shmaddr);
+
+		xt->shm_used = 0;
+	}
+	else {
+		XDestroyImage (xt->img);
+	}
+#else
 	XDestroyImage (xt->img);
+#endif
 
-	xt->img = None;
+	xt->img = NULL;
 	xt->img_buf = NULL;
 }
 
+/*
+ * Copy a rectangle of the backing image to the window
+ */
+static
+void xt_image_put (xterm_t *xt, unsigned x, unsigned y, unsigned w, unsigned h)
+{
+	if (xt->img == NULL) {
+		return;
+	}
+
+#ifdef PCE_ENABLE_XSHM
+	if (xt->shm_used) {
+		XShmPutImage (xt->display, xt->wdw, xt->gc, xt->img, x, y, x, y, w, h, False);
+
+		/* make sure the server is done before the image is modified */
+		XSync (xt->display, False);
+
+		return;
+	}
+#endif
+
+	XPutImage (xt->display, xt->wdw, xt->gc, xt->img, x, y, x, y, w, h);
+}
+
 /*
  * Decode a bit mask into the first set bit and the number of set bits
  */
@@ -371,144 +506,210 @@ void xt_decode_mask (unsigned long mask, unsigned *i, unsigned *n)
 	}
 }
 
+/*
+ * Check if the host byte order is little endian
+ */
+static
+int xt_host_lsb (void)
+{
+	uint32_t val;
+
+	val = 1;
+
+	return (*(unsigned char *) &val == 1);
+}
+
+/*
+ * Get a terminal buffer pixel (sb bytes per pixel) as R, G, B
+ */
+static inline
+void xt_get_rgb (const unsigned char *src, unsigned sb, unsigned long *r, unsigned long *g, unsigned long *b)
+{
+	uint32_t val;
+
+	if (sb == 4) {
+		val = *(const uint32_t *) src;
+
+		*r = (val >> 16) & 0xff;
+		*g = (val >> 8) & 0xff;
+		*b = val & 0xff;
+	}
+	else {
+		*r = src[0];
+		*g = src[1];
+		*b = src[2];
+	}
+}
+
 static inline
-unsigned long xt_get_pixel (const unsigned char *src,
+unsigned long xt_get_pixel (const unsigned char *src, unsigned sb,
 	unsigned ri, unsigned rn, unsigned gi, unsigned gn, unsigned bi, unsigned bn)
 {
-	unsigned long val, tmp;
+	unsigned long val, r, g, b;
+
+	xt_get_rgb (src, sb, &r, &g, &b);
 
-	tmp = src[0];
-	tmp = (tmp << 8) | tmp;
-	val = (tmp >> (16 - rn)) << ri;
+	r = (r << 8) | r;
+	val = (r >> (16 - rn)) << ri;
 
-	tmp = src[1];
-	tmp = (tmp << 8) | tmp;
-	val |= (tmp >> (16 - gn)) << gi;
+	g = (g << 8) | g;
+	val |= (g >> (16 - gn)) << gi;
 
-	tmp = src[2];
-	tmp = (tmp << 8) | tmp;
-	val |= (tmp >> (16 - bn)) << bi;
+	b = (b << 8) | b;
+	val |= (b >> (16 - bn)) << bi;
 
 	return (val);
 }
 
 /*
- * Render the terminal buffer into the backing image
+ * Render a rectangle of the terminal buffer into the backing image,
+ * scaling it by fx / fy on the way. The rectangle is in terminal
+ * buffer coordinates.
  */
 static
-void xt_image_draw (xterm_t *xt, const unsigned char *src, unsigned x, unsigned y, unsigned w, unsigned h)
+void xt_image_draw (xterm_t *xt, const unsigned char *src, unsigned x, unsigned y, unsigned w, unsigned h, unsigned fx, unsigned fy)
 {
 	unsigned char *dst;
 	unsigned      i, j, k;
-	unsigned      si, di;
+	unsigned      si, di, sw, sb, dn;
 	unsigned      ri, rn, gi, gn, bi, bn;
 	unsigned      bpp;
-	unsigned long val;
+	unsigned long val, r, g, b;
+
+	if ((xt->img == NULL) || (w == 0) || (h == 0)) {
+		return;
+	}
+
+	sw = xt->trm.w;
+	sb = xt->trm.bpp;
 
-	src = src + 3 * w * y;
-	dst = xt->img_buf + xt->img->bytes_per_line * y;
+	src = src + sb * sw * y;
+	dst = xt->img_buf + xt->img->bytes_per_line * fy * y;
 
 	xt_decode_mask (xt->img->red_mask, &ri, &rn);
 	xt_decode_mask (xt->img->green_mask, &gi, &gn);
 	xt_decode_mask (xt->img->blue_mask, &bi, &bn);
 
 	bpp = xt->img->bits_per_pixel / 8;
+	dn = bpp * fx * w;
 
 	for (j = 0; j < h; j++) {
-		si = 3 * x;
-		di = bpp * x;
+		si = sb * x;
+		di = bpp * fx * x;
 
 		switch ((bpp << 1) | (xt->img->byte_order == MSBFirst)) {
 		case ((1 << 1) | 0):
 		case ((1 << 1) | 1):
 			for (i = 0; i < w; i++) {
-				dst[di] = src[1];
-				si += 3;
+				xt_get_rgb (src + si, sb, &r, &g, &b);
+				dst[di] = g;
+				si += sb;
 				di += 1;
 			}
 			break;
 
 		case ((2 << 1) | 0):
 			for (i = 0; i < w; i++) {
-				val = xt_get_pixel (src + si, ri, rn, gi, gn, bi, bn);
+				val = xt_get_pixel (src + si, sb, ri, rn, gi, gn, bi, bn);
 
 				dst[di + 0] = val & 0xff;
 				dst[di + 1] = (val >> 8) & 0xff;
 
-				si += 3;
+				si += sb;
 				di += 2;
 			}
 			break;
 
 		case ((2 << 1) | 1):
 			for (i = 0; i < w; i++) {
-				val = xt_get_pixel (src + si, ri, rn, gi, gn, bi, bn);
+				val = xt_get_pixel (src + si, sb, ri, rn, gi, gn, bi, bn);
 
 				dst[di + 0] = (val >> 8) & 0xff;
 				dst[di + 1] = val & 0xff;
 
-				si += 3;
+				si += sb;
 				di += 2;
 			}
 			break;
 
 		case ((3 << 1) | 0):
 			for (i = 0; i < w; i++) {
-				val = xt_get_pixel (src + si, ri, rn, gi, gn, bi, bn);
+				val = xt_get_pixel (src + si, sb, ri, rn, gi, gn, bi, bn);
 
 				dst[di + 0] = val & 0xff;
 				dst[di + 1] = (val >> 8) & 0xff;
 				dst[di + 2] = (val >> 16) & 0xff;
 
-				si += 3;
+				si += sb;
 				di += 3;
 			}
 			break;
 
 		case ((3 << 1) | 1):
 			for (i = 0; i < w; i++) {
-				val = xt_get_pixel (src + si, ri, rn, gi, gn, bi, bn);
+				val = xt_get_pixel (src + si, sb, ri, rn, gi, gn, bi, bn);
 
 				dst[di + 0] = (val >> 16) & 0xff;
 				dst[di + 1] = (val >> 8) & 0xff;
 				dst[di + 2] = val & 0xff;
 
-				si += 3;
+				si += sb;
 				di += 3;
 			}
 			break;
 
 		case ((4 << 1) | 0):
+			if ((ri == 16) && (gi == 8) && (bi == 0) && (rn == 8) && (gn == 8) && (bn == 8)) {
+				/* the native 32 bit XRGB format */
+				if ((sb == 4) && xt_host_lsb ()) {
+					memcpy (dst + di, src + si, 4 * w);
+					break;
+				}
+
+				for (i = 0; i < w; i++) {
+					xt_get_rgb (src + si, sb, &r, &g, &b);
+
+					dst[di + 0] = b;
+					dst[di + 1] = g;
+					dst[di + 2] = r;
+					dst[di + 3] = 0;
+
+					si += sb;
+					di += 4;
+				}
+				break;
+			}
+
 			for (i = 0; i < w; i++) {
-				val = xt_get_pixel (src + si, ri, rn, gi, gn, bi, bn);
+				val = xt_get_pixel (src + si, sb, ri, rn, gi, gn, bi, bn);
 
 				dst[di + 0] = val & 0xff;
 				dst[di + 1] = (val >> 8) & 0xff;
 				dst[di + 2] = (val >> 16) & 0xff;
 				dst[di + 3] = (val >> 24) & 0xff;
 
-				si += 3;
+				si += sb;
 				di += 4;
 			}
 			break;
 
 		case ((4 << 1) | 1):
 			for (i = 0; i < w; i++) {
-				val = xt_get_pixel (src + si, ri, rn, gi, gn, bi, bn);
+				val = xt_get_pixel (src + si, sb, ri, rn, gi, gn, bi, bn);
 
 				dst[di + 0] = (val >> 24) & 0xff;
 				dst[di + 1] = (val >> 16) & 0xff;
 				dst[di + 2] = (val >> 8) & 0xff;
 				dst[di + 3] = val & 0xff;
 
-				si += 3;
+				si += sb;
 				di += 4;
 			}
 			break;
 
 		default:
 			for (i = 0; i < w; i++) {
-				val = xt_get_pixel (src + si, ri, rn, gi, gn, bi, bn);
+				val = xt_get_pixel (src + si, sb, ri, rn, gi, gn, bi, bn);
 
 				if (xt->img->byte_order == MSBFirst) {
 					for (k = 0; k < bpp; k++) {
@@ -523,14 +724,31 @@ void xt_image_draw (xterm_t *xt, const unsigned char *src, unsigned x, unsigned
 					}
 				}
 
-				si += 3;
+				si += sb;
 				di += bpp;
 			}
 			break;
 		}
 
-		src += 3 * w;
-		dst += xt->img->bytes_per_line;
+		if (fx > 1) {
+			/* expand the converted pixels in place, right to left */
+			di = bpp * fx * x;
+
+			for (i = w; i-- > 0; ) {
+				for (k = fx; k-- > 0; ) {
+					if ((fx * i + k) != i) {
+						memcpy (dst + di + bpp * (fx * i + k), dst + di + bpp * i, bpp);
+					}
+				}
+			}
+		}
+
+		for (i = 1; i < fy; i++) {
+			memcpy (dst + i * xt->img->bytes_per_line + bpp * fx * x, dst + bpp * fx * x, dn);
+		}
+
+		src += sb * sw;
+		dst += fy * xt->img->bytes_per_line;
 	}
 }
 
@@ -570,7 +788,6 @@ static
 void xt_update (xterm_t *xt)
 {
 	terminal_t          *trm;
-	const unsigned char *buf;
 	unsigned            fx, fy;
 	unsigned            dw, dh;
 	unsigned            ux, uy, uw, uh;
@@ -584,16 +801,17 @@ void xt_update (xterm_t *xt)
 
 	xt_set_window_size (xt, dw, dh);
 
-	buf = trm_scale (trm, trm->buf, trm->w, trm->h, fx, fy);
+	/* only convert and scale the part of the image that has changed */
+	xt_image_draw (xt, trm->buf,
+		trm->update_x, trm->update_y, trm->update_w, trm->update_h, fx, fy
+	);
 
 	ux = fx * trm->update_x;
 	uy = fy * trm->update_y;
 	uw = fx * trm->update_w;
 	uh = fy * trm->update_h;
 
-	xt_image_draw (xt, buf, ux, uy, uw, uh);
-
-	XPutImage (xt->display, xt->wdw, xt->gc, xt->img, ux, uy, ux, uy, uw, uh);
+	xt_image_put (xt, ux, uy, uw, uh);
 }
 
 /*
@@ -684,9 +902,7 @@ void xt_event_expose (xterm_t *xt, XEvent *event)
 
 	evt = (XExposeEvent *) event;
 
-	XPutImage (xt->display, xt->wdw, xt->gc, xt->img,
-		evt->x, evt->y, evt->x, evt->y, evt->width, evt->height
-	);
+	xt_image_put (xt, evt->x, evt->y, evt->width, evt->height);
 }
 
 static
@@ -946,6 +1162,12 @@ int xt_open (xterm_t *xt, unsigned w, unsigned h)
 	xt->display_h = DisplayHeight (xt->display, xt->screen);
 	xt->root = RootWindow (xt->display, xt->screen);
 
+#ifdef PCE_ENABLE_XSHM
+	xt->shm_ok = (XShmQueryExtension (xt->display) == True);
+#else
+	xt->shm_ok = 0;
+#endif
+
 	if (xt_open_window (xt, w, h)) {
 		XCloseDisplay (xt->display);
 		return (1);
@@ -1004,6 +1226,9 @@ void xt_init (xterm_t *xt, ini_sct_t *sct)
 	xt->img = NULL;
 	xt->img_buf = NULL;
 
+	xt->shm_ok = 0;
+	xt->shm_used = 0;
+
 	xt->empty_cursor = None;
 
 	xt->wdw_w = 0;
@@ -24,6 +24,8 @@
 #define PCE_VIDEO_X11_H 1
 
 
+#include <config.h>
+
 #include <stdio.h>
 
 #include <X11/Xlib.h>
@@ -32,6 +34,10 @@
 #include <X11/Xatom.h>
 #include <X11/keysym.h>
 
+#ifdef PCE_ENABLE_XSHM
+#include <X11/extensions/XShm.h>
+#endif
+
 #include <drivers/video/terminal.h>
 
 #include <libini/libini.h>
@@ -67,6 +73,14 @@ typedef struct {
 	XImage        *img;
 	unsigned char *img_buf;
 
+	/* shared memory images are available / used for img */
+	char          shm_ok;
+	char          shm_used;
+
+#ifdef PCE_ENABLE_XSHM
+	XShmSegmentInfo shm;
+#endif
+
 	Cursor        empty_cursor;
 
 	unsigned      wdw_w;
@@ -104,18 +104,22 @@ char *str_rtrim (char *str)
 	return (str);
 }
 
-void cmd_get (cmd_t *cmd, const char *prompt)
+int cmd_get (cmd_t *cmd, const char *prompt)
 {
+	int r;
+
 	if (prompt == NULL) {
 		prompt = "-";
 	}
 
-	pce_gets (prompt, cmd->str, PCE_CMD_MAX);
+	r = pce_gets (prompt, cmd->str, PCE_CMD_MAX);
 
 	str_ltrim (cmd->str);
 	str_rtrim (cmd->str);
 
 	cmd->i = 0;
+
+	return (r);
 }
 
 void cmd_set_str (cmd_t *cmd, const char *str)
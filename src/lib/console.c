@@ -154,6 +154,7 @@ int pce_gets (const char *prompt, char *str, unsigned max)
 
 	if (fgets (str, max, pce_fp_inp) == NULL) {
 		str[0] = 0;
+		return (1);
 	}
 #endif
 
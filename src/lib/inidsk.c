@@ -29,6 +29,7 @@
 #include <lib/log.h>
 #include <lib/path.h>
 
+#include <drivers/block/blkcache.h>
 #include <drivers/block/blkchd.h>
 #include <drivers/block/blkcow.h>
 #include <drivers/block/blkdosem.h>
@@ -161,6 +162,54 @@ disk_t *ini_get_cow (ini_sct_t *sct, disk_t *dsk)
 	return (dsk);
 }
 
+static
+disk_t *ini_get_cache (ini_sct_t *sct, disk_t *dsk)
+{
+	unsigned long size;
+	int           wb;
+	unsigned      type;
+	disk_t        *cache;
+
+	ini_get_uint32 (sct, "cache_size", &size, 0);
+	ini_get_bool (sct, "cache_writeback", &wb, 0);
+
+	if (size == 0) {
+		return (dsk);
+	}
+
+	type = dsk_get_type (dsk);
+
+	if ((type == PCE_DISK_PSI) || (type == PCE_DISK_PRI)) {
+		pce_log_tag (MSG_INF,
+			"DISK:", "drive=%u cache=none (not a block image)\n",
+			dsk_get_drive (dsk)
+		);
+
+		return (dsk);
+	}
+
+	cache = dsk_cache_new (dsk, 2 * size, wb);
+
+	if (cache == NULL) {
+		pce_log_tag (MSG_ERR,
+			"DISK:", "*** cache failed (drive=%u size=%luK)\n",
+			dsk_get_drive (dsk), size
+		);
+
+		dsk_del (dsk);
+
+		return (NULL);
+	}
+
+	pce_log_tag (MSG_INF,
+		"DISK:", "drive=%u cache=%luK mode=%s\n",
+		dsk_get_drive (dsk), size,
+		wb ? "write-back" : "write-through"
+	);
+
+	return (cache);
+}
+
 static
 void ini_get_vchs (ini_sct_t *sct, disk_t *dsk)
 {
@@ -241,6 +290,8 @@ int ini_get_disk (ini_sct_t *sct, disk_t **ret)
 	unsigned long ofs;
 	int           ro;
 	int           optional;
+	int           async;
+	int           map;
 	const char    *type, *fname;
 	char          *path;
 
@@ -273,6 +324,8 @@ int ini_get_disk (ini_sct_t *sct, disk_t **ret)
 
 	ini_get_bool (sct, "readonly", &ro, 0);
 	ini_get_bool (sct, "optional", &optional, 0);
+	ini_get_bool (sct, "async", &async, 0);
+	ini_get_bool (sct, "mmap", &map, 0);
 
 	val = NULL;
 	dsk = NULL;
@@ -401,6 +454,17 @@ int ini_get_disk (ini_sct_t *sct, disk_t **ret)
 
 	free (path);
 
+	if (map) {
+		if (dsk_set_msg (dsk, "mmap", NULL)) {
+			pce_log_tag (MSG_INF,
+				"DISK:", "drive=%u mmap not supported\n", drive
+			);
+		}
+		else {
+			pce_log_tag (MSG_INF, "DISK:", "drive=%u mmap\n", drive);
+		}
+	}
+
 	ini_get_vchs (sct, dsk);
 
 	dsk = ini_get_cow (sct, dsk);
@@ -420,6 +484,29 @@ int ini_get_disk (ini_sct_t *sct, disk_t **ret)
 		return (0);
 	}
 
+	dsk = ini_get_cache (sct, dsk);
+
+	if (dsk == NULL) {
+		*ret = NULL;
+
+		if (optional == 0) {
+			pce_log (MSG_ERR,
+				"*** loading drive 0x%02x failed (cache)\n",
+				drive
+			);
+
+			return (1);
+		}
+
+		return (0);
+	}
+
+	if (async) {
+		dsk_set_async (dsk, 1);
+
+		pce_log_tag (MSG_INF, "DISK:", "drive=%u async\n", drive);
+	}
+
 	*ret = dsk;
 
 	return (0);
@@ -59,11 +59,14 @@ int trm_is_valid (const char *str)
 terminal_t *ini_get_terminal (ini_sct_t *ini, const char *def)
 {
 	unsigned   scale;
+	unsigned   frame_skip;
+	unsigned   capture_step, capture_fps;
 	unsigned   min_w, min_h;
 	unsigned   aspect_x, aspect_y;
 	int        mouse_x[2], mouse_y[2];
 	const char *driver;
 	const char *esc;
+	const char *capture;
 	ini_sct_t  *sct;
 	terminal_t *trm;
 
@@ -97,6 +100,10 @@ terminal_t *ini_get_terminal (ini_sct_t *ini, const char *def)
 	ini_get_uint16 (sct, "min_w", &min_w, 512);
 	ini_get_uint16 (sct, "min_h", &min_h, 384);
 	ini_get_uint16 (sct, "scale", &scale, 1);
+	ini_get_uint16 (sct, "frame_skip", &frame_skip, 0);
+	ini_get_string (sct, "capture", &capture, NULL);
+	ini_get_uint16 (sct, "capture_step", &capture_step, 1);
+	ini_get_uint16 (sct, "capture_fps", &capture_fps, 60);
 	ini_get_sint16 (sct, "mouse_mul_x", &mouse_x[0], 1);
 	ini_get_sint16 (sct, "mouse_div_x", &mouse_x[1], 1);
 	ini_get_sint16 (sct, "mouse_mul_y", &mouse_y[0], 1);
@@ -104,12 +111,12 @@ terminal_t *ini_get_terminal (ini_sct_t *ini, const char *def)
 
 	pce_log_tag (MSG_INF, "TERM:",
 		"driver=%s ESC=%s aspect=%u/%u min_size=%u*%u scale=%u"
-		" mouse=[%u/%u %u/%u]\n",
+		" frame_skip=%u mouse=[%u/%u %u/%u]\n",
 		driver,
 		(esc != NULL) ? esc : "ESC",
 		aspect_x, aspect_y,
 		min_w, min_h,
-		scale,
+		scale, frame_skip,
 		mouse_x[0], mouse_x[1], mouse_y[0], mouse_y[1]
 	);
 
@@ -162,6 +169,17 @@ terminal_t *ini_get_terminal (ini_sct_t *ini, const char *def)
 	}
 
 	trm_set_scale (trm, scale);
+	trm_set_frame_skip (trm, frame_skip);
+
+	if (capture != NULL) {
+		pce_log_tag (MSG_INF, "TERM:", "capture=%s step=%u fps=%u\n",
+			capture, capture_step, capture_fps
+		);
+	}
+
+	if (trm_set_capture (trm, capture, capture_step, capture_fps)) {
+		pce_log (MSG_ERR, "*** can't start capture (%s)\n", capture);
+	}
 	trm_set_min_size (trm, min_w, min_h);
 	trm_set_aspect_ratio (trm, aspect_x, aspect_y);
 	trm_set_mouse_scale (trm, mouse_x[0], mouse_x[1], mouse_y[0], mouse_y[1]);
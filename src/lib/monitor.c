@@ -94,6 +94,7 @@ void mon_init (monitor_t *mon)
 
 	mon->rw = 0;
 	mon->terminate = 0;
+	mon->eof_exit = 0;
 	mon->prompt = NULL;
 
 	mon_cmd_add (mon, par_cmd, sizeof (par_cmd) / sizeof (par_cmd[0]));
@@ -166,6 +167,11 @@ void mon_set_terminate (monitor_t *mon, int val)
 	mon->terminate = (val != 0);
 }
 
+void mon_set_eof_exit (monitor_t *mon, int val)
+{
+	mon->eof_exit = (val != 0);
+}
+
 void mon_set_prompt (monitor_t *mon, const char *str)
 {
 	mon->prompt = str;
@@ -1092,7 +1098,11 @@ int mon_run (monitor_t *mon)
 			mon->setmsg (mon->msgext, "term.fullscreen", "0");
 		}
 
-		cmd_get (&cmd, mon->prompt);
+		if (cmd_get (&cmd, mon->prompt)) {
+			if (mon->eof_exit) {
+				break;
+			}
+		}
 
 		r = 1;
 
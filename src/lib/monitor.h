@@ -63,6 +63,9 @@ typedef struct {
 	char           rw;
 	char           terminate;
 
+	/* terminate at the end of the input */
+	char           eof_exit;
+
 	const char     *prompt;
 } monitor_t;
 
@@ -84,6 +87,8 @@ void mon_set_memory_mode (monitor_t *mon, unsigned mode);
 
 void mon_set_terminate (monitor_t *mon, int val);
 
+void mon_set_eof_exit (monitor_t *mon, int val);
+
 void mon_set_prompt (monitor_t *mon, const char *str);
 
 int mon_cmd_add (monitor_t *mon, const mon_cmd_t *cmd, unsigned cnt);
@@ -24,6 +24,7 @@
 #include <stdlib.h>
 
 #include <drivers/block/block.h>
+#include <drivers/block/blkcache.h>
 #include <drivers/block/blkpbi.h>
 #include <drivers/block/blkqed.h>
 
@@ -73,9 +74,10 @@ void dsk_print_info (disk_t *dsk)
 void dsks_print_info (disks_t *dsks)
 {
 	unsigned   i;
-	disk_t     *dsk;
-	disk_pbi_t *pbi;
-	disk_qed_t *qed;
+	disk_t       *dsk;
+	disk_pbi_t   *pbi;
+	disk_qed_t   *qed;
+	disk_cache_t *cache;
 
 	for (i = 0; i < dsks->cnt; i++) {
 		dsk = dsks->dsk[i];
@@ -91,6 +93,10 @@ void dsks_print_info (disks_t *dsks)
 				qed = dsk->ext;
 				dsk = qed->next;
 			}
+			else if (dsk->type == PCE_DISK_CACHE) {
+				cache = dsk->ext;
+				dsk = cache->orig;
+			}
 			else {
 				dsk = NULL;
 			}
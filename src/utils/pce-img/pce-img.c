@@ -159,6 +159,9 @@ const char *pce_get_type_name (unsigned type)
 
 	case PCE_DISK_PRI:
 		return ("pri");
+
+	case PCE_DISK_CACHE:
+		return ("cache");
 	}
 
 	return ("unknown");